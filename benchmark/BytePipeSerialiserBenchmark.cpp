@@ -0,0 +1,587 @@
+// MIT License
+// 
+// Copyright(c) 2021 Adam Smith
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+#include "anvil/serialisation/BytePipeSerialiser.hpp"
+
+// Build with the sources in src/anvil/serialisation and the anvil byte-pipe headers, using C++14 or later.
+// Usage : BytePipeSerialiserBenchmark [filter]
+// Runs every benchmark whose name contains the filter and prints the results as JSON.
+// The benchmarks are single threaded, allocations are counted by replacing the global new and delete.
+
+namespace {
+	using namespace anvil;
+
+	// Allocation tracking
+
+	struct AllocationCounter {
+		uint64_t count;		//!< Number of allocations made
+		uint64_t live;		//!< Bytes currently allocated
+		uint64_t peak;		//!< Most bytes allocated at once since the last reset
+	};
+
+	AllocationCounter g_allocations = { 0u, 0u, 0u };
+
+	enum : size_t {
+		ALLOCATION_HEADER_SIZE = alignof(std::max_align_t) > sizeof(size_t) ? alignof(std::max_align_t) : sizeof(size_t)
+	};
+
+	void* TrackedAllocate(const size_t bytes) {
+		uint8_t* const block = static_cast<uint8_t*>(std::malloc(bytes + ALLOCATION_HEADER_SIZE));
+		if (block == nullptr) throw std::bad_alloc();
+		memcpy(block, &bytes, sizeof(size_t));
+
+		++g_allocations.count;
+		g_allocations.live += bytes;
+		if (g_allocations.live > g_allocations.peak) g_allocations.peak = g_allocations.live;
+		return block + ALLOCATION_HEADER_SIZE;
+	}
+
+	void TrackedFree(void* ptr) {
+		if (ptr == nullptr) return;
+		uint8_t* const block = static_cast<uint8_t*>(ptr) - ALLOCATION_HEADER_SIZE;
+		size_t bytes;
+		memcpy(&bytes, block, sizeof(size_t));
+		g_allocations.live -= bytes;
+		std::free(block);
+	}
+
+	// Serialiser buffers do not use new, so they are counted through this instead
+	class CountingAllocator final : public Allocator {
+	public:
+		void* Allocate(const size_t bytes) final {
+			return TrackedAllocate(bytes);
+		}
+
+		void Deallocate(void* ptr, const size_t) final {
+			TrackedFree(ptr);
+		}
+	};
+
+	// Stands in for a real pipe, bytes are copied into a fixed ring so that the cost of moving them is included
+	class MemoryPipe final : public BytePipe::OutputPipe {
+	private:
+		enum : size_t {
+			RING_SIZE = 1024u * 1024u
+		};
+
+		std::vector<uint8_t> _ring;
+		size_t _ring_pos;
+	public:
+		uint64_t bytes_written;
+
+		MemoryPipe() :
+			_ring(RING_SIZE),
+			_ring_pos(0u),
+			bytes_written(0u)
+		{}
+
+		virtual ~MemoryPipe() {}
+
+		uint32_t WriteBytes(const void* src, const uint32_t bytes) final {
+			const uint8_t* src_bytes = static_cast<const uint8_t*>(src);
+			size_t remaining = bytes;
+			while (remaining > 0u) {
+				const size_t count = remaining < RING_SIZE - _ring_pos ? remaining : RING_SIZE - _ring_pos;
+				memcpy(_ring.data() + _ring_pos, src_bytes, count);
+				_ring_pos = (_ring_pos + count) % RING_SIZE;
+				src_bytes += count;
+				remaining -= count;
+			}
+			bytes_written += bytes;
+			return bytes;
+		}
+
+		void Flush() final {
+
+		}
+	};
+
+	// Deterministic payload generation
+
+	class Random {
+	private:
+		uint64_t _state;
+	public:
+		Random(const uint64_t seed) :
+			_state(seed)
+		{}
+
+		uint64_t Next() {
+			// xorshift64*
+			_state ^= _state >> 12u;
+			_state ^= _state << 25u;
+			_state ^= _state >> 27u;
+			return _state * 2685821657736338717ull;
+		}
+
+		double NextDouble() {
+			return static_cast<double>(Next() >> 11u) * (1.0 / 9007199254740992.0);
+		}
+
+		std::string NextString(const size_t min_length, const size_t max_length) {
+			const size_t length = min_length + static_cast<size_t>(Next() % (max_length - min_length + 1u));
+			std::string str(length, ' ');
+			for (char& c : str) c = static_cast<char>('a' + Next() % 26u);
+			return str;
+		}
+	};
+
+	// Payloads
+
+	struct ScalarRecord {
+		uint8_t u8;
+		uint16_t u16;
+		uint32_t u32;
+		uint64_t u64;
+		int8_t s8;
+		int16_t s16;
+		int32_t s32;
+		int64_t s64;
+		float f32;
+		double f64;
+		uint32_t id;
+		int64_t timestamp;
+		double price;
+		double quantity;
+		uint16_t flags;
+		float score;
+	};
+
+	struct StringRecord {
+		uint64_t id;
+		std::string name;
+		std::string email;
+		std::string address;
+		std::string description;
+		std::vector<std::string> tags;
+	};
+}
+
+ANVIL_SCHEMA(ScalarRecord,
+	ANVIL_FIELD(ScalarRecord, u8), ANVIL_FIELD(ScalarRecord, u16), ANVIL_FIELD(ScalarRecord, u32), ANVIL_FIELD(ScalarRecord, u64),
+	ANVIL_FIELD(ScalarRecord, s8), ANVIL_FIELD(ScalarRecord, s16), ANVIL_FIELD(ScalarRecord, s32), ANVIL_FIELD(ScalarRecord, s64),
+	ANVIL_FIELD(ScalarRecord, f32), ANVIL_FIELD(ScalarRecord, f64), ANVIL_FIELD(ScalarRecord, id), ANVIL_FIELD(ScalarRecord, timestamp),
+	ANVIL_FIELD(ScalarRecord, price), ANVIL_FIELD(ScalarRecord, quantity), ANVIL_FIELD(ScalarRecord, flags), ANVIL_FIELD(ScalarRecord, score))
+
+ANVIL_SCHEMA(StringRecord,
+	ANVIL_FIELD(StringRecord, id), ANVIL_FIELD(StringRecord, name), ANVIL_FIELD(StringRecord, email),
+	ANVIL_FIELD(StringRecord, address), ANVIL_FIELD(StringRecord, description), ANVIL_FIELD(StringRecord, tags))
+
+void* operator new(size_t bytes) {
+	return TrackedAllocate(bytes);
+}
+
+void* operator new[](size_t bytes) {
+	return TrackedAllocate(bytes);
+}
+
+void operator delete(void* ptr) noexcept {
+	TrackedFree(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+	TrackedFree(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+	TrackedFree(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+	TrackedFree(ptr);
+}
+
+namespace {
+
+	enum : uint32_t {
+		ITERATIONS = 5u	//!< Each benchmark is run this many times and the fastest run is reported
+	};
+
+	struct Result {
+		const char* name;
+		const char* mode;
+		uint64_t records;
+		uint64_t values;
+		uint64_t bytes;
+		double seconds;
+		double allocations_per_record;
+		uint64_t peak_memory;
+	};
+
+	class Benchmark {
+	public:
+		const char* name;
+		uint64_t records;	//!< Number of records written per run
+		uint64_t values;	//!< Number of scalar values written per run
+
+		Benchmark(const char* name) :
+			name(name),
+			records(0u),
+			values(0u)
+		{}
+
+		virtual ~Benchmark() {}
+
+		virtual void Write(BytePipeSerialiser& serialiser) = 0;
+	};
+
+	const char* GetModeName(const uint32_t mode) {
+		switch (mode) {
+		case BytePipeFormat::MODE_DEFAULT:
+			return "default";
+		case BytePipeFormat::MODE_INDEXED:
+			return "indexed";
+		case BytePipeFormat::MODE_COMPACT:
+			return "compact";
+		case BytePipeFormat::MODE_COMPACT | BytePipeFormat::MODE_INTERN_NAMES:
+			return "compact_interned";
+		default:
+			return "other";
+		}
+	}
+
+	Result Run(Benchmark& benchmark, const uint32_t mode) {
+		Result result;
+		result.name = benchmark.name;
+		result.mode = GetModeName(mode);
+		result.records = benchmark.records;
+		result.values = benchmark.values;
+		result.seconds = 1e30;
+
+		CountingAllocator allocator;
+		MemoryPipe pipe;
+
+		// Peak memory includes the buffers the serialiser grows during the first run
+		const uint64_t live_before = g_allocations.live;
+		g_allocations.peak = live_before;
+		BytePipeSerialiser serialiser(pipe, mode, allocator);
+
+		// The first run warms up the buffers, later runs show the steady state
+		for (uint32_t i = 0u; i <= ITERATIONS; ++i) {
+			const uint64_t bytes_before = pipe.bytes_written;
+			const uint64_t allocations_before = g_allocations.count;
+
+			const auto start = std::chrono::steady_clock::now();
+			benchmark.Write(serialiser);
+			const auto end = std::chrono::steady_clock::now();
+
+			const double seconds = std::chrono::duration<double>(end - start).count();
+			if (i == 0u) continue;
+
+			if (seconds < result.seconds) result.seconds = seconds;
+			result.bytes = pipe.bytes_written - bytes_before;
+			result.allocations_per_record = static_cast<double>(g_allocations.count - allocations_before) / static_cast<double>(benchmark.records);
+		}
+
+		result.peak_memory = g_allocations.peak - live_before;
+
+		return result;
+	}
+
+	std::vector<ScalarRecord> GenerateScalarRecords(const size_t count) {
+		Random random(1u);
+		std::vector<ScalarRecord> records(count);
+		for (size_t i = 0u; i < count; ++i) {
+			ScalarRecord& record = records[i];
+			record.u8 = static_cast<uint8_t>(random.Next());
+			record.u16 = static_cast<uint16_t>(random.Next());
+			record.u32 = static_cast<uint32_t>(random.Next());
+			record.u64 = random.Next();
+			record.s8 = static_cast<int8_t>(random.Next());
+			record.s16 = static_cast<int16_t>(random.Next());
+			record.s32 = static_cast<int32_t>(random.Next());
+			record.s64 = static_cast<int64_t>(random.Next());
+			record.f32 = static_cast<float>(random.NextDouble());
+			record.f64 = random.NextDouble();
+			record.id = static_cast<uint32_t>(i);
+			record.timestamp = 1600000000000ll + static_cast<int64_t>(i) * 10;
+			record.price = 100.0 + random.NextDouble();
+			record.quantity = static_cast<double>(random.Next() % 1000u);
+			record.flags = static_cast<uint16_t>(random.Next() & 0xFFu);
+			record.score = static_cast<float>(random.NextDouble());
+		}
+		return records;
+	}
+
+	// Scalar heavy objects, written through the virtual interface
+
+	class ScalarObjects final : public Benchmark {
+	private:
+		std::vector<ScalarRecord> _records;
+	public:
+		ScalarObjects(const char* name, const size_t count) :
+			Benchmark(name),
+			_records(GenerateScalarRecords(count))
+		{
+			records = count;
+			values = count * 16u;
+		}
+
+		void Write(BytePipeSerialiser& serialiser) final {
+			for (const ScalarRecord& record : _records) Reflection::Write(serialiser, record);
+		}
+	};
+
+	// The same objects written with the reflected struct fast path
+
+	class ScalarStructs final : public Benchmark {
+	private:
+		std::vector<ScalarRecord> _records;
+	public:
+		ScalarStructs(const char* name, const size_t count) :
+			Benchmark(name),
+			_records(GenerateScalarRecords(count))
+		{
+			records = count;
+			values = count * 16u;
+		}
+
+		void Write(BytePipeSerialiser& serialiser) final {
+			for (const ScalarRecord& record : _records) serialiser.SetNextValueStruct(record);
+		}
+	};
+
+	// Objects nested inside each other, alternating with single element arrays
+
+	class DeepNesting final : public Benchmark {
+	private:
+		size_t _count;
+		size_t _depth;
+	public:
+		DeepNesting(const char* name, const size_t count, const size_t depth) :
+			Benchmark(name),
+			_count(count),
+			_depth(depth)
+		{
+			records = count;
+			values = count;
+		}
+
+		void Write(BytePipeSerialiser& serialiser) final {
+			for (size_t i = 0u; i < _count; ++i) {
+				for (size_t d = 0u; d < _depth; ++d) {
+					if (d & 1u) {
+						serialiser.StartArray();
+					} else {
+						serialiser.StartObject();
+						serialiser.SetNextMemberName("child");
+					}
+				}
+				serialiser.SetNextValueU32(static_cast<uint32_t>(i));
+				for (size_t d = _depth; d > 0u; --d) {
+					if ((d - 1u) & 1u) {
+						serialiser.EndArray();
+					} else {
+						serialiser.EndObject();
+					}
+				}
+			}
+		}
+	};
+
+	// Objects with a large number of members
+
+	class WideObjects final : public Benchmark {
+	private:
+		std::vector<std::string> _names;
+		size_t _count;
+	public:
+		WideObjects(const char* name, const size_t count, const size_t width) :
+			Benchmark(name),
+			_count(count)
+		{
+			for (size_t i = 0u; i < width; ++i) _names.push_back("member_" + std::to_string(i));
+			records = count;
+			values = count * width;
+		}
+
+		void Write(BytePipeSerialiser& serialiser) final {
+			for (size_t i = 0u; i < _count; ++i) {
+				serialiser.StartObject();
+				for (size_t j = 0u; j < _names.size(); ++j) {
+					serialiser.SetNextMemberName(_names[j].c_str());
+					serialiser.SetNextValueF64(static_cast<double>(i + j));
+				}
+				serialiser.EndObject();
+			}
+		}
+	};
+
+	// One large array of a primitive type
+
+	template<class T>
+	class TypedArray final : public Benchmark {
+	private:
+		std::vector<T> _values;
+		void(BytePipeSerialiser::*_write)(const T*, const size_t);
+	public:
+		TypedArray(const char* name, const size_t bytes, void(BytePipeSerialiser::*write)(const T*, const size_t)) :
+			Benchmark(name),
+			_write(write)
+		{
+			Random random(2u);
+			_values.resize(bytes / sizeof(T));
+			T previous = static_cast<T>(0);
+			for (T& value : _values) {
+				// A slowly changing series, like sensor readings or timestamps
+				previous = static_cast<T>(previous + static_cast<T>(random.Next() % 4u));
+				value = previous;
+			}
+			records = 1u;
+			values = _values.size();
+		}
+
+		void Write(BytePipeSerialiser& serialiser) final {
+			serialiser.StartArray();
+			(serialiser.*_write)(_values.data(), _values.size());
+			serialiser.EndArray();
+		}
+	};
+
+	// Array of strings
+
+	class StringArray final : public Benchmark {
+	private:
+		std::vector<std::string> _values;
+	public:
+		StringArray(const char* name, const size_t count) :
+			Benchmark(name)
+		{
+			Random random(3u);
+			for (size_t i = 0u; i < count; ++i) _values.push_back(random.NextString(4u, 32u));
+			records = 1u;
+			values = count;
+		}
+
+		void Write(BytePipeSerialiser& serialiser) final {
+			serialiser.StartArray();
+			for (const std::string& value : _values) serialiser.SetNextValueString(value.c_str());
+			serialiser.EndArray();
+		}
+	};
+
+	// Records that are mostly text
+
+	class StringRecords final : public Benchmark {
+	private:
+		std::vector<StringRecord> _records;
+	public:
+		StringRecords(const char* name, const size_t count) :
+			Benchmark(name)
+		{
+			Random random(4u);
+			_records.resize(count);
+			for (StringRecord& record : _records) {
+				record.id = random.Next();
+				record.name = random.NextString(6u, 24u);
+				record.email = random.NextString(8u, 20u) + "@example.com";
+				record.address = random.NextString(20u, 60u);
+				record.description = random.NextString(50u, 400u);
+				const size_t tags = random.Next() % 6u;
+				for (size_t i = 0u; i < tags; ++i) record.tags.push_back(random.NextString(3u, 10u));
+				values += 5u + tags;
+			}
+			records = count;
+		}
+
+		void Write(BytePipeSerialiser& serialiser) final {
+			for (const StringRecord& record : _records) Reflection::Write(serialiser, record);
+		}
+	};
+
+	void PrintResult(const Result& result, const bool last) {
+		const double megabytes = static_cast<double>(result.bytes) / (1024.0 * 1024.0);
+		std::printf("\t\t{\"name\": \"%s\", \"mode\": \"%s\", \"records\": %llu, \"values\": %llu, \"bytes\": %llu, "
+			"\"seconds\": %.6f, \"mb_per_second\": %.2f, \"values_per_second\": %.0f, \"records_per_second\": %.0f, "
+			"\"allocations_per_record\": %.4f, \"peak_memory_bytes\": %llu}%s\n",
+			result.name,
+			result.mode,
+			static_cast<unsigned long long>(result.records),
+			static_cast<unsigned long long>(result.values),
+			static_cast<unsigned long long>(result.bytes),
+			result.seconds,
+			megabytes / result.seconds,
+			static_cast<double>(result.values) / result.seconds,
+			static_cast<double>(result.records) / result.seconds,
+			result.allocations_per_record,
+			static_cast<unsigned long long>(result.peak_memory),
+			last ? "" : ","
+		);
+	}
+}
+
+int main(int argc, char** argv) {
+	const char* const filter = argc > 1 ? argv[1] : "";
+	enum : size_t { ARRAY_BYTES = 64u * 1024u * 1024u };
+
+	std::vector<Benchmark*> record_benchmarks;
+	record_benchmarks.push_back(new ScalarObjects("scalar_objects", 100000u));
+	record_benchmarks.push_back(new ScalarStructs("scalar_structs", 100000u));
+	record_benchmarks.push_back(new DeepNesting("deep_nesting", 20000u, 64u));
+	record_benchmarks.push_back(new WideObjects("wide_objects", 200u, 1000u));
+	record_benchmarks.push_back(new StringRecords("string_records", 50000u));
+
+	std::vector<Benchmark*> array_benchmarks;
+	array_benchmarks.push_back(new TypedArray<uint8_t>("array_u8", ARRAY_BYTES, &BytePipeSerialiser::SetNextValueU8));
+	array_benchmarks.push_back(new TypedArray<uint16_t>("array_u16", ARRAY_BYTES, &BytePipeSerialiser::SetNextValueU16));
+	array_benchmarks.push_back(new TypedArray<uint32_t>("array_u32", ARRAY_BYTES, &BytePipeSerialiser::SetNextValueU32));
+	array_benchmarks.push_back(new TypedArray<uint64_t>("array_u64", ARRAY_BYTES, &BytePipeSerialiser::SetNextValueU64));
+	array_benchmarks.push_back(new TypedArray<int8_t>("array_s8", ARRAY_BYTES, &BytePipeSerialiser::SetNextValueS8));
+	array_benchmarks.push_back(new TypedArray<int16_t>("array_s16", ARRAY_BYTES, &BytePipeSerialiser::SetNextValueS16));
+	array_benchmarks.push_back(new TypedArray<int32_t>("array_s32", ARRAY_BYTES, &BytePipeSerialiser::SetNextValueS32));
+	array_benchmarks.push_back(new TypedArray<int64_t>("array_s64", ARRAY_BYTES, &BytePipeSerialiser::SetNextValueS64));
+	array_benchmarks.push_back(new TypedArray<float>("array_f32", ARRAY_BYTES, &BytePipeSerialiser::SetNextValueF32));
+	array_benchmarks.push_back(new TypedArray<double>("array_f64", ARRAY_BYTES, &BytePipeSerialiser::SetNextValueF64));
+	array_benchmarks.push_back(new StringArray("array_string", 1000000u));
+
+	// Records are compared across the wire modes, arrays are the same in every mode
+	std::vector<Result> results;
+	const uint32_t modes[] = {
+		BytePipeFormat::MODE_DEFAULT,
+		BytePipeFormat::MODE_COMPACT,
+		BytePipeFormat::MODE_INDEXED,
+		BytePipeFormat::MODE_COMPACT | BytePipeFormat::MODE_INTERN_NAMES
+	};
+	for (Benchmark* benchmark : record_benchmarks) {
+		if (strstr(benchmark->name, filter) == nullptr) continue;
+		for (const uint32_t mode : modes) results.push_back(Run(*benchmark, mode));
+	}
+	for (Benchmark* benchmark : array_benchmarks) {
+		if (strstr(benchmark->name, filter) == nullptr) continue;
+		results.push_back(Run(*benchmark, BytePipeFormat::MODE_DEFAULT));
+	}
+
+	std::printf("{\n\t\"benchmarks\": [\n");
+	for (size_t i = 0u; i < results.size(); ++i) PrintResult(results[i], i + 1u == results.size());
+	std::printf("\t]\n}\n");
+
+	for (Benchmark* benchmark : record_benchmarks) delete benchmark;
+	for (Benchmark* benchmark : array_benchmarks) delete benchmark;
+	return 0;
+}
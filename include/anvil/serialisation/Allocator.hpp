@@ -0,0 +1,140 @@
+// MIT License
+// 
+// Copyright(c) 2021 Adam Smith
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef ANVIL_SERIALISATION_ALLOCATOR_HPP
+#define ANVIL_SERIALISATION_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+namespace anvil {
+
+	/*!
+		\brief Source of memory for serialisers.
+	*/
+	class Allocator {
+	public:
+		virtual ~Allocator() {}
+
+		virtual void* Allocate(const size_t bytes) = 0;
+		virtual void Deallocate(void* ptr, const size_t bytes) = 0;
+
+		/*!
+			\brief Try to grow an allocation without moving it.
+			\return True if the allocation is now at least new_bytes long.
+		*/
+		virtual bool TryExtend(void*, const size_t, const size_t) {
+			return false;
+		}
+
+		/*!
+			\brief Return an allocator that uses malloc and free.
+		*/
+		static Allocator& GetDefault();
+	};
+
+	/*!
+		\brief Hands out memory from large chunks in order, memory is only reclaimed when the arena is reset.
+		\details Freeing or growing the most recent allocation is done in place, which is the pattern of a
+		serialiser's output buffer. Chunks are kept by Reset, so an arena that is reset between documents stops
+		allocating once it has grown to fit the largest document. Nothing allocated from the arena may be used
+		after Reset, so serialisers using it must be destroyed first.
+	*/
+	class ArenaAllocator final : public Allocator {
+	private:
+		struct Chunk {
+			uint8_t* data;
+			size_t size;
+		};
+
+		std::vector<Chunk> _chunks;
+		size_t _chunk_size;			//!< Minimum size of a new chunk
+		size_t _current_chunk;		//!< Index of the chunk being allocated from
+		size_t _used;				//!< Bytes used in the current chunk
+		uint8_t* _last_allocation;	//!< Start of the most recent allocation
+
+		bool _NextChunk(const size_t bytes);
+	public:
+		ArenaAllocator(const size_t chunk_size = 64u * 1024u);
+		ArenaAllocator(const ArenaAllocator&) = delete;
+		ArenaAllocator& operator=(const ArenaAllocator&) = delete;
+		virtual ~ArenaAllocator();
+
+		/*!
+			\brief Reclaim everything that has been allocated, the chunks are kept for reuse.
+		*/
+		void Reset();
+
+		/*!
+			\brief Return the total size of the chunks owned by the arena.
+		*/
+		size_t GetCapacity() const;
+
+		// Inherited from Allocator
+
+		void* Allocate(const size_t bytes) final;
+		void Deallocate(void* ptr, const size_t bytes) final;
+		bool TryExtend(void* ptr, const size_t old_bytes, const size_t new_bytes) final;
+	};
+
+	/*!
+		\brief Adapts an Allocator for use with standard containers.
+	*/
+	template<class T>
+	class StlAllocator {
+	public:
+		typedef T value_type;
+
+		Allocator* allocator;
+
+		StlAllocator(Allocator& allocator) :
+			allocator(&allocator)
+		{}
+
+		template<class U>
+		StlAllocator(const StlAllocator<U>& other) :
+			allocator(other.allocator)
+		{}
+
+		T* allocate(const size_t count) {
+			return static_cast<T*>(allocator->Allocate(sizeof(T) * count));
+		}
+
+		void deallocate(T* ptr, const size_t count) {
+			allocator->Deallocate(ptr, sizeof(T) * count);
+		}
+
+		template<class U>
+		inline bool operator==(const StlAllocator<U>& other) const {
+			return allocator == other.allocator;
+		}
+
+		template<class U>
+		inline bool operator!=(const StlAllocator<U>& other) const {
+			return allocator != other.allocator;
+		}
+	};
+}
+
+#endif
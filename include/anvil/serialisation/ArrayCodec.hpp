@@ -0,0 +1,60 @@
+// MIT License
+// 
+// Copyright(c) 2021 Adam Smith
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef ANVIL_SERIALISATION_ARRAY_CODEC_HPP
+#define ANVIL_SERIALISATION_ARRAY_CODEC_HPP
+
+#include <vector>
+#include "anvil/serialisation/BytePipeFormat.hpp"
+
+namespace anvil { namespace ArrayCodec {
+
+	/*!
+		\brief Check if a codec can be applied to an array of a type.
+	*/
+	bool IsSupported(const Serialiser::Type type, const uint8_t codec);
+
+	/*!
+		\brief Encode an array of primitive values.
+		\param src The values to encode, in little-endian order.
+		\param count The number of values.
+		\param type The type of the values.
+		\param codec A combination of BytePipeFormat::Codec flags.
+		\param dst The encoded bytes are appended to this buffer.
+		\return The number of bytes appended.
+	*/
+	size_t Encode(const void* src, const size_t count, const Serialiser::Type type, const uint8_t codec, std::vector<uint8_t>& dst);
+
+	/*!
+		\brief Decode an array of primitive values.
+		\param src The encoded bytes.
+		\param bytes The number of encoded bytes.
+		\param count The number of values that were encoded.
+		\param type The type of the values.
+		\param codec The codec flags that the values were encoded with.
+		\param dst Where to write the decoded values in little-endian order, there must be space for count values.
+	*/
+	void Decode(const void* src, const size_t bytes, const size_t count, const Serialiser::Type type, const uint8_t codec, void* dst);
+
+}}
+
+#endif
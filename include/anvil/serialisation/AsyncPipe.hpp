@@ -0,0 +1,113 @@
+// MIT License
+// 
+// Copyright(c) 2021 Adam Smith
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef ANVIL_SERIALISATION_ASYNC_PIPE_HPP
+#define ANVIL_SERIALISATION_ASYNC_PIPE_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "anvil/byte-pipe/BytePipeWriter.hpp"
+
+namespace anvil {
+
+	/*!
+		\brief Writes to another pipe on a background thread so that the writer does not wait for I/O.
+		\details Bytes are copied into a ring of fixed size buffers, each full buffer is handed to the I/O thread by
+		advancing an atomic counter. The writer only waits when every buffer is queued, the time spent waiting is
+		recorded. Errors from the downstream pipe are thrown by the next WriteBytes or Flush.
+		Only one thread can write to the pipe at a time.
+	*/
+	class AsyncOutputPipe final : public BytePipe::OutputPipe {
+	private:
+		struct Buffer {
+			std::vector<uint8_t> data;
+			size_t size;	//!< Number of bytes written to the buffer
+			bool flush;		//!< True if the downstream pipe should be flushed after the buffer is written
+		};
+
+		BytePipe::OutputPipe& _downstream;
+		std::vector<Buffer> _buffers;
+		std::atomic<uint64_t> _head;		//!< Number of buffers the I/O thread has written
+		std::atomic<uint64_t> _tail;		//!< Number of buffers handed to the I/O thread
+		std::atomic<bool> _failed;			//!< True if the I/O thread has stored an error
+		std::exception_ptr _error;
+		std::thread _thread;
+		std::mutex _mutex;					//!< Only used to sleep and wake, buffers are handed over with _head and _tail
+		std::condition_variable _work_ready;
+		std::condition_variable _space_ready;
+		uint64_t _stall_count;				//!< Number of times the writer waited for a free buffer
+		uint64_t _stall_time;				//!< Nanoseconds the writer spent waiting for a free buffer
+		uint64_t _max_queue_depth;			//!< Most buffers that have been queued at once
+		bool _exit;
+
+		void _ThreadMain();
+		void _Submit(const bool flush);
+		void _WaitForSpace();
+		void _CheckError();
+	public:
+		/*!
+			\param downstream Where to write the bytes.
+			\param buffer_size Size of each buffer in bytes.
+			\param buffer_count Number of buffers, at least 2 so that one can be filled while another is written.
+		*/
+		AsyncOutputPipe(BytePipe::OutputPipe& downstream, const uint32_t buffer_size = 64u * 1024u, const uint32_t buffer_count = 4u);
+		AsyncOutputPipe(const AsyncOutputPipe&) = delete;
+		AsyncOutputPipe& operator=(const AsyncOutputPipe&) = delete;
+		virtual ~AsyncOutputPipe();
+
+		/*!
+			\brief Return the number of full buffers waiting to be written.
+		*/
+		uint32_t GetQueueDepth() const;
+
+		/*!
+			\brief Return the most buffers that have been waiting to be written at once.
+		*/
+		uint32_t GetMaxQueueDepth() const;
+
+		/*!
+			\brief Return the number of times the writer waited because every buffer was queued.
+		*/
+		uint64_t GetStallCount() const;
+
+		/*!
+			\brief Return the total time in nanoseconds the writer waited because every buffer was queued.
+		*/
+		uint64_t GetStallTime() const;
+
+		// Inherited from OutputPipe
+
+		uint32_t WriteBytes(const void* src, const uint32_t bytes) final;
+
+		/*!
+			\brief Write all buffered bytes and flush the downstream pipe, waiting until the I/O thread has done so.
+		*/
+		void Flush() final;
+	};
+}
+
+#endif
@@ -0,0 +1,89 @@
+// MIT License
+// 
+// Copyright(c) 2021 Adam Smith
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef ANVIL_SERIALISATION_BLOCK_COMPRESSION_HPP
+#define ANVIL_SERIALISATION_BLOCK_COMPRESSION_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace anvil { namespace BlockCompression {
+
+	/*
+		Compressed streams are a sequence of independent frames, each holding one block of the uncompressed stream :
+			uint8_t codec
+			uint32_t raw_size			Size of the uncompressed block
+			uint32_t stored_size		Size of the payload that follows
+			uint32_t checksum			Checksum of the uncompressed block
+			uint8_t payload[stored_size]
+
+		COMPRESSION_LZ payloads are sequences of a token byte, literals and a match :
+			The high 4 bits of the token are the literal count and the low 4 bits are the match length - 4, 15 means that
+			the count continues in the following bytes, each adds its value and 255 means another byte follows.
+			The literal count extension is followed by the literals, a uint16_t offset back into the output and then the
+			match length extension. The last sequence of a block only has literals.
+	*/
+
+	enum Codec : uint8_t {
+		COMPRESSION_NONE,	//!< The block is stored as it is
+		COMPRESSION_LZ,		//!< Built in LZ77 compression
+		COMPRESSION_ZSTD	//!< Zstandard, only available when built with ANVIL_USE_ZSTD
+	};
+
+	enum : uint32_t {
+		FRAME_HEADER_SIZE = 13u,
+		MAX_BLOCK_SIZE = 64u * 1024u * 1024u
+	};
+
+	/*!
+		\brief Check if a codec is available in this build.
+	*/
+	bool IsAvailable(const Codec codec);
+
+	/*!
+		\brief Return a 32-bit checksum of a block (xxHash32 with a seed of 0).
+	*/
+	uint32_t Checksum(const void* src, const size_t bytes);
+
+	/*!
+		\brief Compress a block and append it to a buffer as a frame.
+		\details The block is stored uncompressed if compressing it does not make it smaller.
+		\return The size of the frame in bytes.
+	*/
+	size_t WriteFrame(const void* src, const size_t bytes, const Codec codec, std::vector<uint8_t>& dst);
+
+	/*!
+		\brief Read the header of a frame.
+		\param header FRAME_HEADER_SIZE bytes.
+	*/
+	void ReadFrameHeader(const uint8_t* header, Codec& codec, uint32_t& raw_size, uint32_t& stored_size, uint32_t& checksum);
+
+	/*!
+		\brief Decompress the payload of a frame and verify its checksum.
+		\param dst Where to write the block, there must be space for raw_size bytes.
+	*/
+	void ReadFramePayload(const uint8_t* payload, const Codec codec, const uint32_t raw_size, const uint32_t stored_size, const uint32_t checksum, void* dst);
+
+}}
+
+#endif
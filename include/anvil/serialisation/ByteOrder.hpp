@@ -0,0 +1,127 @@
+// MIT License
+// 
+// Copyright(c) 2021 Adam Smith
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef ANVIL_SERIALISATION_BYTE_ORDER_HPP
+#define ANVIL_SERIALISATION_BYTE_ORDER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(_MSC_VER)
+	#include <stdlib.h>
+#endif
+
+// Serialised values are little-endian, big-endian hosts swap them as they are written and read
+#ifndef ANVIL_SERIALISATION_BIG_ENDIAN
+	#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+		#define ANVIL_SERIALISATION_BIG_ENDIAN 1
+	#else
+		#define ANVIL_SERIALISATION_BIG_ENDIAN 0
+	#endif
+#endif
+
+namespace anvil { namespace ByteOrder {
+
+	static inline uint8_t Swap(const uint8_t value) {
+		return value;
+	}
+
+	static inline uint16_t Swap(const uint16_t value) {
+		return static_cast<uint16_t>((value >> 8u) | (value << 8u));
+	}
+
+	static inline uint32_t Swap(const uint32_t value) {
+#if defined(_MSC_VER)
+		return _byteswap_ulong(value);
+#elif defined(__GNUC__)
+		return __builtin_bswap32(value);
+#else
+		return (value >> 24u) | ((value >> 8u) & 0x0000FF00u) | ((value << 8u) & 0x00FF0000u) | (value << 24u);
+#endif
+	}
+
+	static inline uint64_t Swap(const uint64_t value) {
+#if defined(_MSC_VER)
+		return _byteswap_uint64(value);
+#elif defined(__GNUC__)
+		return __builtin_bswap64(value);
+#else
+		return (static_cast<uint64_t>(Swap(static_cast<uint32_t>(value))) << 32u) | Swap(static_cast<uint32_t>(value >> 32u));
+#endif
+	}
+
+	/*!
+		\brief Reverse the bytes of each value in place.
+		\details This is a scalar loop, it is only used on big-endian hosts.
+		\param size The size of each value, 1, 2, 4 or 8 bytes.
+	*/
+	void SwapArray(void* values, const size_t size, const size_t count);
+
+	/*!
+		\brief Convert an unsigned integer between host order and the little-endian order of serialised data.
+		\details Swapping is its own inverse, so this converts in both directions.
+	*/
+	template<class T>
+	static inline T ToLittleEndian(const T value) {
+#if ANVIL_SERIALISATION_BIG_ENDIAN
+		return Swap(value);
+#else
+		return value;
+#endif
+	}
+
+	template<class T>
+	static inline T FromLittleEndian(const T value) {
+		return ToLittleEndian(value);
+	}
+
+	/*!
+		\brief Convert primitive values in place between host order and little-endian, nothing is done on little-endian hosts.
+	*/
+	static inline void ToLittleEndian(void* values, const size_t size, const size_t count) {
+#if ANVIL_SERIALISATION_BIG_ENDIAN
+		SwapArray(values, size, count);
+#else
+		(void)values;
+		(void)size;
+		(void)count;
+#endif
+	}
+
+	static inline void FromLittleEndian(void* values, const size_t size, const size_t count) {
+		ToLittleEndian(values, size, count);
+	}
+
+	static inline uint32_t LoadLittleEndian32(const void* src) {
+		uint32_t value;
+		memcpy(&value, src, sizeof(value));
+		return FromLittleEndian(value);
+	}
+
+	static inline void StoreLittleEndian32(void* dst, uint32_t value) {
+		value = ToLittleEndian(value);
+		memcpy(dst, &value, sizeof(value));
+	}
+}}
+
+#endif
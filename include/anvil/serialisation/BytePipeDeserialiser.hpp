@@ -0,0 +1,295 @@
+// MIT License
+// 
+// Copyright(c) 2021 Adam Smith
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef ANVIL_SERIALISATION_BYTE_PIPE_DESERIALISER_HPP
+#define ANVIL_SERIALISATION_BYTE_PIPE_DESERIALISER_HPP
+
+#include <string>
+#include <vector>
+#include <cstring>
+#include <stdexcept>
+#include "anvil/serialisation/BytePipeFormat.hpp"
+#include "anvil/serialisation/Reflection.hpp"
+#include "anvil/byte-pipe/BytePipeReader.hpp"
+
+namespace anvil {
+
+	/*!
+		\brief Pull based reader for data written by BytePipeSerialiser.
+		\details Only a fixed size window of the input is held in memory. Typed array reads copy
+		straight into the caller's buffer, large reads bypass the window and are read from the pipe directly.
+	*/
+	class BytePipeDeserialiser {
+	public:
+		typedef Serialiser::Type Type;
+	private:
+		struct State {
+			Type type;
+			Type sub_type;			//!< Type of the array values
+			bool name_read;			//!< True if the name of the next object member has been read
+			bool compact;			//!< True if the container uses the compact layout
+			bool interned;			//!< True if the object member names are interned
+			bool decoded;			//!< True if the array values are read from the decoded buffer
+			bool chunked;			//!< True if more segments of a chunked array follow, remaining is then the count of the current segment
+			uint32_t remaining;		//!< Number of values or members that have not been read yet
+			uint32_t index_bytes;	//!< Size of the index at the end of the container
+		};
+
+		BytePipe::InputPipe& _pipe;
+		std::vector<State> _states;
+		std::vector<uint8_t> _window;
+		size_t _window_begin;
+		size_t _window_end;
+		std::string _name_buffer;
+		std::vector<std::string> _names;	//!< Interned member names, indexed by ID
+		bool _value_compact;				//!< True if the value being read uses the compact layout
+		std::vector<uint8_t> _encoded;		//!< Encoded values of the current array
+		std::vector<uint8_t> _decoded;		//!< Decoded values of the current array, encoded arrays only contain primitives so cannot be nested
+		size_t _decoded_begin;				//!< Position of the next unread value in the decoded buffer
+
+		void _Fill(const size_t bytes);
+		void _ReadBytes(void* dst, const size_t bytes);
+		void _SkipBytes(size_t bytes);
+		uint32_t _ReadLength(const bool compact);
+		void _ReadString(std::string& dst, const bool compact);
+		void _PeekContainerHeader(BytePipeFormat::ContainerInfo& info);
+		void _ReadName();
+		void _Compact();
+		uint8_t _PeekByte();
+		Type _PeekType();
+		void _BeginValue(const Type type, const uint32_t count);
+		void ReadBytes(void* dst, const size_t bytes, const Type type, const uint32_t count);
+		void _DecodeArray(const BytePipeFormat::ContainerInfo& header);
+		void _ReadSegment(State& state, const bool first);
+		void _ReadArray(Deserialiser& dst, const Type sub_type, uint32_t length);
+
+		// Struct reading
+
+		template<class T>
+		inline typename std::enable_if<Reflection::IsPrimitive<T>::value>::type _ReadStructMember(T& value) {
+			ReadBytes(&value, sizeof(T), static_cast<Type>(BytePipeFormat::TypeOf<T>::value), 1u);
+		}
+
+		inline void _ReadStructMember(std::string& value) {
+			ReadValueString(value);
+		}
+
+		template<class T>
+		void _ReadStructMember(std::vector<T>& value);
+
+		template<class T>
+		inline typename std::enable_if<Reflection::IsReflected<T>::value>::type _ReadStructMember(T& value) {
+			ReadValueStruct(value);
+		}
+
+		template<class T>
+		inline void _ReadStructElements(std::vector<T>& value, std::true_type) {
+			ReadBytes(value.data(), sizeof(T) * value.size(), static_cast<Type>(BytePipeFormat::TypeOf<T>::value), static_cast<uint32_t>(value.size()));
+		}
+
+		template<class T>
+		inline void _ReadStructElements(std::vector<T>& value, std::false_type) {
+			for (T& element : value) _ReadStructMember(element);
+		}
+
+		// Column reading
+
+		template<class T, class M>
+		typename std::enable_if<Reflection::IsPrimitive<M>::value>::type _ReadColumnElements(std::vector<T>& rows, M T::* member) {
+			// Read the values in blocks and scatter them into the rows
+			enum : size_t { BLOCK_SIZE = 256u };
+			M block[BLOCK_SIZE];
+			for (size_t i = 0u; i < rows.size(); i += BLOCK_SIZE) {
+				const size_t count = rows.size() - i < BLOCK_SIZE ? rows.size() - i : BLOCK_SIZE;
+				ReadBytes(block, sizeof(M) * count, static_cast<Type>(BytePipeFormat::TypeOf<M>::value), static_cast<uint32_t>(count));
+				for (size_t j = 0u; j < count; ++j) rows[i + j].*member = block[j];
+			}
+		}
+
+		template<class T, class M>
+		typename std::enable_if<!Reflection::IsPrimitive<M>::value>::type _ReadColumnElements(std::vector<T>& rows, M T::* member) {
+			for (T& row : rows) _ReadStructMember(row.*member);
+		}
+	public:
+		BytePipeDeserialiser(BytePipe::InputPipe& pipe, const size_t window_size = 64u * 1024u);
+		BytePipeDeserialiser(const BytePipeDeserialiser&) = delete;
+		BytePipeDeserialiser& operator=(const BytePipeDeserialiser&) = delete;
+		~BytePipeDeserialiser();
+
+		/*!
+			\brief Start reading a document that was written between BytePipeSerialiser::BeginDocument and EndDocument.
+			\details Interned member names from previous documents are forgotten.
+		*/
+		void BeginDocument();
+
+		/*!
+			\brief Return the type of the next value without reading it.
+		*/
+		Type GetNextType();
+
+		/*!
+			\brief Read the name of the next member of the current object.
+			\details Reading a value without calling this first discards the name.
+		*/
+		const std::string& GetNextMemberName();
+
+		/*!
+			\brief Return the number of values or members in the current container that have not been read.
+			\details For chunked arrays this is the number left in the current segment, the next segment is read
+			when it reaches 0, so the array has been read once this returns 0.
+		*/
+		uint32_t GetRemainingCount();
+
+		uint8_t ReadValueU8();
+		uint16_t ReadValueU16();
+		uint32_t ReadValueU32();
+		uint64_t ReadValueU64();
+		int8_t ReadValueS8();
+		int16_t ReadValueS16();
+		int32_t ReadValueS32();
+		int64_t ReadValueS64();
+		float ReadValueF32();
+		double ReadValueF64();
+		std::string ReadValueString();
+		void ReadValueString(std::string& value);
+
+		/*!
+			\brief Start reading an array.
+			\param sub_type Set to the type of values in the array.
+			\return The number of values in the array, or in the first segment of a chunked array.
+		*/
+		uint32_t StartArray(Type& sub_type);
+		uint32_t StartArray();
+
+		/*!
+			\brief Finish reading an array, any values that were not read are skipped.
+		*/
+		void EndArray();
+
+		/*!
+			\brief Start reading an object.
+			\return The number of members in the object.
+		*/
+		uint32_t StartObject();
+
+		/*!
+			\brief Finish reading an object, any members that were not read are skipped.
+		*/
+		void EndObject();
+
+		// Array optimisations, values are copied directly into the caller's buffer
+
+		void ReadValueU8(uint8_t* value, const size_t count);
+		void ReadValueU16(uint16_t* value, const size_t count);
+		void ReadValueU32(uint32_t* value, const size_t count);
+		void ReadValueU64(uint64_t* value, const size_t count);
+		void ReadValueS8(int8_t* value, const size_t count);
+		void ReadValueS16(int16_t* value, const size_t count);
+		void ReadValueS32(int32_t* value, const size_t count);
+		void ReadValueS64(int64_t* value, const size_t count);
+		void ReadValueF32(float* value, const size_t count);
+		void ReadValueF64(double* value, const size_t count);
+
+		/*!
+			\brief Read an object into a struct that has an ANVIL_SCHEMA.
+			\details Members are matched to fields by name, so they can be in any order. Members without a field are
+			skipped and fields without a member keep their value.
+		*/
+		template<class T>
+		void ReadValueStruct(T& value);
+
+		/*!
+			\brief Read structs that have an ANVIL_SCHEMA from columns written by BytePipeSerialiser::SetNextValueColumns.
+			\details Columns are matched to fields by name. Columns without a field are skipped and fields without a
+			column keep their value.
+		*/
+		template<class T>
+		void ReadValueColumns(std::vector<T>& rows);
+
+		/*!
+			\brief Skip the next value without decoding it.
+		*/
+		void SkipValue();
+
+		/*!
+			\brief Read the next value and pass it to another serialiser.
+		*/
+		void ReadValue(Deserialiser& dst);
+	};
+
+	template<class T>
+	void BytePipeDeserialiser::_ReadStructMember(std::vector<T>& value) {
+		const uint32_t length = StartArray();
+		value.resize(length);
+		if (length > 0u) _ReadStructElements(value, std::integral_constant<bool, Reflection::IsPrimitive<T>::value>());
+		EndArray();
+	}
+
+	template<class T>
+	void BytePipeDeserialiser::ReadValueStruct(T& value) {
+		static_assert(Reflection::IsReflected<T>::value, "BytePipeDeserialiser::ReadValueStruct : Type does not have a schema");
+
+		const uint32_t count = StartObject();
+		for (uint32_t i = 0u; i < count; ++i) {
+			const std::string& name = GetNextMemberName();
+			bool found = false;
+			Reflection::ForEachField<T>([this, &value, &name, &found](const auto& field) {
+				if (!found && field.name_length == name.size() && memcmp(field.name, name.data(), name.size()) == 0) {
+					_ReadStructMember(value.*(field.member));
+					found = true;
+				}
+			});
+			if (!found) SkipValue();
+		}
+		EndObject();
+	}
+
+	template<class T>
+	void BytePipeDeserialiser::ReadValueColumns(std::vector<T>& rows) {
+		static_assert(Reflection::IsReflected<T>::value, "BytePipeDeserialiser::ReadValueColumns : Type does not have a schema");
+
+		bool sized = false;
+		const uint32_t count = StartObject();
+		for (uint32_t i = 0u; i < count; ++i) {
+			const std::string& name = GetNextMemberName();
+			bool found = false;
+			Reflection::ForEachField<T>([this, &rows, &name, &found, &sized](const auto& field) {
+				if (!found && field.name_length == name.size() && memcmp(field.name, name.data(), name.size()) == 0) {
+					const uint32_t length = StartArray();
+					if (!sized) {
+						rows.resize(length);
+						sized = true;
+					} else if (length != rows.size()) {
+						throw std::runtime_error("BytePipeDeserialiser::ReadValueColumns : Columns have different lengths");
+					}
+					_ReadColumnElements(rows, field.member);
+					EndArray();
+					found = true;
+				}
+			});
+			if (!found) SkipValue();
+		}
+		EndObject();
+	}
+}
+
+#endif
@@ -0,0 +1,356 @@
+// MIT License
+// 
+// Copyright(c) 2021 Adam Smith
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef ANVIL_SERIALISATION_BYTE_PIPE_FORMAT_HPP
+#define ANVIL_SERIALISATION_BYTE_PIPE_FORMAT_HPP
+
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include "anvil/serialisation/ByteOrder.hpp"
+#include "anvil/serialisation/Serialiser.hpp"
+
+namespace anvil { namespace BytePipeFormat {
+
+	/*
+		Layout written by BytePipeSerialiser :
+
+		Value outside of an array : A Type byte followed by the value (containers start with their header instead)
+		String : uint32_t length followed by the characters, without a null terminator
+		Array : ArrayHeader followed by length values of sub_type, which are not prefixed with their type
+		Object : ObjectHeader followed by length members, each is a string name followed by a value
+
+		All multi-byte values, lengths and offsets are little-endian, big-endian hosts swap them when they are written and read.
+		ArrayHeader is 12 bytes : type, 3 zero bytes, uint32_t length, sub_type, 3 zero bytes.
+		ObjectHeader is 8 bytes : type, 3 zero bytes, uint32_t length.
+
+		Arrays of primitive values wider than a byte that are written with MODE_ALIGNED set SUB_TYPE_PADDED in their sub_type.
+		The rest of the header is followed by a padding count byte and that many zero bytes, which place the first value at
+		a multiple of its size from the start of the stream. Padding is part of the header, so readers that do not care about
+		alignment skip it. The same applies to each segment of a chunked array.
+
+		Indexed containers (MODE_INDEXED) set FLAG_INDEXED in the header type. The header is followed by a uint32_t
+		size of the whole container in bytes, and the container ends with an index :
+			Object : length IndexEntry sorted by hash, offsets are to the member name
+			Array : length uint32_t element offsets, omitted when the sub_type is primitive
+		All offsets are relative to the start of the container header.
+
+		Compact values (MODE_COMPACT) set FLAG_COMPACT in every type byte, values inside a compact container are also compact.
+		Lengths are LEB128 varints and the headers are packed without padding :
+			Array : type, sub_type, [uint32_t size], varint length
+			Object : type, [uint32_t size], varint length
+		The header length may be padded with redundant continuation bytes, up to MAX_VARINT_SIZE.
+
+		Objects with interned names (MODE_INTERN_NAMES) set FLAG_INTERNED in the header type. Each member name is a varint,
+		0 is followed by the name as a string and assigns it the next ID, otherwise the value is a previously assigned ID + 1.
+		IDs are shared by the whole stream, once MAX_INTERNED_NAMES have been assigned new names are no longer assigned an ID.
+		Because IDs are assigned in stream order, interned names cannot be combined with MODE_INDEXED.
+
+		Chunked arrays set FLAG_CHUNKED in the header type, which is the only byte of their header. It is followed by segments, each is a
+		uint32_t number of values, the sub_type and then the values. A segment with 0 values ends the array and has no sub_type.
+		Every segment has the same sub_type, so the values read as a single array. Chunked arrays are never indexed or encoded.
+
+		Encoded arrays set FLAG_ENCODED in the header type. The header is followed by a Codec byte and the uint32_t size of
+		the encoded values, which replace the raw values. The header length is still the number of values.
+		Encoding is applied in order : CODEC_DELTA, CODEC_ZIGZAG and then either CODEC_BIT_PACK or CODEC_RUN_LENGTH.
+			CODEC_BIT_PACK : Blocks of CODEC_BLOCK_SIZE values, each is a reference value (the minimum), a bit width byte and
+				the differences from the reference packed into that many bits, least significant bit first.
+			CODEC_RUN_LENGTH : Pairs of a varint run length and a value.
+		Float arrays apply CODEC_XOR and then either CODEC_BYTE_SHUFFLE or, if that is not set, XOR packing.
+			XOR packing : A bit stream, LSB first, with an entry per value. 0 if the XOR is zero, 10 followed by the meaningful
+				bits if they fit inside the previous window, otherwise 11, the leading zero count, meaningful bit count - 1 and the
+				meaningful bits. The counts are 5 bits for 32-bit floats and 6 bits for 64-bit floats.
+			CODEC_BYTE_SHUFFLE : Blocks of CODEC_SHUFFLE_BLOCK_SIZE values, each with one plane per byte of the value type that
+				holds that byte of every value in the block. Planes begin with a byte that is 0 if the plane is raw or 1 if it is
+				pairs of a varint run length and a byte.
+	*/
+
+	enum Mode : uint32_t {
+		MODE_DEFAULT = 0u,
+		MODE_INDEXED = 1u,		//!< Containers record their size and an index of their members
+		MODE_COMPACT = 2u,		//!< Packed headers and varint lengths
+		MODE_INTERN_NAMES = 4u,	//!< Member names are written once per stream and then referred to by ID
+		MODE_ALIGNED = 8u		//!< Array values are padded to a multiple of their size from the start of the stream
+	};
+
+	enum Codec : uint8_t {
+		CODEC_NONE = 0x00,			//!< Values are written as they are
+		CODEC_DELTA = 0x01,			//!< Write the difference from the previous value
+		CODEC_ZIGZAG = 0x02,		//!< Map signed values to unsigned so that small negative values have leading zeros
+		CODEC_BIT_PACK = 0x04,		//!< Frame of reference bit packing
+		CODEC_RUN_LENGTH = 0x08,	//!< Write repeated values once with a count
+		CODEC_XOR = 0x10,			//!< Floats only, XOR with the previous value and pack the meaningful bits of the result
+		CODEC_BYTE_SHUFFLE = 0x20	//!< Floats only, group each byte of the values together and run length encode the groups
+	};
+
+	enum : uint8_t {
+		TYPE_MASK = 0x0F,		//!< Bits of a type byte that hold the Serialiser::Type
+		FLAG_CHUNKED = 0x10,	//!< Set in an array header when the values are written in segments
+		FLAG_INTERNED = 0x20,	//!< Set in an object header when member names are interned
+		FLAG_ENCODED = 0x20,	//!< Set in an array header when the values are encoded
+		FLAG_COMPACT = 0x40,	//!< Set in the type byte of compact values
+		FLAG_INDEXED = 0x80,	//!< Set in a container header when it is indexed
+		SUB_TYPE_PADDED = 0x80	//!< Set in the sub_type of an array when padding follows the header
+	};
+
+	enum : uint32_t {
+		MAX_VARINT_SIZE = 5u,
+		MAX_HEADER_SIZE = 21u,
+		CODEC_BLOCK_SIZE = 128u,
+		CODEC_SHUFFLE_BLOCK_SIZE = 4096u,
+		MAX_INTERNED_NAMES = 65536u,
+		SEGMENT_HEADER_SIZE = 5u	//!< Size of the uint32_t count and sub_type before each segment of a chunked array
+	};
+
+	struct ArrayHeader {
+		Serialiser::Type type;
+		uint32_t length;
+		Serialiser::Type sub_type;
+	};
+
+	struct ObjectHeader {
+		Serialiser::Type type;
+		uint32_t length;
+	};
+
+	// The headers are copied as they are, so their layout is part of the format
+	static_assert(sizeof(ArrayHeader) == 12u && offsetof(ArrayHeader, length) == 4u && offsetof(ArrayHeader, sub_type) == 8u, "BytePipeFormat : Unexpected ArrayHeader layout");
+	static_assert(sizeof(ObjectHeader) == 8u && offsetof(ObjectHeader, length) == 4u, "BytePipeFormat : Unexpected ObjectHeader layout");
+
+	/*!
+		\brief Container header decoded from either layout.
+	*/
+	struct ContainerInfo {
+		uint8_t flags;				//!< Flag bits of the type byte
+		Serialiser::Type type;
+		Serialiser::Type sub_type;	//!< Type of the array values
+		uint32_t length;			//!< Number of array values or object members
+		uint32_t size;				//!< Size of the container in bytes if it is indexed
+		uint32_t header_size;		//!< Bytes from the start of the container to its first value
+		uint32_t encoded_size;		//!< Size of the encoded array values if the array is encoded
+		uint8_t codec;				//!< Codec flags if the array is encoded
+	};
+
+	struct IndexEntry {
+		uint32_t hash;			//!< HashName of the member name
+		uint32_t offset;		//!< Offset of the member from the start of the object header
+	};
+
+	static inline Serialiser::Type GetType(const uint8_t type_byte) {
+		return static_cast<Serialiser::Type>(type_byte & TYPE_MASK);
+	}
+
+	static inline uint32_t HashName(const char* name, const size_t length) {
+		// 32-bit FNV-1a
+		uint32_t hash = 2166136261u;
+		for (size_t i = 0u; i < length; ++i) {
+			hash ^= static_cast<uint8_t>(name[i]);
+			hash *= 16777619u;
+		}
+		return hash;
+	}
+
+	static inline size_t GetVarintSize(uint32_t value) {
+		size_t size = 1u;
+		while (value >= 0x80) {
+			value >>= 7u;
+			++size;
+		}
+		return size;
+	}
+
+	/*!
+		\brief Write a LEB128 varint.
+		\param padded_size If not zero the value is padded with continuation bytes to fill this many bytes.
+		\return The number of bytes written.
+	*/
+	static inline size_t WriteVarint(uint8_t* dst, uint32_t value, const size_t padded_size = 0u) {
+		const size_t size = padded_size > 0u ? padded_size : GetVarintSize(value);
+		for (size_t i = 1u; i < size; ++i) {
+			dst[i - 1u] = static_cast<uint8_t>(value & 0x7F) | 0x80;
+			value >>= 7u;
+		}
+		dst[size - 1u] = static_cast<uint8_t>(value);
+		return size;
+	}
+
+	/*!
+		\brief Read a LEB128 varint.
+		\return The number of bytes read, or a value larger than available if more bytes are needed.
+	*/
+	static inline size_t ReadVarint(const uint8_t* src, const size_t available, uint32_t& value) {
+		value = 0u;
+		for (size_t i = 0u; i < MAX_VARINT_SIZE; ++i) {
+			if (i >= available) return available + 1u;
+			value |= static_cast<uint32_t>(src[i] & 0x7F) << (7u * i);
+			if ((src[i] & 0x80) == 0u) return i + 1u;
+		}
+		throw std::runtime_error("BytePipeFormat::ReadVarint : Varint is too long");
+	}
+
+	/*!
+		\brief Read the length prefix of a string or member name.
+		\return The number of bytes read, or a value larger than available if more bytes are needed.
+	*/
+	static inline size_t ReadLength(const uint8_t* src, const size_t available, const bool compact, uint32_t& length) {
+		if (compact) return ReadVarint(src, available, length);
+		if (available < sizeof(uint32_t)) return sizeof(uint32_t);
+		length = ByteOrder::LoadLittleEndian32(src);
+		return sizeof(uint32_t);
+	}
+
+	/*!
+		\brief Read the padding that follows a header with SUB_TYPE_PADDED.
+		\return The size of the padding, or a value larger than available if more bytes are needed.
+	*/
+	static inline size_t ReadPadding(const uint8_t* src, const size_t available) {
+		if (available < 1u) return 1u;
+		return 1u + src[0u];
+	}
+
+	/*!
+		\brief Decode a container header.
+		\return The size of the header, or a value larger than available if more bytes are needed.
+	*/
+	static inline size_t ReadContainerHeader(const uint8_t* src, const size_t available, ContainerInfo& info) {
+		if (available < 1u) return 1u;
+		info.flags = src[0u] & ~TYPE_MASK;
+		info.type = GetType(src[0u]);
+		info.sub_type = Serialiser::TYPE_UNSIGNED_8;
+		info.size = 0u;
+		if (info.type != Serialiser::TYPE_ARRAY && info.type != Serialiser::TYPE_OBJECT) throw std::runtime_error("BytePipeFormat::ReadContainerHeader : Value is not a container");
+
+		// The segments of chunked arrays are read separately
+		if (info.flags & FLAG_CHUNKED) {
+			if (info.type != Serialiser::TYPE_ARRAY) throw std::runtime_error("BytePipeFormat::ReadContainerHeader : Only arrays can be chunked");
+			info.length = 0u;
+			info.codec = CODEC_NONE;
+			info.encoded_size = 0u;
+			info.header_size = 1u;
+			return 1u;
+		}
+
+		size_t header_size;
+		if (info.flags & FLAG_COMPACT) {
+			header_size = 1u;
+			if (info.type == Serialiser::TYPE_ARRAY) {
+				if (available < 2u) return 2u;
+				info.sub_type = static_cast<Serialiser::Type>(src[1u]);
+				++header_size;
+			}
+			if (info.flags & FLAG_INDEXED) {
+				if (available < header_size + sizeof(uint32_t)) return header_size + sizeof(uint32_t);
+				info.size = ByteOrder::LoadLittleEndian32(src + header_size);
+				header_size += sizeof(uint32_t);
+			}
+			const size_t varint_size = ReadVarint(src + header_size, available - header_size, info.length);
+			header_size += varint_size;
+			if (header_size > available) return header_size;
+		} else {
+			if (info.type == Serialiser::TYPE_ARRAY) {
+				ArrayHeader header;
+				header_size = sizeof(header);
+				if (available < header_size) return header_size;
+				memcpy(&header, src, sizeof(header));
+				info.length = ByteOrder::FromLittleEndian(header.length);
+				info.sub_type = header.sub_type;
+			} else {
+				ObjectHeader header;
+				header_size = sizeof(header);
+				if (available < header_size) return header_size;
+				memcpy(&header, src, sizeof(header));
+				info.length = ByteOrder::FromLittleEndian(header.length);
+			}
+			if (info.flags & FLAG_INDEXED) {
+				if (available < header_size + sizeof(uint32_t)) return header_size + sizeof(uint32_t);
+				info.size = ByteOrder::LoadLittleEndian32(src + header_size);
+				header_size += sizeof(uint32_t);
+			}
+		}
+
+		// Encoded arrays are followed by the codec and size of the encoded values
+		info.codec = CODEC_NONE;
+		info.encoded_size = 0u;
+		if (info.type == Serialiser::TYPE_ARRAY && (info.flags & FLAG_ENCODED)) {
+			if (available < header_size + 1u + sizeof(uint32_t)) return header_size + 1u + sizeof(uint32_t);
+			info.codec = src[header_size];
+			info.encoded_size = ByteOrder::LoadLittleEndian32(src + header_size + 1u);
+			header_size += 1u + sizeof(uint32_t);
+		}
+
+		// Padding that aligns the values is skipped with the header
+		if (info.type == Serialiser::TYPE_ARRAY && (info.sub_type & SUB_TYPE_PADDED)) {
+			info.sub_type = static_cast<Serialiser::Type>(info.sub_type & ~SUB_TYPE_PADDED);
+			const size_t padding = ReadPadding(src + header_size, available - header_size);
+			header_size += padding;
+			if (header_size > available) return header_size;
+		}
+
+		info.header_size = static_cast<uint32_t>(header_size);
+		return header_size;
+	}
+
+	/*!
+		\brief Decode the header of a segment of a chunked array.
+		\return The size of the header, or a value larger than available if more bytes are needed.
+	*/
+	static inline size_t ReadSegmentHeader(const uint8_t* src, const size_t available, uint32_t& length, Serialiser::Type& sub_type) {
+		if (available < sizeof(uint32_t)) return sizeof(uint32_t);
+		length = ByteOrder::LoadLittleEndian32(src);
+		if (length == 0u) return sizeof(uint32_t);
+		if (available < SEGMENT_HEADER_SIZE) return SEGMENT_HEADER_SIZE;
+		sub_type = static_cast<Serialiser::Type>(src[sizeof(uint32_t)]);
+		if ((sub_type & SUB_TYPE_PADDED) == 0u) return SEGMENT_HEADER_SIZE;
+
+		sub_type = static_cast<Serialiser::Type>(sub_type & ~SUB_TYPE_PADDED);
+		return SEGMENT_HEADER_SIZE + ReadPadding(src + SEGMENT_HEADER_SIZE, available - SEGMENT_HEADER_SIZE);
+	}
+
+	static inline bool IsPrimitiveType(const Serialiser::Type type) {
+		return type <= Serialiser::TYPE_FLOAT_64;
+	}
+
+	static inline size_t GetPrimitiveSize(const Serialiser::Type type) {
+		static const uint8_t g_sizes[] = { 1u, 2u, 4u, 8u, 1u, 2u, 4u, 8u, 4u, 8u };
+		return IsPrimitiveType(type) ? g_sizes[type] : 0u;
+	}
+
+	/*!
+		\brief Maps a primitive C++ type to its Serialiser::Type.
+	*/
+	template<class T>
+	struct TypeOf;
+
+	template<> struct TypeOf<uint8_t> { enum : uint8_t { value = Serialiser::TYPE_UNSIGNED_8 }; };
+	template<> struct TypeOf<uint16_t> { enum : uint8_t { value = Serialiser::TYPE_UNSIGNED_16 }; };
+	template<> struct TypeOf<uint32_t> { enum : uint8_t { value = Serialiser::TYPE_UNSIGNED_32 }; };
+	template<> struct TypeOf<uint64_t> { enum : uint8_t { value = Serialiser::TYPE_UNSIGNED_64 }; };
+	template<> struct TypeOf<int8_t> { enum : uint8_t { value = Serialiser::TYPE_SIGNED_8 }; };
+	template<> struct TypeOf<int16_t> { enum : uint8_t { value = Serialiser::TYPE_SIGNED_16 }; };
+	template<> struct TypeOf<int32_t> { enum : uint8_t { value = Serialiser::TYPE_SIGNED_32 }; };
+	template<> struct TypeOf<int64_t> { enum : uint8_t { value = Serialiser::TYPE_SIGNED_64 }; };
+	template<> struct TypeOf<float> { enum : uint8_t { value = Serialiser::TYPE_FLOAT_32 }; };
+	template<> struct TypeOf<double> { enum : uint8_t { value = Serialiser::TYPE_FLOAT_64 }; };
+
+}}
+
+#endif
@@ -23,28 +23,52 @@
 #ifndef ANVIL_SERIALISATION_BYTE_PIPE_SERIALISER_HPP
 #define ANVIL_SERIALISATION_BYTE_PIPE_SERIALISER_HPP
 
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <string>
 #include <vector>
-#include "anvil/serialisation/Serialiser.hpp"
+#include "anvil/serialisation/Allocator.hpp"
+#include "anvil/serialisation/BytePipeFormat.hpp"
+#include "anvil/serialisation/BytePipeView.hpp"
+#include "anvil/serialisation/GatherPipe.hpp"
+#include "anvil/serialisation/Reflection.hpp"
+#include "anvil/serialisation/SerialiserStats.hpp"
 #include "anvil/byte-pipe/BytePipeWriter.hpp"
 
 namespace anvil {
 	
 	class BytePipeSerialiser final : public Serialiser {
 	private:
-		struct ArrayHeader {
-			Type type;
-			uint32_t length;
-			Type sub_type;
+		typedef BytePipeFormat::ArrayHeader ArrayHeader;
+		typedef BytePipeFormat::ObjectHeader ObjectHeader;
+		typedef BytePipeFormat::IndexEntry IndexEntry;
+
+		struct Reference {
+			size_t offset;		//!< Position in the buffer that the bytes belong at
+			const void* data;
+			size_t bytes;
 		};
-	
-		struct ObjectHeader {
-			Type type;
+
+		struct InternedName {
+			size_t offset;		//!< Position of the first character in _name_chars
 			uint32_t length;
+			uint32_t hash;		//!< HashName of the name
+			uint32_t slot;		//!< Position of the name in _name_slots
+		};
+
+		enum : size_t {
+			COMPACT_SHRINK_LIMIT = 4096u,	//!< Largest compact container that is moved back to remove the padding from its length
+			PARALLEL_CHUNKS_PER_THREAD = 4u,	//!< Number of chunks each thread gets when writing in parallel, threads that finish early take the remaining chunks
+			CURSOR_RESERVE_SIZE = 4096u,	//!< Minimum number of bytes an ArrayCursor reserves at a time
+			DEFAULT_SEGMENT_SIZE = 65536u,	//!< Number of bytes a chunked array buffers before writing a segment
+			MIN_NAME_SLOTS = 64u			//!< Smallest size of the interned name hash table
 		};
 	
 		struct State {
-			std::string name_buffer;
-			std::vector<uint8_t> byte_buffer;
+			size_t header_offset;	//!< Offset of the container header within the shared buffer
+			size_t index_begin;		//!< Position of the first index entry for this container
+			size_t reference_bytes;	//!< Value of _reference_bytes when the container started
 			Type type;
 			union {
 				struct {
@@ -53,20 +77,447 @@ namespace anvil {
 				struct {
 					uint32_t length;
 					Type type;
+					uint8_t codec;	//!< BytePipeFormat::Codec flags requested for the values
+					bool chunked;	//!< True if the values are written to the pipe in segments, header_offset is then the current segment header
+					bool padded;	//!< True if padding was written before the values of the array or current segment
 				} array_data;
 			};
 		};
 
-		BytePipe::OutputPipe& _pipe;
-		std::vector<State> _states;
+		BytePipe::OutputPipe* _pipe;
+		Allocator& _allocator;		//!< Source of the buffer and the container stacks
+		std::vector<State, StlAllocator<State>> _states;
+		std::vector<IndexEntry, StlAllocator<IndexEntry>> _index;	//!< Index entries of all open containers when indexing is enabled
+		std::string _name_buffer;	//!< Name of the next member of the innermost object, shared so that States do not own heap memory
+		uint8_t* _buffer;			//!< Shared output buffer for all nesting levels, flushed to the pipe when the outermost container ends
+		size_t _buffer_size;		//!< Number of bytes written to the buffer
+		size_t _buffer_capacity;	//!< Number of bytes allocated for the buffer
+		uint32_t _mode;				//!< BytePipeFormat::Mode flags
+		bool _document_open;		//!< True between BeginDocument and EndDocument, values are kept in the buffer until the document ends
+		size_t _base_depth;			//!< Number of states that cannot be ended, 1 for serialisers that write part of another serialiser's container
+		bool _cursor_open;			//!< True while an ArrayCursor is appending to the current array
+		std::vector<InternedName, StlAllocator<InternedName>> _names;	//!< Interned member names, indexed by ID
+		std::vector<uint32_t, StlAllocator<uint32_t>> _name_slots;	//!< Open addressing hash table of ID + 1 for each interned name, 0 if the slot is empty
+		std::vector<char, StlAllocator<char>> _name_chars;	//!< Characters of the interned names, cleared between documents without freeing them
+		std::vector<uint8_t> _codec_buffer;	//!< Scratch space for encoding array values
+		std::vector<Reference> _references;	//!< Caller memory that is written in place of buffer bytes, in buffer order
+		std::vector<GatherOutputPipe::Fragment> _fragments;	//!< Scratch space for writing the buffer with its references
+		size_t _reference_bytes;	//!< Total size of the references
+		size_t _reference_threshold;	//!< Size of the smallest array that is referenced instead of copied, 0 if arrays are always copied
+		size_t _segment_size;		//!< Number of bytes the open chunked array buffers before writing a segment
+		uint64_t _segment_count;	//!< Number of segments of the open chunked array that have been written
+		uint64_t _stream_position;	//!< Number of bytes written to the pipe, MODE_ALIGNED pads values relative to this
+#if ANVIL_SERIALISATION_STATS
+		SerialiserStats _stats;
+		SerialiserStatsSink* _stats_sink;	//!< Receives the stats when the pipe is flushed and when the serialiser is destroyed, may be null
+#endif
 	
+		void _GrowBuffer(const size_t required);
+		void _AppendLength(const uint32_t length);
+		void _AppendPadding(const size_t alignment);
+		void _AppendContainerHeader(const Type type, const uint32_t length, const Type sub_type);
 		void _WriteBytes(const void* data, const size_t bytes);
+		void _WriteLength(const uint32_t length);
 		void _WriteString(const void* data, const size_t bytes);
+		void _WriteName(const std::string& name);
+		uint32_t _FindName(const std::string& name, const uint32_t hash) const;
+		void _InternName(const std::string& name, const uint32_t hash);
+		void _ClearNames();
+		void _WriteContainerHeader(const Type type, const bool encoded);
+		void _BeginValue(const Type type, const uint32_t count);
+		void _EndContainer(const uint32_t length, const Type sub_type);
+		void _EncodeArray(State& state);
+		void _WriteOutput();
+		void _WritePipe(const void* data, const uint32_t bytes);
+		void _Splice(const BytePipeSerialiser& child);
+		void _WriteSegment();
+		void _EndChunkedArray();
+		void _PadArray(State& state, const Type type);
+		void _WriteValues(const void* data, const size_t bytes, const size_t size);
 		void WriteBytes(const void* data, const size_t bytes, const Type type, const uint32_t count);
+
+		inline uint32_t _GetOffset(const State& state) const {
+			// Referenced bytes are not in the buffer but are part of the container
+			return static_cast<uint32_t>((_buffer_size - state.header_offset) + (_reference_bytes - state.reference_bytes));
+		}
+
+		inline bool _IsBuffered() const {
+			return _document_open || !_states.empty();
+		}
+
+		inline bool _HasArrayType(const State& state) const {
+			// Segments that have been written fix the type of a chunked array
+			return state.array_data.length > 0u || (state.array_data.chunked && _segment_count > 0u);
+		}
+
+		inline bool _IsSegmentFull(const State& state) const {
+			return state.array_data.chunked && state.array_data.length > 0u && _buffer_size + _reference_bytes >= _segment_size;
+		}
+
+		inline void _BeginArrayValues(State& state, const Type type) {
+			// The first values of an array or segment are aligned, encoded values are not
+			if ((_mode & BytePipeFormat::MODE_ALIGNED) && state.array_data.length == 0u && !state.array_data.padded && state.array_data.codec == BytePipeFormat::CODEC_NONE) _PadArray(state, type);
+		}
+
+		inline uint8_t _GetSubTypeByte(const State& state) const {
+			return state.array_data.padded ? static_cast<uint8_t>(state.array_data.type | BytePipeFormat::SUB_TYPE_PADDED) : static_cast<uint8_t>(state.array_data.type);
+		}
+
+		inline uint8_t* _AllocateBytes(const size_t bytes) {
+			const size_t required = _buffer_size + bytes;
+			if (required > _buffer_capacity) _GrowBuffer(required);
+
+			uint8_t* const dst = _buffer + _buffer_size;
+			_buffer_size = required;
+			return dst;
+		}
+
+		inline void _AppendString(const void* data, const size_t bytes) {
+			const uint32_t length = static_cast<uint32_t>(bytes);
+			if ((_mode & BytePipeFormat::MODE_COMPACT) == 0u) {
+				uint8_t* const dst = _AllocateBytes(sizeof(uint32_t) + bytes);
+				ByteOrder::StoreLittleEndian32(dst, length);
+				memcpy(dst + sizeof(uint32_t), data, bytes);
+			} else if (length < 0x80) {
+				// The varint length is a single byte
+				uint8_t* const dst = _AllocateBytes(1u + bytes);
+				dst[0u] = static_cast<uint8_t>(length);
+				memcpy(dst + 1u, data, bytes);
+			} else {
+				_AppendLength(length);
+				memcpy(_AllocateBytes(bytes), data, bytes);
+			}
+		}
+
+		inline uint8_t _GetTypeByte(const Type type) const {
+			return (_mode & BytePipeFormat::MODE_COMPACT) ? static_cast<uint8_t>(type | BytePipeFormat::FLAG_COMPACT) : static_cast<uint8_t>(type);
+		}
+
+		// Struct writing, values are appended to the buffer with their final lengths so nothing needs to be patched
+
+		template<class T>
+		typename std::enable_if<Reflection::IsPrimitive<T>::value>::type _WriteStructMember(const T& value) {
+			ANVIL_SERIALISATION_STAT(++_stats.values[BytePipeFormat::TypeOf<T>::value]);
+			uint8_t* const dst = _AllocateBytes(1u + sizeof(T));
+			dst[0u] = _GetTypeByte(static_cast<Type>(BytePipeFormat::TypeOf<T>::value));
+			memcpy(dst + 1u, &value, sizeof(T));
+			ByteOrder::ToLittleEndian(dst + 1u, sizeof(T), 1u);
+		}
+
+		inline void _WriteStructMember(const std::string& value) {
+			ANVIL_SERIALISATION_STAT(++_stats.values[TYPE_STRING]);
+			*_AllocateBytes(1u) = _GetTypeByte(TYPE_STRING);
+			_AppendString(value.c_str(), value.size());
+		}
+
+		template<class T>
+		void _WriteStructMember(const std::vector<T>& value);
+
+		template<class T>
+		typename std::enable_if<Reflection::IsReflected<T>::value>::type _WriteStructMember(const T& value) {
+			ANVIL_SERIALISATION_STAT(++_stats.values[TYPE_OBJECT]);
+			_WriteStructObject(value);
+		}
+
+		template<class T>
+		void _WriteStructObject(const T& value);
+
+		template<class T>
+		static inline typename std::enable_if<Reflection::IsPrimitive<T>::value, Type>::type _GetStructSubType(const T*) {
+			return static_cast<Type>(BytePipeFormat::TypeOf<T>::value);
+		}
+
+		template<class T>
+		static inline typename std::enable_if<Reflection::IsReflected<T>::value, Type>::type _GetStructSubType(const T*) {
+			return TYPE_OBJECT;
+		}
+
+		static inline Type _GetStructSubType(const std::string*) {
+			return TYPE_STRING;
+		}
+
+		template<class T>
+		static inline Type _GetStructSubType(const std::vector<T>*) {
+			return TYPE_ARRAY;
+		}
+
+		// Column writing, each field of a struct is written as an array of that field from every row
+
+		template<class T, class M>
+		typename std::enable_if<Reflection::IsPrimitive<M>::value>::type _WriteColumn(const std::vector<T>& rows, M T::* member, const uint8_t codec) {
+			StartArray(codec);
+			if (!rows.empty()) {
+				// Gather the field values straight into the buffer
+				_BeginValue(static_cast<Type>(BytePipeFormat::TypeOf<M>::value), static_cast<uint32_t>(rows.size()));
+				uint8_t* const values = _AllocateBytes(sizeof(M) * rows.size());
+				uint8_t* dst = values;
+				for (const T& row : rows) {
+					memcpy(dst, &(row.*member), sizeof(M));
+					dst += sizeof(M);
+				}
+				ByteOrder::ToLittleEndian(values, sizeof(M), rows.size());
+			}
+			EndArray();
+		}
+
+		template<class T, class M>
+		typename std::enable_if<!Reflection::IsPrimitive<M>::value>::type _WriteColumn(const std::vector<T>& rows, M T::* member, const uint8_t) {
+			StartArray();
+			for (const T& row : rows) Reflection::Write(*this, row.*member);
+			EndArray();
+		}
+
+		template<class T>
+		inline void _WriteStructElements(const std::vector<T>& value, std::true_type) {
+			ANVIL_SERIALISATION_STAT(_stats.values[BytePipeFormat::TypeOf<T>::value] += value.size());
+			uint8_t* const dst = _AllocateBytes(sizeof(T) * value.size());
+			memcpy(dst, value.data(), sizeof(T) * value.size());
+			ByteOrder::ToLittleEndian(dst, sizeof(T), value.size());
+		}
+
+		inline void _WriteStructElements(const std::vector<std::string>& value, std::false_type) {
+			// Array values do not have a type prefix
+			ANVIL_SERIALISATION_STAT(_stats.values[TYPE_STRING] += value.size());
+			for (const std::string& element : value) _AppendString(element.c_str(), element.size());
+		}
+
+		template<class T>
+		inline void _WriteStructElements(const std::vector<T>& value, std::false_type) {
+			// Containers begin with their type in the header, so are written the same as members
+			for (const T& element : value) _WriteStructMember(element);
+		}
 	
+		BytePipeSerialiser(BytePipe::OutputPipe& pipe, const uint32_t mode, const Type container, Allocator& allocator);
 	public:
-		BytePipeSerialiser(BytePipe::OutputPipe&);
+		/*!
+			\brief Appends primitive values to the current array without going through the virtual interface.
+			\details The container and array type are checked once when the cursor is created, after that each value
+			is copied into the buffer after a single bounds check. Nothing else can be written to the serialiser until
+			the cursor is closed, which the destructor does if Close is not called.
+		*/
+		template<class T>
+		class ArrayCursor {
+		private:
+			static_assert(Reflection::IsPrimitive<T>::value, "BytePipeSerialiser::ArrayCursor : Type must be primitive");
+
+			BytePipeSerialiser* _serialiser;
+			uint8_t* _begin;	//!< First value that has not been added to the array length
+			uint8_t* _pos;		//!< Where the next value is written
+			uint8_t* _end;		//!< End of the space reserved in the buffer
+
+			void _Commit() {
+				const size_t bytes = static_cast<size_t>(_pos - _begin);
+				ByteOrder::ToLittleEndian(_begin, sizeof(T), bytes / sizeof(T));
+				_serialiser->_states.back().array_data.length += static_cast<uint32_t>(bytes / sizeof(T));
+				ANVIL_SERIALISATION_STAT(_serialiser->_stats.values[BytePipeFormat::TypeOf<T>::value] += bytes / sizeof(T));
+				_serialiser->_buffer_size += bytes;
+				_begin = _pos;
+			}
+
+			void _Reserve(const size_t bytes) {
+				_Commit();
+
+				// Chunked arrays write the values out instead of growing the buffer
+				State& state = _serialiser->_states.back();
+				if (_serialiser->_IsSegmentFull(state)) {
+					_serialiser->_WriteSegment();
+					_serialiser->_BeginArrayValues(state, static_cast<Type>(BytePipeFormat::TypeOf<T>::value));
+				}
+
+				const size_t required = _serialiser->_buffer_size + (bytes > CURSOR_RESERVE_SIZE ? bytes : CURSOR_RESERVE_SIZE);
+				if (required > _serialiser->_buffer_capacity) _serialiser->_GrowBuffer(required);
+
+				// The buffer may have moved
+				_begin = _serialiser->_buffer + _serialiser->_buffer_size;
+				_pos = _begin;
+				_end = _begin + ((_serialiser->_buffer_capacity - _serialiser->_buffer_size) / sizeof(T)) * sizeof(T);
+			}
+		public:
+			ArrayCursor(BytePipeSerialiser& serialiser) :
+				_serialiser(&serialiser),
+				_begin(nullptr),
+				_pos(nullptr),
+				_end(nullptr)
+			{
+				if (serialiser._cursor_open) throw std::runtime_error("BytePipeSerialiser::ArrayCursor : A cursor is already open");
+				if (serialiser._states.empty() || serialiser._states.back().type != TYPE_ARRAY) throw std::runtime_error("BytePipeSerialiser::ArrayCursor : Current value is not an array");
+
+				State& state = serialiser._states.back();
+				const Type type = static_cast<Type>(BytePipeFormat::TypeOf<T>::value);
+				if (!serialiser._HasArrayType(state)) {
+					state.array_data.type = type;
+				} else if (state.array_data.type != type) {
+					throw std::runtime_error("BytePipeSerialiser::ArrayCursor : Type of value does not match previous values in array");
+				}
+				serialiser._BeginArrayValues(state, type);
+
+				serialiser._cursor_open = true;
+				_begin = serialiser._buffer + serialiser._buffer_size;
+				_pos = _begin;
+				_end = _begin;
+			}
+
+			ArrayCursor(const ArrayCursor&) = delete;
+			ArrayCursor& operator=(const ArrayCursor&) = delete;
+
+			~ArrayCursor() {
+				if (_serialiser != nullptr) Close();
+			}
+
+			inline void Push(const T value) {
+				if (_pos == _end) _Reserve(sizeof(T));
+				memcpy(_pos, &value, sizeof(T));
+				_pos += sizeof(T);
+			}
+
+			void Push(const T* values, const size_t count) {
+				const size_t bytes = sizeof(T) * count;
+				if (static_cast<size_t>(_end - _pos) < bytes) _Reserve(bytes);
+				memcpy(_pos, values, bytes);
+				_pos += bytes;
+			}
+
+			/*!
+				\brief Add the values to the array so that other values can be written to the serialiser.
+			*/
+			void Close() {
+				_Commit();
+				_serialiser->_cursor_open = false;
+				_serialiser = nullptr;
+			}
+		};
+
+		BytePipeSerialiser(BytePipe::OutputPipe&, const uint32_t mode = BytePipeFormat::MODE_DEFAULT, Allocator& allocator = Allocator::GetDefault());
+		BytePipeSerialiser(const BytePipeSerialiser&) = delete;
+		BytePipeSerialiser& operator=(const BytePipeSerialiser&) = delete;
 		virtual ~BytePipeSerialiser();
+
+		/*!
+			\brief Start a document, values are kept in the buffer until EndDocument writes them to the pipe in one call.
+			\details Interned member names are forgotten so that each document can be read on its own.
+		*/
+		void BeginDocument();
+
+		/*!
+			\brief Write the current document to the pipe.
+			\details The pipe is not flushed.
+		*/
+		void EndDocument();
+
+		/*!
+			\brief Discard the current document and any open containers.
+			\details Buffer capacity is kept so the serialiser can be reused without allocating.
+		*/
+		void Reset();
+
+		/*!
+			\brief Write future values to a different pipe.
+			\details This cannot be called while a document or container is open.
+		*/
+		void SetPipe(BytePipe::OutputPipe& pipe);
+
+		/*!
+			\brief Flush the pipe, the serialiser does not flush the pipe on destruction.
+		*/
+		void Flush();
+
+#if ANVIL_SERIALISATION_STATS
+		/*!
+			\brief Counters collected since the serialiser was created or ResetStats was called.
+			\details Only available when built with ANVIL_SERIALISATION_STATS.
+		*/
+		const SerialiserStats& GetStats() const;
+
+		void ResetStats();
+
+		/*!
+			\brief Report the stats to a sink each time Flush is called and when the serialiser is destroyed.
+			\param sink The sink, which must outlive the serialiser, or null to stop reporting.
+		*/
+		void SetStatsSink(SerialiserStatsSink* sink);
+#endif
+
+		/*!
+			\brief Start an array of primitive values that are encoded when the array ends.
+			\details The values are written as they are if the codec cannot be applied to their type or would not make them smaller.
+			\param codec A combination of BytePipeFormat::Codec flags.
+		*/
+		void StartArray(const uint8_t codec);
+
+		/*!
+			\brief Start an array that writes its values to the pipe in segments while it is open.
+			\details Memory use stays close to one segment however many values are written, and readers see a single
+			array. It must be the outermost value, so it cannot be part of a document, and its elements are not indexed.
+			EndArray writes the last segment.
+			\param segment_size Number of buffered bytes after which a segment is written.
+		*/
+		void StartChunkedArray(const size_t segment_size = DEFAULT_SEGMENT_SIZE);
+
+		/*!
+			\brief Write large primitive arrays by reference instead of copying them.
+			\details Arrays of at least this many bytes that are not encoded are recorded as a pointer to the caller's
+			memory and written straight from it. The memory must not change or be freed until the value that contains
+			it has been written to the pipe, which is when the outermost container ends or when EndDocument is called.
+			Pipes derived from GatherOutputPipe receive the buffer and the arrays in a single WriteGather call.
+			\param bytes The size of the smallest array to reference, 0 copies every array.
+		*/
+		void SetReferenceThreshold(const size_t bytes);
+
+		/*!
+			\brief Set the position in the stream of the next byte written to the pipe.
+			\details MODE_ALIGNED aligns array values relative to position 0, which is the first byte the serialiser writes
+			unless this is called. Set it when the pipe appends to existing data, or to 0 before each record of a RecordFile
+			so that the values are aligned within the record. This cannot be called while a document or container is open.
+		*/
+		void SetStreamPosition(const uint64_t position);
+
+		/*!
+			\brief Return the BytePipeFormat::Mode flags the serialiser was created with.
+		*/
+		inline uint32_t GetMode() const {
+			return _mode;
+		}
+
+		/*!
+			\brief Write a value by copying its encoded bytes instead of decoding and writing it again.
+			\details The value must have been written with the same MODE_COMPACT and MODE_INDEXED flags as this serialiser
+			and cannot contain interned member names. Values of at least the reference threshold are referenced instead of
+			copied, so the view's buffer must then stay valid until the value is written to the pipe.
+			\return The size of the value in bytes.
+		*/
+		size_t SetNextValueRaw(const BytePipeView& value);
+
+		/*!
+			\brief Write values of the current array or members of the current object on several threads.
+			\details write(serialiser, index) is called once for each index in [0, count) and writes the values for that index.
+			Contiguous ranges of indices are written by separate serialisers into their own buffers, which are appended to the
+			current container in index order. The serialiser passed to write must only be used to write values.
+			Objects cannot be written in parallel with MODE_INTERN_NAMES, nested containers are written without interned names.
+			With MODE_ALIGNED only primitive values of the current array are aligned, nested containers are written without padding.
+			In a chunked array a segment is written between ranges once it is full, so segments can be larger than the segment size by up to one range.
+			\param threads The number of threads to use, 0 uses one per hardware thread.
+		*/
+		void WriteParallel(const size_t count, const std::function<void(BytePipeSerialiser&, const size_t)>& write, size_t threads = 0u);
+
+		/*!
+			\brief Write a struct that has an ANVIL_SCHEMA as an object.
+			\details The members are written directly into the buffer without going through the virtual interface.
+			MODE_INDEXED and MODE_INTERN_NAMES need the names at runtime, so structs are written through the virtual interface in those modes.
+		*/
+		template<class T>
+		void SetNextValueStruct(const T& value);
+
+		/*!
+			\brief Write structs that have an ANVIL_SCHEMA as columns.
+			\details The value is an object with one member per field, each member is an array holding that field
+			from every row. Member names are only written once and each primitive field is a contiguous array, so
+			single fields can be read with BytePipeView::GetMember and CopyArray without touching the others.
+			Read the rows back with BytePipeDeserialiser::ReadValueColumns.
+			\param codec BytePipeFormat::Codec flags for the primitive columns, columns of types the codec does not
+			support are written as they are.
+		*/
+		template<class T>
+		void SetNextValueColumns(const std::vector<T>& rows, const uint8_t codec = BytePipeFormat::CODEC_NONE);
 	
 		// Inherited from Serialiser
 	
@@ -99,6 +550,51 @@ namespace anvil {
 		void SetNextValueF64(const double* value, const size_t count) final;
 	
 	};
+
+	template<class T>
+	void BytePipeSerialiser::_WriteStructMember(const std::vector<T>& value) {
+		const Type sub_type = value.empty() ? TYPE_UNSIGNED_8 : _GetStructSubType(static_cast<const T*>(nullptr));
+		ANVIL_SERIALISATION_STAT(++_stats.values[TYPE_ARRAY]);
+		_AppendContainerHeader(TYPE_ARRAY, static_cast<uint32_t>(value.size()), sub_type);
+		_WriteStructElements(value, std::integral_constant<bool, Reflection::IsPrimitive<T>::value>());
+	}
+
+	template<class T>
+	void BytePipeSerialiser::_WriteStructObject(const T& value) {
+		_AppendContainerHeader(TYPE_OBJECT, Reflection::FieldCount<T>::value, TYPE_UNSIGNED_8);
+		Reflection::ForEachField<T>([this, &value](const auto& field) {
+			_AppendString(field.name, field.name_length);
+			_WriteStructMember(value.*(field.member));
+		});
+	}
+
+	template<class T>
+	void BytePipeSerialiser::SetNextValueColumns(const std::vector<T>& rows, const uint8_t codec) {
+		static_assert(Reflection::IsReflected<T>::value, "BytePipeSerialiser::SetNextValueColumns : Type does not have a schema");
+
+		StartObject();
+		Reflection::ForEachField<T>([this, &rows, codec](const auto& field) {
+			SetNextMemberName(field.name);
+			_WriteColumn(rows, field.member, codec);
+		});
+		EndObject();
+	}
+
+	template<class T>
+	void BytePipeSerialiser::SetNextValueStruct(const T& value) {
+		static_assert(Reflection::IsReflected<T>::value, "BytePipeSerialiser::SetNextValueStruct : Type does not have a schema");
+
+		if (_mode & (BytePipeFormat::MODE_INDEXED | BytePipeFormat::MODE_INTERN_NAMES)) {
+			Reflection::Write(*this, value);
+			return;
+		}
+
+		_BeginValue(TYPE_OBJECT, 1u);
+		_WriteStructObject(value);
+
+		// Write the struct if it is not inside a container or document
+		if (!_IsBuffered()) _WriteOutput();
+	}
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,117 @@
+// MIT License
+// 
+// Copyright(c) 2021 Adam Smith
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef ANVIL_SERIALISATION_BYTE_PIPE_TRANSCODER_HPP
+#define ANVIL_SERIALISATION_BYTE_PIPE_TRANSCODER_HPP
+
+#include <string>
+#include <vector>
+#include "anvil/serialisation/BytePipeSerialiser.hpp"
+#include "anvil/serialisation/BytePipeView.hpp"
+
+namespace anvil {
+
+	/*!
+		\brief Rewrites values written by BytePipeSerialiser into another BytePipeSerialiser without decoding what does not change.
+		\details Values that are kept as they are and use the same layout as the output are copied as raw byte ranges with
+		BytePipeSerialiser::SetNextValueRaw. Only the objects that a Filter descends into are rewritten member by member.
+		If the layouts differ, values are rewritten with primitive arrays passed as a single block. Input that was written
+		with MODE_INTERN_NAMES is not supported because its member names cannot be resolved out of order.
+	*/
+	class BytePipeTranscoder {
+	public:
+		enum Action {
+			MEMBER_KEEP,		//!< Write the member as it is, copying its bytes if possible
+			MEMBER_DROP,		//!< Leave the member out
+			MEMBER_TRANSCODE	//!< Write the member, passing the members of any objects inside it to the filter
+		};
+
+		/*!
+			\brief Decides what happens to each member of the objects being rewritten.
+		*/
+		class Filter {
+		public:
+			virtual ~Filter() {}
+
+			/*!
+				\param path Names of the members that contain the current object, starting from the outermost value.
+				Array elements do not add to the path.
+				\param name The name of the member, which can be changed to rename it.
+			*/
+			virtual Action FilterMember(const std::vector<std::string>& path, std::string& name) = 0;
+		};
+	private:
+		BytePipeSerialiser& _dst;
+		Filter* _filter;
+		std::vector<std::string> _path;
+		std::vector<std::vector<BytePipeView::Member>> _members;	//!< Members of the objects being rewritten, one list per depth so they are reused
+		std::vector<std::vector<BytePipeView>> _elements;			//!< Elements of the arrays being rewritten, one list per depth
+		std::vector<uint8_t> _array_buffer;	//!< Decoded values of a primitive array that cannot be copied
+		std::string _name;
+		std::string _string_buffer;
+		uint64_t _copied_bytes;
+		uint8_t _layout;		//!< BytePipeFormat layout flags of the output
+		uint8_t _codec;			//!< Codec for primitive arrays, if _recode is set
+		bool _recode;			//!< True if primitive arrays are written with _codec instead of their own
+
+		bool _CanCopy(const BytePipeView& value) const;
+		void _Write(const BytePipeView& value, const bool filter, const size_t depth);
+		void _WriteObject(const BytePipeView& value, const bool filter, const size_t depth);
+		void _WriteArray(const BytePipeView& value, const bool filter, const size_t depth);
+		void _WritePrimitiveArray(const BytePipeView& value);
+		void _WriteScalar(const BytePipeView& value);
+	public:
+		/*!
+			\param dst Where the values are written.
+			\param filter Called for the members of each object that is rewritten, if null every value is copied as it is.
+		*/
+		BytePipeTranscoder(BytePipeSerialiser& dst, Filter* filter = nullptr);
+		BytePipeTranscoder(const BytePipeTranscoder&) = delete;
+		BytePipeTranscoder& operator=(const BytePipeTranscoder&) = delete;
+
+		/*!
+			\brief Write primitive arrays with a different codec, which means that they are decoded and encoded again.
+			\param codec BytePipeFormat::Codec flags, CODEC_NONE writes the values without encoding.
+		*/
+		void SetArrayCodec(const uint8_t codec);
+
+		/*!
+			\brief Write one value, the outermost object is always passed to the filter.
+		*/
+		void Transcode(const BytePipeView& value);
+
+		/*!
+			\brief Write every value in a buffer of values written back to back.
+			\return The number of values written.
+		*/
+		size_t Transcode(const void* data, const size_t bytes);
+
+		/*!
+			\brief Return the number of bytes that were copied without being decoded.
+		*/
+		inline uint64_t GetCopiedBytes() const {
+			return _copied_bytes;
+		}
+	};
+}
+
+#endif
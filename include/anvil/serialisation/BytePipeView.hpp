@@ -0,0 +1,198 @@
+// MIT License
+// 
+// Copyright(c) 2021 Adam Smith
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef ANVIL_SERIALISATION_BYTE_PIPE_VIEW_HPP
+#define ANVIL_SERIALISATION_BYTE_PIPE_VIEW_HPP
+
+#include <string>
+#include <vector>
+#include "anvil/serialisation/BytePipeFormat.hpp"
+
+namespace anvil {
+
+	/*!
+		\brief Read-only view of a value written by BytePipeSerialiser.
+		\details The view points into a buffer or memory mapped file that must outlive it. Nothing is decoded
+		until it is asked for, members and elements are returned as views of the same buffer.
+		Interned member names (MODE_INTERN_NAMES) can only be resolved by reading the stream in order, so members of
+		those objects can only be looked up when their name is written in full.
+	*/
+	class BytePipeView {
+	public:
+		typedef Serialiser::Type Type;
+		struct Member;
+	private:
+		const uint8_t* _data;	//!< Start of the value, for containers this is the header
+		const uint8_t* _end;	//!< End of the buffer
+		Type _type;
+		uint8_t _flags;			//!< Flag bits of the type byte, or of the parent array for values without one
+
+		BytePipeView(const uint8_t* data, const uint8_t* end, const Type type, const uint8_t flags);
+
+		static BytePipeView ReadTaggedValue(const uint8_t* data, const uint8_t* end);
+		static const uint8_t* SkipElements(const uint8_t* data, const uint8_t* end, const Type sub_type, const uint8_t flags, const uint32_t count);
+		static const uint8_t* SkipValue(const uint8_t* data, const uint8_t* end, const Type type, const uint8_t flags);
+		static const uint8_t* ReadString(const uint8_t* data, const uint8_t* end, const bool compact, const char*& str, uint32_t& length);
+		static const uint8_t* ReadMemberName(const uint8_t* data, const uint8_t* end, const uint8_t flags, const char*& name, uint32_t& length);
+
+		const uint8_t* GetContainer(BytePipeFormat::ContainerInfo& info, const Type type) const;
+		const uint8_t* GetPrimitive(void* dst, const Type type) const;
+		const void* GetArrayData(const Type sub_type, uint32_t& length) const;
+		void CopyArrayData(const Type sub_type, void* dst) const;
+	public:
+		BytePipeView();
+
+		/*!
+			\brief Create a view of the first value in a buffer.
+			\param data The start of the buffer.
+			\param bytes The size of the buffer in bytes.
+		*/
+		BytePipeView(const void* data, const size_t bytes);
+
+		inline bool IsValid() const {
+			return _data != nullptr;
+		}
+
+		inline Type GetType() const {
+			return _type;
+		}
+
+		/*!
+			\brief Return the BytePipeFormat flag bits of the value's type byte.
+			\details Array elements that are not containers do not have a type byte and only have the FLAG_COMPACT bit of their array.
+		*/
+		inline uint8_t GetFlags() const {
+			return _flags;
+		}
+
+		/*!
+			\brief Return the address of the first byte of this value.
+		*/
+		inline const void* GetBegin() const {
+			return _data;
+		}
+
+		/*!
+			\brief Return the address of the byte after this value.
+			\details This can be used to find the next value when several are written back to back.
+		*/
+		const void* GetEnd() const;
+
+		uint8_t GetValueU8() const;
+		uint16_t GetValueU16() const;
+		uint32_t GetValueU32() const;
+		uint64_t GetValueU64() const;
+		int8_t GetValueS8() const;
+		int16_t GetValueS16() const;
+		int32_t GetValueS32() const;
+		int64_t GetValueS64() const;
+		float GetValueF32() const;
+		double GetValueF64() const;
+
+		/*!
+			\brief Return a pointer to the characters of a string, which are not null terminated.
+		*/
+		const char* GetValueString(uint32_t& length) const;
+		std::string GetValueString() const;
+
+		/*!
+			\brief Return the number of values in an array or members in an object.
+			\details Chunked arrays do not record their length, so their segments are walked to count the values.
+		*/
+		uint32_t GetCount() const;
+
+		/*!
+			\brief Return the type of the values in an array.
+		*/
+		Type GetArraySubType() const;
+
+		/*!
+			\brief Return the BytePipeFormat::Codec flags that the values of an array are encoded with.
+		*/
+		uint8_t GetArrayCodec() const;
+
+		/*!
+			\brief Return a view of an array value.
+		*/
+		BytePipeView GetElement(const uint32_t index) const;
+
+		/*!
+			\brief Return views of all array values.
+			\details Elements are found with the index if the array has one, otherwise the array is walked once.
+		*/
+		void GetElements(std::vector<BytePipeView>& elements) const;
+
+		/*!
+			\brief Return a view of an object member, or an invalid view if there is no member with that name.
+		*/
+		BytePipeView GetMember(const char* name) const;
+
+		/*!
+			\brief Return a view of an object member by position.
+			\param name Set to the start of the member name, which is not null terminated.
+			\param name_length Set to the length of the member name.
+		*/
+		BytePipeView GetMember(const uint32_t index, const char*& name, uint32_t& name_length) const;
+
+		/*!
+			\brief Return all members of an object in the order they were written.
+			\details The object is walked once, unlike calling GetMember with each index.
+		*/
+		void GetMembers(std::vector<Member>& members) const;
+
+		/*!
+			\brief Return true if this value is, or contains, an object with interned member names.
+			\details Those names refer to IDs assigned earlier in the stream, so the bytes of the value cannot be copied into another stream.
+		*/
+		bool HasInternedNames() const;
+
+		/*!
+			\brief Return the values of a primitive array without copying them.
+			\details The pointer is into the underlying buffer, it is aligned for T if the array was written with MODE_ALIGNED
+			and the buffer starts at the stream position the serialiser aligned to, on an address aligned to at least 8 bytes.
+			Encoded arrays and chunked arrays with more than one segment cannot be read in place and throw, use CopyArray instead.
+			The values are little-endian, so big-endian hosts must use CopyArray for values wider than a byte.
+			\param length Set to the number of values in the array.
+		*/
+		template<class T>
+		inline const T* GetArray(uint32_t& length) const {
+			return static_cast<const T*>(GetArrayData(static_cast<Type>(BytePipeFormat::TypeOf<T>::value), length));
+		}
+
+		/*!
+			\brief Copy the values of a primitive array, decoding them if the array is encoded.
+			\param dst Where to write the values, there must be space for GetCount() values.
+		*/
+		template<class T>
+		inline void CopyArray(T* dst) const {
+			CopyArrayData(static_cast<Type>(BytePipeFormat::TypeOf<T>::value), dst);
+		}
+	};
+
+	struct BytePipeView::Member {
+		const char* name;		//!< Start of the member name, which is not null terminated
+		uint32_t name_length;
+		BytePipeView value;
+	};
+}
+
+#endif
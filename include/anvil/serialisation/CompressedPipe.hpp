@@ -0,0 +1,113 @@
+// MIT License
+// 
+// Copyright(c) 2021 Adam Smith
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef ANVIL_SERIALISATION_COMPRESSED_PIPE_HPP
+#define ANVIL_SERIALISATION_COMPRESSED_PIPE_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "anvil/serialisation/BlockCompression.hpp"
+#include "anvil/byte-pipe/BytePipeReader.hpp"
+#include "anvil/byte-pipe/BytePipeWriter.hpp"
+
+namespace anvil {
+
+	/*!
+		\brief Splits a byte stream into blocks and writes each as an independently compressed frame.
+		\details Blocks can be compressed by a pool of worker threads while more data is written, frames are
+		still written to the downstream pipe in order. Flush writes the partially filled block, so flushing often
+		makes the blocks smaller.
+	*/
+	class CompressedOutputPipe final : public BytePipe::OutputPipe {
+	private:
+		struct Block {
+			std::vector<uint8_t> raw;
+			std::vector<uint8_t> frame;
+			std::exception_ptr error;
+			bool done;
+		};
+
+		BytePipe::OutputPipe& _downstream;
+		std::unique_ptr<Block> _current;					//!< Block that is being filled
+		std::deque<std::unique_ptr<Block>> _pending;		//!< Blocks that have been submitted, in stream order
+		std::vector<std::unique_ptr<Block>> _free_blocks;	//!< Blocks that have been written and can be reused
+		std::deque<Block*> _queue;							//!< Blocks waiting for a worker
+		std::vector<std::thread> _workers;
+		std::mutex _mutex;
+		std::condition_variable _work_ready;
+		std::condition_variable _work_done;
+		uint32_t _block_size;
+		BlockCompression::Codec _codec;
+		bool _exit;
+
+		void _WorkerMain();
+		void _SubmitBlock();
+		void _WriteCompleted(const size_t max_pending);
+		void _WriteFrame(Block& block);
+	public:
+		/*!
+			\param downstream Where to write the compressed frames.
+			\param block_size Number of uncompressed bytes in each block.
+			\param threads Number of worker threads, 0 compresses each block on the calling thread.
+			\param codec How to compress the blocks.
+		*/
+		CompressedOutputPipe(BytePipe::OutputPipe& downstream, const uint32_t block_size = 256u * 1024u, const uint32_t threads = 0u, const BlockCompression::Codec codec = BlockCompression::COMPRESSION_LZ);
+		CompressedOutputPipe(const CompressedOutputPipe&) = delete;
+		CompressedOutputPipe& operator=(const CompressedOutputPipe&) = delete;
+		virtual ~CompressedOutputPipe();
+
+		// Inherited from OutputPipe
+
+		uint32_t WriteBytes(const void* src, const uint32_t bytes) final;
+		void Flush() final;
+	};
+
+	/*!
+		\brief Reads a stream written by CompressedOutputPipe, blocks are decompressed and checked as they are reached.
+	*/
+	class CompressedInputPipe final : public BytePipe::InputPipe {
+	private:
+		BytePipe::InputPipe& _upstream;
+		std::vector<uint8_t> _payload;
+		std::vector<uint8_t> _block;
+		size_t _block_begin;	//!< Position of the next unread byte in the block
+
+		bool _ReadUpstream(void* dst, const size_t bytes, const bool allow_end);
+		bool _ReadBlock();
+	public:
+		CompressedInputPipe(BytePipe::InputPipe& upstream);
+		CompressedInputPipe(const CompressedInputPipe&) = delete;
+		CompressedInputPipe& operator=(const CompressedInputPipe&) = delete;
+		virtual ~CompressedInputPipe();
+
+		// Inherited from InputPipe
+
+		uint32_t ReadBytes(void* dst, const uint32_t bytes) final;
+	};
+}
+
+#endif
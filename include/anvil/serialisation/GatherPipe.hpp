@@ -0,0 +1,75 @@
+// MIT License
+// 
+// Copyright(c) 2021 Adam Smith
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef ANVIL_SERIALISATION_GATHER_PIPE_HPP
+#define ANVIL_SERIALISATION_GATHER_PIPE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include "anvil/byte-pipe/BytePipeWriter.hpp"
+
+namespace anvil {
+
+	/*!
+		\brief An output pipe that can write several separate blocks of memory in one call.
+		\details BytePipeSerialiser uses this to write referenced arrays without copying them into its buffer.
+	*/
+	class GatherOutputPipe : public BytePipe::OutputPipe {
+	public:
+		struct Fragment {
+			const void* data;
+			size_t bytes;
+		};
+
+		virtual ~GatherOutputPipe() {}
+
+		/*!
+			\brief Write the fragments in order, as if each was passed to WriteBytes.
+		*/
+		virtual void WriteGather(const Fragment* fragments, const size_t count) = 0;
+	};
+
+	/*!
+		\brief Writes to a file, fragments are written with a single vectored write where the platform has one.
+	*/
+	class FileOutputPipe final : public GatherOutputPipe {
+	private:
+		FILE* _file;
+	public:
+		FileOutputPipe(const char* path);
+		FileOutputPipe(const FileOutputPipe&) = delete;
+		FileOutputPipe& operator=(const FileOutputPipe&) = delete;
+		virtual ~FileOutputPipe();
+
+		// Inherited from GatherOutputPipe
+
+		void WriteGather(const Fragment* fragments, const size_t count) final;
+
+		// Inherited from OutputPipe
+
+		uint32_t WriteBytes(const void* src, const uint32_t bytes) final;
+		void Flush() final;
+	};
+}
+
+#endif
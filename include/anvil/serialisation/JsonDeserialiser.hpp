@@ -0,0 +1,210 @@
+// MIT License
+// 
+// Copyright(c) 2021 Adam Smith
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef ANVIL_SERIALISATION_JSON_DESERIALISER_HPP
+#define ANVIL_SERIALISATION_JSON_DESERIALISER_HPP
+
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "anvil/serialisation/Reflection.hpp"
+#include "anvil/serialisation/Serialiser.hpp"
+#include "anvil/byte-pipe/BytePipeReader.hpp"
+
+namespace anvil {
+
+	/*!
+		\brief Reads JSON text, such as the output of JsonSerialiser, and passes the values to any serialiser.
+		\details The input can hold several values one after the other. Without a schema, integers that fit are read as
+		signed 64-bit values, larger integers as unsigned 64-bit values and other numbers as doubles. Arrays that only
+		contain numbers are passed in one call so they can be written to BytePipeSerialiser, as unsigned 64-bit values if
+		any is too large for a signed one and none are negative, and as doubles if any of them is not an integer or the
+		integers do not fit one type. true and false are read as 1 and 0 unsigned 8-bit values and null as a NaN double.
+		ReadValueStruct reads values into the types of a struct's fields instead.
+	*/
+	class JsonDeserialiser {
+	private:
+		enum : size_t {
+			MAX_DEPTH = 512u,				//!< Deepest nesting that is read, deeper input is assumed to be malformed
+			READ_BLOCK_SIZE = 64u * 1024u	//!< Number of bytes requested from the pipe at a time
+		};
+
+		enum NumberType {
+			NUMBER_SIGNED,
+			NUMBER_UNSIGNED,
+			NUMBER_FLOAT
+		};
+
+		struct Number {
+			NumberType type;
+			union {
+				int64_t s;
+				uint64_t u;
+				double f;
+			};
+		};
+
+		std::vector<char> _input;	//!< Copy of the input when it is read from a pipe
+		const char* _pos;
+		const char* _end;
+		size_t _depth;
+		std::string _name_buffer;
+		std::string _string_buffer;
+		std::vector<uint64_t> _integers;	//!< Values of the current number array while they are all integers of one type, signed values are stored as their two's complement
+		std::vector<double> _floats;	//!< Values of the current number array once one is not an integer
+
+		void _SkipWhitespace();
+		char _Peek();
+		void _Expect(const char c);
+		bool _Consume(const char c);
+		void _ReadLiteral(const char* literal, const size_t length);
+		void _ReadString(std::string& dst);
+		void _SkipString();
+		void _ReadNumber(Number& number);
+		void _ReadPrimitive(Number& number);
+		void _ReadArray(Deserialiser& dst);
+		bool _ReadNumberArray(Deserialiser& dst);
+		void _ReadObject(Deserialiser& dst);
+
+		// Struct reading
+
+		template<class T>
+		static inline void _ConvertNumber(const Number& number, T& value, std::true_type) {
+			value = static_cast<T>(number.type == NUMBER_FLOAT ? number.f : number.type == NUMBER_SIGNED ? static_cast<double>(number.s) : static_cast<double>(number.u));
+		}
+
+		template<class T>
+		static void _ConvertNumber(const Number& number, T& value, std::false_type) {
+			if (number.type == NUMBER_FLOAT) throw std::runtime_error("JsonDeserialiser::ReadValueStruct : Expected an integer");
+
+			const uint64_t max = static_cast<uint64_t>(std::numeric_limits<T>::max());
+			bool fits;
+			if (number.type == NUMBER_UNSIGNED) {
+				fits = number.u <= max;
+			} else if (number.s >= 0) {
+				fits = static_cast<uint64_t>(number.s) <= max;
+			} else {
+				fits = number.s >= static_cast<int64_t>(std::numeric_limits<T>::min());
+			}
+			if (!fits) throw std::runtime_error("JsonDeserialiser::ReadValueStruct : Value is out of range for the field");
+
+			value = number.type == NUMBER_UNSIGNED ? static_cast<T>(number.u) : static_cast<T>(number.s);
+		}
+
+		template<class T>
+		typename std::enable_if<Reflection::IsPrimitive<T>::value>::type _ReadStructMember(T& value) {
+			Number number;
+			_ReadPrimitive(number);
+			_ConvertNumber(number, value, std::integral_constant<bool, std::is_floating_point<T>::value>());
+		}
+
+		inline void _ReadStructMember(std::string& value) {
+			_ReadString(value);
+		}
+
+		template<class T>
+		void _ReadStructMember(std::vector<T>& value) {
+			_Expect('[');
+			value.clear();
+			if (_Consume(']')) return;
+
+			do {
+				value.emplace_back();
+				_ReadStructMember(value.back());
+			} while (_Consume(','));
+			_Expect(']');
+		}
+
+		template<class T>
+		inline typename std::enable_if<Reflection::IsReflected<T>::value>::type _ReadStructMember(T& value) {
+			ReadValueStruct(value);
+		}
+	public:
+		/*!
+			\brief Read from memory, which must not change or be freed while the deserialiser is in use.
+		*/
+		JsonDeserialiser(const char* data, const size_t bytes);
+
+		/*!
+			\brief Read everything from a pipe into memory.
+		*/
+		JsonDeserialiser(BytePipe::InputPipe& pipe);
+
+		JsonDeserialiser(const JsonDeserialiser&) = delete;
+		JsonDeserialiser& operator=(const JsonDeserialiser&) = delete;
+		~JsonDeserialiser();
+
+		/*!
+			\brief Return true if there is another value before the end of the input.
+		*/
+		bool HasNextValue();
+
+		/*!
+			\brief Read the next value and pass it to another serialiser.
+		*/
+		void ReadValue(Deserialiser& dst);
+
+		/*!
+			\brief Skip the next value.
+		*/
+		void SkipValue();
+
+		/*!
+			\brief Read an object into a struct that has an ANVIL_SCHEMA.
+			\details Members are matched to fields by name, so they can be in any order. Members without a field are
+			skipped and fields without a member keep their value. Numbers must fit in the type of their field.
+		*/
+		template<class T>
+		void ReadValueStruct(T& value);
+	};
+
+	template<class T>
+	void JsonDeserialiser::ReadValueStruct(T& value) {
+		static_assert(Reflection::IsReflected<T>::value, "JsonDeserialiser::ReadValueStruct : Type does not have a schema");
+
+		if (++_depth > MAX_DEPTH) throw std::runtime_error("JsonDeserialiser::ReadValueStruct : Values are nested too deeply");
+		_Expect('{');
+		if (!_Consume('}')) {
+			do {
+				_ReadString(_name_buffer);
+				_Expect(':');
+
+				const std::string& name = _name_buffer;
+				bool found = false;
+				Reflection::ForEachField<T>([this, &value, &name, &found](const auto& field) {
+					if (!found && field.name_length == name.size() && memcmp(field.name, name.data(), name.size()) == 0) {
+						// Set before reading because nested members reuse the name buffer
+						found = true;
+						_ReadStructMember(value.*(field.member));
+					}
+				});
+				if (!found) SkipValue();
+			} while (_Consume(','));
+			_Expect('}');
+		}
+		--_depth;
+	}
+}
+
+#endif
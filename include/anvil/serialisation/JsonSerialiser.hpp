@@ -0,0 +1,127 @@
+// MIT License
+// 
+// Copyright(c) 2021 Adam Smith
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef ANVIL_SERIALISATION_JSON_SERIALISER_HPP
+#define ANVIL_SERIALISATION_JSON_SERIALISER_HPP
+
+#include <string>
+#include <vector>
+#include "anvil/serialisation/Allocator.hpp"
+#include "anvil/serialisation/Serialiser.hpp"
+#include "anvil/byte-pipe/BytePipeWriter.hpp"
+
+namespace anvil {
+
+	/*!
+		\brief Writes values as JSON text, so the same producer code can write either JSON or the BytePipeSerialiser format.
+		\details Each value that is not inside a container is written on its own line. The text is buffered and written
+		to the pipe when the outermost value ends or when the buffer passes FLUSH_SIZE, nothing needs to be patched so
+		large containers do not have to be held in memory. Floats are written with the fewest digits that read back to the
+		same value, non-finite floats are written as null.
+	*/
+	class JsonSerialiser final : public Serialiser {
+	private:
+		enum : size_t {
+			FLUSH_SIZE = 64u * 1024u,	//!< Buffer size at which the text of an open container is written to the pipe
+			MAX_NUMBER_SIZE = 32u,		//!< Largest number of characters in a formatted number
+			VALUE_BLOCK_SIZE = 1024u,	//!< Number of array values formatted between buffer checks
+			STRING_BLOCK_SIZE = 4096u	//!< Number of string characters escaped between buffer checks
+		};
+
+		struct State {
+			Type type;
+			bool empty;		//!< True until the first value or member is written
+		};
+
+		BytePipe::OutputPipe* _pipe;
+		Allocator& _allocator;
+		std::vector<State, StlAllocator<State>> _states;
+		std::string _name_buffer;	//!< Name of the next member of the innermost object
+		bool _name_set;				//!< True if SetNextMemberName has been called since the last member was written
+		char* _buffer;
+		size_t _buffer_size;
+		size_t _buffer_capacity;
+
+		void _GrowBuffer(const size_t required);
+		void _BeginValue(const size_t count);
+		void _EndValue();
+		void _WriteString(const char* value, const size_t length);
+		void _WriteOutput();
+
+		template<class T>
+		void _WriteValue(const T value);
+
+		template<class T>
+		void _WriteValues(const T* values, const size_t count);
+
+		inline char* _AllocateBytes(const size_t bytes) {
+			const size_t required = _buffer_size + bytes;
+			if (required > _buffer_capacity) _GrowBuffer(required);
+
+			char* const dst = _buffer + _buffer_size;
+			_buffer_size = required;
+			return dst;
+		}
+	public:
+		JsonSerialiser(BytePipe::OutputPipe& pipe, Allocator& allocator = Allocator::GetDefault());
+		JsonSerialiser(const JsonSerialiser&) = delete;
+		JsonSerialiser& operator=(const JsonSerialiser&) = delete;
+		virtual ~JsonSerialiser();
+
+		/*!
+			\brief Flush the pipe, the serialiser does not flush the pipe on destruction.
+		*/
+		void Flush();
+
+		// Inherited from Serialiser
+
+		void SetNextValueU8(const uint8_t value) final;
+		void SetNextValueU16(const uint16_t value) final;
+		void SetNextValueU32(const uint32_t value) final;
+		void SetNextValueU64(const uint64_t value) final;
+		void SetNextValueS8(const int8_t value) final;
+		void SetNextValueS16(const int16_t value) final;
+		void SetNextValueS32(const int32_t value) final;
+		void SetNextValueS64(const int64_t value) final;
+		void SetNextValueF32(const float value) final;
+		void SetNextValueF64(const double value) final;
+		void SetNextValueString(const char* value) final;
+		void StartArray() final;
+		void EndArray() final;
+		void StartObject() final;
+		void EndObject() final;
+		void SetNextMemberName(const char* name) final;
+
+		void SetNextValueU8(const uint8_t* value, const size_t count) final;
+		void SetNextValueU16(const uint16_t* value, const size_t count) final;
+		void SetNextValueU32(const uint32_t* value, const size_t count) final;
+		void SetNextValueU64(const uint64_t* value, const size_t count) final;
+		void SetNextValueS8(const int8_t* value, const size_t count) final;
+		void SetNextValueS16(const int16_t* value, const size_t count) final;
+		void SetNextValueS32(const int32_t* value, const size_t count) final;
+		void SetNextValueS64(const int64_t* value, const size_t count) final;
+		void SetNextValueF32(const float* value, const size_t count) final;
+		void SetNextValueF64(const double* value, const size_t count) final;
+	};
+}
+
+#endif
@@ -0,0 +1,59 @@
+// MIT License
+// 
+// Copyright(c) 2021 Adam Smith
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef ANVIL_SERIALISATION_MEMORY_MAPPED_FILE_HPP
+#define ANVIL_SERIALISATION_MEMORY_MAPPED_FILE_HPP
+
+#include <cstddef>
+
+namespace anvil {
+
+	/*!
+		\brief Read-only memory mapping of a whole file.
+	*/
+	class MemoryMappedFile {
+	private:
+		const void* _data;
+		size_t _size;
+#ifdef _WIN32
+		void* _file;
+		void* _mapping;
+#else
+		int _file;
+#endif
+	public:
+		MemoryMappedFile(const char* path);
+		MemoryMappedFile(const MemoryMappedFile&) = delete;
+		MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+		~MemoryMappedFile();
+
+		inline const void* GetData() const {
+			return _data;
+		}
+
+		inline size_t GetSize() const {
+			return _size;
+		}
+	};
+}
+
+#endif
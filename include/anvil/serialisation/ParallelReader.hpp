@@ -0,0 +1,69 @@
+// MIT License
+// 
+// Copyright(c) 2021 Adam Smith
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef ANVIL_SERIALISATION_PARALLEL_READER_HPP
+#define ANVIL_SERIALISATION_PARALLEL_READER_HPP
+
+#include <functional>
+#include <vector>
+#include "anvil/serialisation/BytePipeDeserialiser.hpp"
+#include "anvil/serialisation/BytePipeView.hpp"
+
+namespace anvil {
+
+	/*!
+		\brief Reads the elements of a large array in memory on several threads.
+		\details The elements are found first, using the array index if it was written with MODE_INDEXED, then
+		contiguous ranges of elements are read by separate threads. Member names interned by an earlier element
+		cannot be resolved by a later one, so arrays written with MODE_INTERN_NAMES cannot be read in parallel.
+	*/
+	namespace ParallelReader {
+
+		/*!
+			\brief Call read(element, index) once for each array value.
+			\param threads The number of threads to use, 0 uses one per hardware thread.
+		*/
+		void ForEachElement(const BytePipeView& array, const std::function<void(const BytePipeView&, const uint32_t)>& read, size_t threads = 0u);
+
+		/*!
+			\brief Call read(reader, index) once for each array value, the reader is positioned at the value.
+			\details The values must be arrays or objects, which carry their own type. Values with interned member names throw.
+			\param threads The number of threads to use, 0 uses one per hardware thread.
+		*/
+		void ReadElements(const BytePipeView& array, const std::function<void(BytePipeDeserialiser&, const uint32_t)>& read, size_t threads = 0u);
+
+		/*!
+			\brief Read an array of structs that have an ANVIL_SCHEMA.
+			\param threads The number of threads to use, 0 uses one per hardware thread.
+		*/
+		template<class T>
+		void ReadArray(const BytePipeView& array, std::vector<T>& values, size_t threads = 0u) {
+			values.resize(array.GetCount());
+			T* const dst = values.data();
+			ReadElements(array, [dst](BytePipeDeserialiser& reader, const uint32_t index) {
+				reader.ReadValueStruct(dst[index]);
+			}, threads);
+		}
+	}
+}
+
+#endif
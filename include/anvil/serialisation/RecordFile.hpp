@@ -0,0 +1,234 @@
+// MIT License
+// 
+// Copyright(c) 2021 Adam Smith
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef ANVIL_SERIALISATION_RECORD_FILE_HPP
+#define ANVIL_SERIALISATION_RECORD_FILE_HPP
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "anvil/byte-pipe/BytePipeWriter.hpp"
+#include "anvil/serialisation/BytePipeView.hpp"
+#include "anvil/serialisation/MemoryMappedFile.hpp"
+
+namespace anvil { namespace RecordFileFormat {
+
+	/*
+		Layout of a record file :
+
+		FileHeader, then one frame per record in the order they were reserved, then the footer.
+		Frame : FrameHeader followed by the record bytes, padded with zeros to a multiple of FRAME_ALIGNMENT.
+		Footer : An IndexEntry for every index_interval'th record, followed by the Trailer at the end of the file.
+
+		All fields are little-endian. Frames start on FRAME_ALIGNMENT boundaries so the record bytes are aligned in a
+		memory mapping, records written with MODE_ALIGNED after BytePipeSerialiser::SetStreamPosition(0) keep their
+		array values aligned.
+		The footer is written when the writer is closed, a file without one is read by walking the frames up to
+		the first one that was not completely written.
+	*/
+
+	enum : uint32_t {
+		FILE_MAGIC = 0x52564E41u,		//!< "ANVR"
+		FRAME_MAGIC = 0x46564E41u,		//!< "ANVF"
+		TRAILER_MAGIC = 0x49564E41u,	//!< "ANVI"
+		VERSION = 1u,
+		FRAME_ALIGNMENT = 16u,
+		DEFAULT_INDEX_INTERVAL = 64u
+	};
+
+	struct FileHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint32_t index_interval;	//!< Number of records between index entries
+		uint32_t reserved;
+	};
+
+	struct FrameHeader {
+		uint32_t magic;
+		uint32_t bytes;				//!< Size of the record without padding
+		int64_t timestamp;
+	};
+
+	struct IndexEntry {
+		uint64_t record;
+		uint64_t offset;			//!< Offset of the frame from the start of the file
+		int64_t timestamp;
+	};
+
+	struct Trailer {
+		uint64_t index_offset;		//!< Offset of the first IndexEntry, which is also the end of the frames
+		uint64_t record_count;
+		uint32_t entry_count;
+		uint32_t magic;
+	};
+
+	static inline uint64_t GetFrameSize(const uint64_t bytes) {
+		return (sizeof(FrameHeader) + bytes + (FRAME_ALIGNMENT - 1u)) & ~static_cast<uint64_t>(FRAME_ALIGNMENT - 1u);
+	}
+}}
+
+namespace anvil {
+
+	/*!
+		\brief Appends independently serialised records to a file that can be read back in any order.
+		\details Each append reserves its frame under a short lock and then writes it with a positional write, so
+		threads with their own Record write to the file in parallel. Records are numbered in the order their frames
+		were reserved. The sparse index is kept in memory and written as the footer when the file is closed.
+		All appends must have returned before Close is called.
+	*/
+	class RecordFileWriter {
+	public:
+		/*!
+			\brief Collects the bytes of one record, for example as the pipe of a BytePipeSerialiser.
+			\details Space for the frame header is kept in front of the bytes so that the frame is written in one call.
+		*/
+		class Record final : public BytePipe::OutputPipe {
+		private:
+			std::vector<uint8_t> _data;
+
+			friend RecordFileWriter;
+		public:
+			Record();
+
+			/*!
+				\brief Discard the bytes, Append does this once they are written.
+			*/
+			void Clear();
+
+			inline const void* GetData() const {
+				return _data.data() + sizeof(RecordFileFormat::FrameHeader);
+			}
+
+			inline size_t GetSize() const {
+				return _data.size() - sizeof(RecordFileFormat::FrameHeader);
+			}
+
+			// Inherited from OutputPipe
+
+			uint32_t WriteBytes(const void* src, const uint32_t bytes) final;
+			void Flush() final;
+		};
+	private:
+		std::mutex _mutex;		//!< Held while a frame is reserved, never while it is written
+		std::vector<RecordFileFormat::IndexEntry> _index;
+		uint64_t _end;			//!< Offset of the next frame
+		uint64_t _record_count;
+		uint32_t _index_interval;
+#ifdef _WIN32
+		void* _file;
+#else
+		int _file;
+#endif
+		bool _open;
+
+		void _WriteAt(const void* data, size_t bytes, uint64_t offset);
+		void _Truncate(const uint64_t size);
+	public:
+		/*!
+			\param path The file to write.
+			\param append True to add records to an existing file, otherwise the file is replaced.
+			\param index_interval Number of records between index entries of a new file, appended files keep theirs.
+		*/
+		RecordFileWriter(const char* path, const bool append = false, const uint32_t index_interval = RecordFileFormat::DEFAULT_INDEX_INTERVAL);
+		RecordFileWriter(const RecordFileWriter&) = delete;
+		RecordFileWriter& operator=(const RecordFileWriter&) = delete;
+		~RecordFileWriter();
+
+		/*!
+			\brief Write a record to the file and clear it, this can be called from several threads at once.
+			\return The number of the record.
+		*/
+		uint64_t Append(Record& record, const int64_t timestamp = 0);
+
+		uint64_t GetRecordCount();
+
+		/*!
+			\brief Make the records that have been written durable.
+		*/
+		void Flush();
+
+		/*!
+			\brief Write the index and close the file, the destructor does this if Close is not called.
+		*/
+		void Close();
+	};
+
+	/*!
+		\brief Reads records from a memory mapped record file.
+		\details Records are found by binary searching the sparse index and then walking at most index_interval
+		frames, only the frames that are walked are touched. Records are views of the mapping, which lives as long as
+		the reader.
+	*/
+	class RecordFileReader {
+	private:
+		MemoryMappedFile _file;
+		std::vector<RecordFileFormat::IndexEntry> _index;
+		const uint8_t* _data;
+		uint64_t _frames_end;	//!< Offset of the end of the last complete frame
+		uint64_t _record_count;
+		uint32_t _index_interval;
+		bool _complete;
+
+		void _ReadFrame(const uint64_t offset, RecordFileFormat::FrameHeader& header) const;
+		uint64_t _FindFrame(const uint64_t record) const;
+		void _BuildIndex();
+
+		friend RecordFileWriter;
+	public:
+		RecordFileReader(const char* path);
+		RecordFileReader(const RecordFileReader&) = delete;
+		RecordFileReader& operator=(const RecordFileReader&) = delete;
+
+		inline uint64_t GetRecordCount() const {
+			return _record_count;
+		}
+
+		/*!
+			\brief Return false if the file has no footer, so its index was rebuilt by walking the frames.
+		*/
+		inline bool IsComplete() const {
+			return _complete;
+		}
+
+		/*!
+			\brief Return the bytes of a record, which are aligned to RecordFileFormat::FRAME_ALIGNMENT.
+			\param bytes Set to the size of the record.
+		*/
+		const void* GetRecordData(const uint64_t record, size_t& bytes) const;
+
+		int64_t GetTimestamp(const uint64_t record) const;
+
+		/*!
+			\brief Return a view of the value a BytePipeSerialiser wrote to the record.
+		*/
+		BytePipeView GetRecord(const uint64_t record) const;
+
+		/*!
+			\brief Return the first record with a timestamp that is not less than the one given.
+			\details Timestamps must not decrease from one record to the next.
+			\return The number of the record, or GetRecordCount if there is none.
+		*/
+		uint64_t FindTimestamp(const int64_t timestamp) const;
+	};
+}
+
+#endif
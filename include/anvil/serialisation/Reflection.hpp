@@ -0,0 +1,232 @@
+// MIT License
+// 
+// Copyright(c) 2021 Adam Smith
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef ANVIL_SERIALISATION_REFLECTION_HPP
+#define ANVIL_SERIALISATION_REFLECTION_HPP
+
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "anvil/serialisation/Serialiser.hpp"
+
+/*!
+	\brief Declare a field of a struct for ANVIL_SCHEMA.
+*/
+#define ANVIL_FIELD(TYPE, MEMBER) ::anvil::Reflection::MakeField(#MEMBER, &TYPE::MEMBER)
+
+/*!
+	\brief Declare the fields of a struct so that it can be serialised without naming each member at runtime.
+	\details Must be used at global scope, for example ANVIL_SCHEMA(Point, ANVIL_FIELD(Point, x), ANVIL_FIELD(Point, y))
+	Fields are written in the order they are declared. Supported field types are the primitive Serialiser types,
+	std::string, std::vector of a supported type and other structs with a schema.
+*/
+#define ANVIL_SCHEMA(TYPE, ...) \
+	namespace anvil { namespace Reflection { \
+		template<> struct Schema<TYPE> { \
+			static constexpr auto GetFields() { return std::make_tuple(__VA_ARGS__); } \
+		}; \
+	}}
+
+namespace anvil { namespace Reflection {
+
+	/*!
+		\brief Specialised by ANVIL_SCHEMA to list the fields of a struct.
+	*/
+	template<class T>
+	struct Schema;
+
+	template<class Class, class Member>
+	struct Field {
+		typedef Member Type;
+
+		const char* name;
+		uint32_t name_length;		//!< Length of the name without the null terminator
+		Member Class::* member;
+	};
+
+	template<class Class, class Member, size_t N>
+	constexpr Field<Class, Member> MakeField(const char(&name)[N], Member Class::* member) {
+		return Field<Class, Member>{ name, static_cast<uint32_t>(N - 1u), member };
+	}
+
+	template<class T, class = void>
+	struct IsReflected : std::false_type {};
+
+	template<class T>
+	struct IsReflected<T, decltype(static_cast<void>(Schema<T>::GetFields()))> : std::true_type {};
+
+	template<class T>
+	struct FieldCount {
+		enum : uint32_t { value = std::tuple_size<decltype(Schema<T>::GetFields())>::value };
+	};
+
+	template<class T>
+	struct IsPrimitive {
+		enum : bool {
+			value = std::is_same<T, uint8_t>::value || std::is_same<T, uint16_t>::value || std::is_same<T, uint32_t>::value ||
+				std::is_same<T, uint64_t>::value || std::is_same<T, int8_t>::value || std::is_same<T, int16_t>::value ||
+				std::is_same<T, int32_t>::value || std::is_same<T, int64_t>::value || std::is_same<T, float>::value || std::is_same<T, double>::value
+		};
+	};
+
+	template<class Tuple, class F, size_t... I>
+	inline void ForEachField(const Tuple& fields, F&& function, std::index_sequence<I...>) {
+		const int expand[] = { 0, (function(std::get<I>(fields)), 0)... };
+		static_cast<void>(expand);
+	}
+
+	/*!
+		\brief Call a function with each Field of a struct, the calls are expanded at compile time.
+	*/
+	template<class T, class F>
+	inline void ForEachField(F&& function) {
+		constexpr auto fields = Schema<T>::GetFields();
+		ForEachField(fields, function, std::make_index_sequence<FieldCount<T>::value>());
+	}
+
+	// Writing through the Serialiser interface, which works with any serialiser
+
+	inline void Write(Serialiser& serialiser, const uint8_t value) {
+		serialiser.SetNextValueU8(value);
+	}
+
+	inline void Write(Serialiser& serialiser, const uint16_t value) {
+		serialiser.SetNextValueU16(value);
+	}
+
+	inline void Write(Serialiser& serialiser, const uint32_t value) {
+		serialiser.SetNextValueU32(value);
+	}
+
+	inline void Write(Serialiser& serialiser, const uint64_t value) {
+		serialiser.SetNextValueU64(value);
+	}
+
+	inline void Write(Serialiser& serialiser, const int8_t value) {
+		serialiser.SetNextValueS8(value);
+	}
+
+	inline void Write(Serialiser& serialiser, const int16_t value) {
+		serialiser.SetNextValueS16(value);
+	}
+
+	inline void Write(Serialiser& serialiser, const int32_t value) {
+		serialiser.SetNextValueS32(value);
+	}
+
+	inline void Write(Serialiser& serialiser, const int64_t value) {
+		serialiser.SetNextValueS64(value);
+	}
+
+	inline void Write(Serialiser& serialiser, const float value) {
+		serialiser.SetNextValueF32(value);
+	}
+
+	inline void Write(Serialiser& serialiser, const double value) {
+		serialiser.SetNextValueF64(value);
+	}
+
+	inline void WriteArray(Serialiser& serialiser, const uint8_t* values, const size_t count) {
+		serialiser.SetNextValueU8(values, count);
+	}
+
+	inline void WriteArray(Serialiser& serialiser, const uint16_t* values, const size_t count) {
+		serialiser.SetNextValueU16(values, count);
+	}
+
+	inline void WriteArray(Serialiser& serialiser, const uint32_t* values, const size_t count) {
+		serialiser.SetNextValueU32(values, count);
+	}
+
+	inline void WriteArray(Serialiser& serialiser, const uint64_t* values, const size_t count) {
+		serialiser.SetNextValueU64(values, count);
+	}
+
+	inline void WriteArray(Serialiser& serialiser, const int8_t* values, const size_t count) {
+		serialiser.SetNextValueS8(values, count);
+	}
+
+	inline void WriteArray(Serialiser& serialiser, const int16_t* values, const size_t count) {
+		serialiser.SetNextValueS16(values, count);
+	}
+
+	inline void WriteArray(Serialiser& serialiser, const int32_t* values, const size_t count) {
+		serialiser.SetNextValueS32(values, count);
+	}
+
+	inline void WriteArray(Serialiser& serialiser, const int64_t* values, const size_t count) {
+		serialiser.SetNextValueS64(values, count);
+	}
+
+	inline void WriteArray(Serialiser& serialiser, const float* values, const size_t count) {
+		serialiser.SetNextValueF32(values, count);
+	}
+
+	inline void WriteArray(Serialiser& serialiser, const double* values, const size_t count) {
+		serialiser.SetNextValueF64(values, count);
+	}
+
+	inline void Write(Serialiser& serialiser, const std::string& value) {
+		serialiser.SetNextValueString(value.c_str());
+	}
+
+	template<class T>
+	inline void Write(Serialiser& serialiser, const std::vector<T>& value);
+
+	template<class T>
+	inline typename std::enable_if<IsReflected<T>::value>::type Write(Serialiser& serialiser, const T& value);
+
+	template<class T>
+	inline void WriteElements(Serialiser& serialiser, const std::vector<T>& value, std::true_type) {
+		if (!value.empty()) WriteArray(serialiser, value.data(), value.size());
+	}
+
+	template<class T>
+	inline void WriteElements(Serialiser& serialiser, const std::vector<T>& value, std::false_type) {
+		for (const T& element : value) Write(serialiser, element);
+	}
+
+	template<class T>
+	inline void Write(Serialiser& serialiser, const std::vector<T>& value) {
+		serialiser.StartArray();
+		WriteElements(serialiser, value, std::integral_constant<bool, IsPrimitive<T>::value>());
+		serialiser.EndArray();
+	}
+
+	/*!
+		\brief Write a struct with a schema as an object.
+	*/
+	template<class T>
+	inline typename std::enable_if<IsReflected<T>::value>::type Write(Serialiser& serialiser, const T& value) {
+		serialiser.StartObject();
+		ForEachField<T>([&serialiser, &value](const auto& field) {
+			serialiser.SetNextMemberName(field.name);
+			Write(serialiser, value.*(field.member));
+		});
+		serialiser.EndObject();
+	}
+
+}}
+
+#endif
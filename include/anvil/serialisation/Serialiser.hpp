@@ -24,6 +24,7 @@
 #define ANVIL_SERIALISATION_SERIALISER_HPP
 
 #include <cstdint>
+#include <cstddef>
 
 namespace anvil {
 	class Serialiser {
@@ -70,110 +71,110 @@ namespace anvil {
 		// Object name helpers
 	
 		inline void SetNextValueU8(const char* name, const uint8_t value) {
-			Serialiser::SetNextMemberName(name);
-			Serialiser::SetNextValueU8(value);
+			SetNextMemberName(name);
+			SetNextValueU8(value);
 		}
 	
 		inline void SetNextValueU16(const char* name, const uint16_t value) {
-			Serialiser::SetNextMemberName(name);
-			Serialiser::SetNextValueU16(value);
+			SetNextMemberName(name);
+			SetNextValueU16(value);
 		}
 	
 		inline void SetNextValueU32(const char* name, const uint32_t value) {
-			Serialiser::SetNextMemberName(name);
-			Serialiser::SetNextValueU32(value);
+			SetNextMemberName(name);
+			SetNextValueU32(value);
 		}
 	
 		inline void SetNextValueU64(const char* name, const uint64_t value) {
-			Serialiser::SetNextMemberName(name);
-			Serialiser::SetNextValueU64(value);
+			SetNextMemberName(name);
+			SetNextValueU64(value);
 		}
 	
 		inline void SetNextValueS8(const char* name, const int8_t value) {
-			Serialiser::SetNextMemberName(name);
-			Serialiser::SetNextValueS8(value);
+			SetNextMemberName(name);
+			SetNextValueS8(value);
 		}
 	
 		inline void SetNextValueS16(const char* name, const int16_t value) {
-			Serialiser::SetNextMemberName(name);
-			Serialiser::SetNextValueS16(value);
+			SetNextMemberName(name);
+			SetNextValueS16(value);
 		}
 	
 		inline void SetNextValueS32(const char* name, const int32_t value) {
-			Serialiser::SetNextMemberName(name);
-			Serialiser::SetNextValueS32(value);
+			SetNextMemberName(name);
+			SetNextValueS32(value);
 		}
 	
 		inline void SetNextValueS64(const char* name, const int64_t value) {
-			Serialiser::SetNextMemberName(name);
-			Serialiser::SetNextValueS64(value);
+			SetNextMemberName(name);
+			SetNextValueS64(value);
 		}
 	
 		inline void SetNextValueF32(const char* name, const float value) {
-			Serialiser::SetNextMemberName(name);
-			Serialiser::SetNextValueF32(value);
+			SetNextMemberName(name);
+			SetNextValueF32(value);
 		}
 	
 		inline void SetNextValueF64(const char* name, const double value) {
-			Serialiser::SetNextMemberName(name);
-			Serialiser::SetNextValueF64(value);
+			SetNextMemberName(name);
+			SetNextValueF64(value);
 		}
 	
 		inline void SetNextValueString(const char* name, const char* value) {
-			Serialiser::SetNextMemberName(name);
-			Serialiser::SetNextValueString(value);
+			SetNextMemberName(name);
+			SetNextValueString(value);
 		}
 	
 		inline void StartArray(const char* name) {
-			Serialiser::SetNextMemberName(name);
-			Serialiser::StartArray();
+			SetNextMemberName(name);
+			StartArray();
 		}
 	
 		inline void StartObject(const char* name) {
-			Serialiser::SetNextMemberName(name);
-			Serialiser::StartArray();
+			SetNextMemberName(name);
+			StartObject();
 		}
 
 		// Array optimisations
 
 		virtual void SetNextValueU8(const uint8_t* value, const size_t count) {
-			for (size_t i = 0; i < count; ++i) Serialiser::SetNextValueU8(value[i]);
+			for (size_t i = 0; i < count; ++i) SetNextValueU8(value[i]);
 		}
 
 		virtual void SetNextValueU16(const uint16_t* value, const size_t count) {
-			for (size_t i = 0; i < count; ++i) Serialiser::SetNextValueU16(value[i]);
+			for (size_t i = 0; i < count; ++i) SetNextValueU16(value[i]);
 		}
 
 		virtual void SetNextValueU32(const uint32_t* value, const size_t count) {
-			for (size_t i = 0; i < count; ++i) Serialiser::SetNextValueU32(value[i]);
+			for (size_t i = 0; i < count; ++i) SetNextValueU32(value[i]);
 		}
 
 		virtual void SetNextValueU64(const uint64_t* value, const size_t count) {
-			for (size_t i = 0; i < count; ++i) Serialiser::SetNextValueU64(value[i]);
+			for (size_t i = 0; i < count; ++i) SetNextValueU64(value[i]);
 		}
 
 		virtual void SetNextValueS8(const int8_t* value, const size_t count) {
-			for (size_t i = 0; i < count; ++i) Serialiser::SetNextValueS8(value[i]);
+			for (size_t i = 0; i < count; ++i) SetNextValueS8(value[i]);
 		}
 
 		virtual void SetNextValueS16(const int16_t* value, const size_t count) {
-			for (size_t i = 0; i < count; ++i) Serialiser::SetNextValueS16(value[i]);
+			for (size_t i = 0; i < count; ++i) SetNextValueS16(value[i]);
 		}
 
 		virtual void SetNextValueS32(const int32_t* value, const size_t count) {
-			for (size_t i = 0; i < count; ++i) Serialiser::SetNextValueS32(value[i]);
+			for (size_t i = 0; i < count; ++i) SetNextValueS32(value[i]);
 		}
 
 		virtual void SetNextValueS64(const int64_t* value, const size_t count) {
-			for (size_t i = 0; i < count; ++i) Serialiser::SetNextValueS64(value[i]);
+			for (size_t i = 0; i < count; ++i) SetNextValueS64(value[i]);
 		}
 
 		virtual void SetNextValueF32(const float* value, const size_t count) {
-			for (size_t i = 0; i < count; ++i) Serialiser::SetNextValueF32(value[i]);
+			for (size_t i = 0; i < count; ++i) SetNextValueF32(value[i]);
 		}
 
 		virtual void SetNextValueF64(const double* value, const size_t count) {
-			for (size_t i = 0; i < count; ++i) Serialiser::SetNextValueF64(value[i]);
+			for (size_t i = 0; i < count; ++i) SetNextValueF64(value[i]);
 		}
 
 		// Template helpers
@@ -186,119 +187,121 @@ namespace anvil {
 
 		template<class T>
 		inline void SetNextValue(const char* name, T value) {
-			Serialiser::SetNextMemberName(name);
+			SetNextMemberName(name);
 			Serialiser::SetNextValue<T>(value);
 		}
 
 		template<class T>
 		inline void SetNextValue(const char* name, const T* value, const uint32_t count) {
 			// A named array is a special case so we will also call EndArray
-			Serialiser::StartArray(name);
+			StartArray(name);
 			Serialiser::SetNextValue<T>(value, count);
-			Serialiser::EndArray();
-		}
-
-		template<>
-		inline void SetNextValue<uint8_t>(uint8_t value) {
-			Serialiser::SetNextValueU8(value);
-		}
-
-		template<>
-		inline void SetNextValue<uint8_t>(const uint8_t* value, const uint32_t count) {
-			Serialiser::SetNextValueU8(value, count);
-		}
-
-		template<>
-		inline void SetNextValue<uint16_t>(uint16_t value) {
-			Serialiser::SetNextValueU16(value);
-		}
-
-		template<>
-		inline void SetNextValue<uint16_t>(const uint16_t* value, const uint32_t count) {
-			Serialiser::SetNextValueU16(value, count);
-		}
-
-		template<>
-		inline void SetNextValue<uint32_t>(uint32_t value) {
-			Serialiser::SetNextValueU32(value);
-		}
-
-		template<>
-		inline void SetNextValue<uint32_t>(const uint32_t* value, const uint32_t count) {
-			Serialiser::SetNextValueU32(value, count);
-		}
-
-		template<>
-		inline void SetNextValue<uint64_t>(uint64_t value) {
-			Serialiser::SetNextValueU64(value);
-		}
-
-		template<>
-		inline void SetNextValue<uint64_t>(const uint64_t* value, const uint32_t count) {
-			Serialiser::SetNextValueU64(value, count);
-		}
-
-		template<>
-		inline void SetNextValue<int8_t>(int8_t value) {
-			Serialiser::SetNextValueS8(value);
-		}
-
-		template<>
-		inline void SetNextValue<int8_t>(const int8_t* value, const uint32_t count) {
-			Serialiser::SetNextValueS8(value, count);
-		}
-
-		template<>
-		inline void SetNextValue<int16_t>(int16_t value) {
-			Serialiser::SetNextValueS16(value);
-		}
-
-		template<>
-		inline void SetNextValue<int16_t>(const int16_t* value, const uint32_t count) {
-			Serialiser::SetNextValueS16(value, count);
-		}
-
-		template<>
-		inline void SetNextValue<int32_t>(int32_t value) {
-			Serialiser::SetNextValueS32(value);
-		}
-
-		template<>
-		inline void SetNextValue<int32_t>(const int32_t* value, const uint32_t count) {
-			Serialiser::SetNextValueS32(value, count);
-		}
-
-		template<>
-		inline void SetNextValue<int64_t>(int64_t value) {
-			Serialiser::SetNextValueS64(value);
-		}
-
-		template<>
-		inline void SetNextValue<int64_t>(const int64_t* value, const uint32_t count) {
-			Serialiser::SetNextValueS64(value, count);
-		}
-
-		template<>
-		inline void SetNextValue<float>(float value) {
-			Serialiser::SetNextValueF32(value);
-		}
-
-		template<>
-		inline void SetNextValue<float>(const float* value, const uint32_t count) {
-			Serialiser::SetNextValueF32(value, count);
-		}
-
-		template<>
-		inline void SetNextValue<double>(double value) {
-			Serialiser::SetNextValueF64(value);
-		}
-
-		template<>
-		inline void SetNextValue<double>(const double* value, const uint32_t count) {
-			Serialiser::SetNextValueF64(value, count);
+			EndArray();
 		}
 	};
 
+	// Explicit specialisations must be declared at namespace scope
+
+	template<>
+	inline void Serialiser::SetNextValue<uint8_t>(uint8_t value) {
+		SetNextValueU8(value);
+	}
+
+	template<>
+	inline void Serialiser::SetNextValue<uint8_t>(const uint8_t* value, const uint32_t count) {
+		SetNextValueU8(value, count);
+	}
+
+	template<>
+	inline void Serialiser::SetNextValue<uint16_t>(uint16_t value) {
+		SetNextValueU16(value);
+	}
+
+	template<>
+	inline void Serialiser::SetNextValue<uint16_t>(const uint16_t* value, const uint32_t count) {
+		SetNextValueU16(value, count);
+	}
+
+	template<>
+	inline void Serialiser::SetNextValue<uint32_t>(uint32_t value) {
+		SetNextValueU32(value);
+	}
+
+	template<>
+	inline void Serialiser::SetNextValue<uint32_t>(const uint32_t* value, const uint32_t count) {
+		SetNextValueU32(value, count);
+	}
+
+	template<>
+	inline void Serialiser::SetNextValue<uint64_t>(uint64_t value) {
+		SetNextValueU64(value);
+	}
+
+	template<>
+	inline void Serialiser::SetNextValue<uint64_t>(const uint64_t* value, const uint32_t count) {
+		SetNextValueU64(value, count);
+	}
+
+	template<>
+	inline void Serialiser::SetNextValue<int8_t>(int8_t value) {
+		SetNextValueS8(value);
+	}
+
+	template<>
+	inline void Serialiser::SetNextValue<int8_t>(const int8_t* value, const uint32_t count) {
+		SetNextValueS8(value, count);
+	}
+
+	template<>
+	inline void Serialiser::SetNextValue<int16_t>(int16_t value) {
+		SetNextValueS16(value);
+	}
+
+	template<>
+	inline void Serialiser::SetNextValue<int16_t>(const int16_t* value, const uint32_t count) {
+		SetNextValueS16(value, count);
+	}
+
+	template<>
+	inline void Serialiser::SetNextValue<int32_t>(int32_t value) {
+		SetNextValueS32(value);
+	}
+
+	template<>
+	inline void Serialiser::SetNextValue<int32_t>(const int32_t* value, const uint32_t count) {
+		SetNextValueS32(value, count);
+	}
+
+	template<>
+	inline void Serialiser::SetNextValue<int64_t>(int64_t value) {
+		SetNextValueS64(value);
+	}
+
+	template<>
+	inline void Serialiser::SetNextValue<int64_t>(const int64_t* value, const uint32_t count) {
+		SetNextValueS64(value, count);
+	}
+
+	template<>
+	inline void Serialiser::SetNextValue<float>(float value) {
+		SetNextValueF32(value);
+	}
+
+	template<>
+	inline void Serialiser::SetNextValue<float>(const float* value, const uint32_t count) {
+		SetNextValueF32(value, count);
+	}
+
+	template<>
+	inline void Serialiser::SetNextValue<double>(double value) {
+		SetNextValueF64(value);
+	}
+
+	template<>
+	inline void Serialiser::SetNextValue<double>(const double* value, const uint32_t count) {
+		SetNextValueF64(value, count);
+	}
+
 
 	typedef Serialiser Deserialiser; //!< Deserialisation uses the same interface as serialisation
 }
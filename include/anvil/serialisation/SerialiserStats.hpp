@@ -0,0 +1,101 @@
+// MIT License
+// 
+// Copyright(c) 2021 Adam Smith
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef ANVIL_SERIALISATION_STATS_HPP
+#define ANVIL_SERIALISATION_STATS_HPP
+
+#include <cstdint>
+#include <cstring>
+#include "anvil/serialisation/Serialiser.hpp"
+
+/*
+	Serialiser instrumentation is compiled in when ANVIL_SERIALISATION_STATS is defined as 1. It changes the layout of
+	BytePipeSerialiser, so it must be set the same way for every translation unit, normally from the build flags.
+	When it is 0 the counters do not exist and ANVIL_SERIALISATION_STAT expands to nothing.
+*/
+#ifndef ANVIL_SERIALISATION_STATS
+	#define ANVIL_SERIALISATION_STATS 0
+#endif
+
+#if ANVIL_SERIALISATION_STATS
+	#define ANVIL_SERIALISATION_STAT(...) __VA_ARGS__
+#else
+	#define ANVIL_SERIALISATION_STAT(...)
+#endif
+
+namespace anvil {
+
+	/*!
+		\brief Counters collected by a BytePipeSerialiser since it was created or its stats were last reset.
+	*/
+	struct SerialiserStats {
+		enum : size_t {
+			TYPE_COUNT = Serialiser::TYPE_OBJECT + 1u
+		};
+
+		uint64_t values[TYPE_COUNT];	//!< Number of values written of each Serialiser::Type, including array elements
+		uint64_t bytes_written;			//!< Bytes given to the pipe
+		uint64_t pipe_writes;			//!< Number of WriteBytes and WriteGather calls made on the pipe
+		uint64_t pipe_write_time;		//!< Nanoseconds spent inside the pipe's WriteBytes and WriteGather
+		uint64_t pipe_flush_time;		//!< Nanoseconds spent inside the pipe's Flush
+		uint64_t buffer_reallocations;	//!< Number of times the output buffer grew
+		uint64_t bytes_moved;			//!< Bytes copied within the buffer after they were written, by compact containers shrinking their length, encoded arrays and parallel writes
+		uint32_t max_depth;				//!< Largest number of containers open at once
+
+		SerialiserStats() {
+			Clear();
+		}
+
+		inline void Clear() {
+			memset(this, 0, sizeof(SerialiserStats));
+		}
+
+		/*!
+			\brief Add the counters of another serialiser, the depth is the larger of the two.
+		*/
+		void Add(const SerialiserStats& other) {
+			for (size_t i = 0u; i < TYPE_COUNT; ++i) values[i] += other.values[i];
+			bytes_written += other.bytes_written;
+			pipe_writes += other.pipe_writes;
+			pipe_write_time += other.pipe_write_time;
+			pipe_flush_time += other.pipe_flush_time;
+			buffer_reallocations += other.buffer_reallocations;
+			bytes_moved += other.bytes_moved;
+			if (other.max_depth > max_depth) max_depth = other.max_depth;
+		}
+	};
+
+	/*!
+		\brief Receives the stats of a serialiser, for example to export them to a metrics system.
+	*/
+	class SerialiserStatsSink {
+	public:
+		virtual ~SerialiserStatsSink() {}
+
+		/*!
+			\param stats The totals since the serialiser's stats were last reset.
+		*/
+		virtual void Report(const SerialiserStats& stats) = 0;
+	};
+}
+
+#endif
@@ -0,0 +1,127 @@
+// MIT License
+// 
+// Copyright(c) 2021 Adam Smith
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstdlib>
+#include "anvil/serialisation/Allocator.hpp"
+
+namespace anvil {
+
+	enum : size_t {
+		ARENA_ALIGNMENT = alignof(std::max_align_t)
+	};
+
+	static inline size_t AlignSize(const size_t bytes) {
+		return (bytes + ARENA_ALIGNMENT - 1u) & ~static_cast<size_t>(ARENA_ALIGNMENT - 1u);
+	}
+
+	// Allocator
+
+	class DefaultAllocator final : public Allocator {
+	public:
+		void* Allocate(const size_t bytes) final {
+			void* const ptr = std::malloc(bytes > 0u ? bytes : 1u);
+			if (ptr == nullptr) throw std::bad_alloc();
+			return ptr;
+		}
+
+		void Deallocate(void* ptr, const size_t) final {
+			std::free(ptr);
+		}
+	};
+
+	Allocator& Allocator::GetDefault() {
+		static DefaultAllocator g_allocator;
+		return g_allocator;
+	}
+
+	// ArenaAllocator
+
+	ArenaAllocator::ArenaAllocator(const size_t chunk_size) :
+		_chunk_size(chunk_size < ARENA_ALIGNMENT ? ARENA_ALIGNMENT : AlignSize(chunk_size)),
+		_current_chunk(0u),
+		_used(0u),
+		_last_allocation(nullptr)
+	{}
+
+	ArenaAllocator::~ArenaAllocator() {
+		for (Chunk& chunk : _chunks) std::free(chunk.data);
+	}
+
+	bool ArenaAllocator::_NextChunk(const size_t bytes) {
+		// Reuse a chunk kept by Reset if it is large enough
+		while (_current_chunk + 1u < _chunks.size()) {
+			++_current_chunk;
+			_used = 0u;
+			if (_chunks[_current_chunk].size >= bytes) return true;
+		}
+
+		Chunk chunk;
+		chunk.size = bytes > _chunk_size ? AlignSize(bytes) : _chunk_size;
+		chunk.data = static_cast<uint8_t*>(std::malloc(chunk.size));
+		if (chunk.data == nullptr) throw std::bad_alloc();
+		_chunks.push_back(chunk);
+		_current_chunk = _chunks.size() - 1u;
+		_used = 0u;
+		return true;
+	}
+
+	void* ArenaAllocator::Allocate(const size_t bytes) {
+		const size_t size = AlignSize(bytes > 0u ? bytes : 1u);
+		if (_chunks.empty() || _chunks[_current_chunk].size - _used < size) _NextChunk(size);
+
+		uint8_t* const ptr = _chunks[_current_chunk].data + _used;
+		_used += size;
+		_last_allocation = ptr;
+		return ptr;
+	}
+
+	void ArenaAllocator::Deallocate(void* ptr, const size_t) {
+		// Only the most recent allocation can be given back
+		if (ptr != nullptr && ptr == _last_allocation) {
+			_used = static_cast<size_t>(_last_allocation - _chunks[_current_chunk].data);
+			_last_allocation = nullptr;
+		}
+	}
+
+	bool ArenaAllocator::TryExtend(void* ptr, const size_t, const size_t new_bytes) {
+		if (ptr == nullptr || ptr != _last_allocation) return false;
+
+		const size_t offset = static_cast<size_t>(_last_allocation - _chunks[_current_chunk].data);
+		const size_t size = AlignSize(new_bytes);
+		if (_chunks[_current_chunk].size - offset < size) return false;
+
+		_used = offset + size;
+		return true;
+	}
+
+	void ArenaAllocator::Reset() {
+		_current_chunk = 0u;
+		_used = 0u;
+		_last_allocation = nullptr;
+	}
+
+	size_t ArenaAllocator::GetCapacity() const {
+		size_t capacity = 0u;
+		for (const Chunk& chunk : _chunks) capacity += chunk.size;
+		return capacity;
+	}
+}
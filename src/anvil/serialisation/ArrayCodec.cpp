@@ -0,0 +1,1034 @@
+// MIT License
+// 
+// Copyright(c) 2021 Adam Smith
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstring>
+#include <stdexcept>
+#include "anvil/serialisation/ArrayCodec.hpp"
+#include "anvil/serialisation/ByteOrder.hpp"
+
+#if defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+
+#if defined(__AVX2__)
+	#include <immintrin.h>
+	#define ANVIL_CODEC_AVX2 1
+	#define ANVIL_CODEC_SSE41 1
+#elif defined(__SSE4_1__)
+	#include <smmintrin.h>
+	#define ANVIL_CODEC_SSE41 1
+#endif
+
+namespace anvil { namespace ArrayCodec {
+
+	enum : size_t {
+		BLOCK_SIZE = BytePipeFormat::CODEC_BLOCK_SIZE,
+		SHUFFLE_BLOCK_SIZE = BytePipeFormat::CODEC_SHUFFLE_BLOCK_SIZE,
+		MAX_PACKED_WIDTH = 56u	//!< Widest value that fits in the bit packing accumulator, wider blocks are stored unpacked
+	};
+
+	// Scalar kernels
+
+	template<class T>
+	static void DeltaEncode(const T* src, T* dst, const size_t count, T previous) {
+		for (size_t i = 0u; i < count; ++i) {
+			const T value = src[i];
+			dst[i] = static_cast<T>(value - previous);
+			previous = value;
+		}
+	}
+
+	template<class T>
+	static void DeltaDecode(T* values, const size_t count, T previous) {
+		for (size_t i = 0u; i < count; ++i) {
+			previous = static_cast<T>(previous + values[i]);
+			values[i] = previous;
+		}
+	}
+
+	template<class T>
+	static void ZigZagEncode(T* values, const size_t count) {
+		enum : size_t { SHIFT = sizeof(T) * 8u - 1u };
+		for (size_t i = 0u; i < count; ++i) {
+			const T value = values[i];
+			const T sign = static_cast<T>(0u - (value >> SHIFT));
+			values[i] = static_cast<T>(static_cast<T>(value << 1u) ^ sign);
+		}
+	}
+
+	template<class T>
+	static void ZigZagDecode(T* values, const size_t count) {
+		for (size_t i = 0u; i < count; ++i) {
+			const T value = values[i];
+			values[i] = static_cast<T>((value >> 1u) ^ static_cast<T>(0u - (value & 1u)));
+		}
+	}
+
+	template<class T>
+	static void MinMax(const T* values, const size_t count, T& min, T& max) {
+		min = values[0u];
+		max = values[0u];
+		for (size_t i = 1u; i < count; ++i) {
+			if (values[i] < min) min = values[i];
+			if (values[i] > max) max = values[i];
+		}
+	}
+
+	// SIMD kernels for 32 and 64-bit values, these are picked over the templates by overload resolution
+
+#if ANVIL_CODEC_SSE41
+	static void DeltaEncode(const uint32_t* src, uint32_t* dst, const size_t count, const uint32_t previous) {
+		if (count == 0u) return;
+		dst[0u] = src[0u] - previous;
+		size_t i = 1u;
+	#if ANVIL_CODEC_AVX2
+		for (; i + 8u <= count; i += 8u) {
+			const __m256i current = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+			const __m256i last = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i - 1u));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_sub_epi32(current, last));
+		}
+	#endif
+		for (; i + 4u <= count; i += 4u) {
+			const __m128i current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			const __m128i last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i - 1u));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_sub_epi32(current, last));
+		}
+		for (; i < count; ++i) dst[i] = src[i] - src[i - 1u];
+	}
+
+	static void DeltaEncode(const uint64_t* src, uint64_t* dst, const size_t count, const uint64_t previous) {
+		if (count == 0u) return;
+		dst[0u] = src[0u] - previous;
+		size_t i = 1u;
+	#if ANVIL_CODEC_AVX2
+		for (; i + 4u <= count; i += 4u) {
+			const __m256i current = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+			const __m256i last = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i - 1u));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_sub_epi64(current, last));
+		}
+	#endif
+		for (; i + 2u <= count; i += 2u) {
+			const __m128i current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			const __m128i last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i - 1u));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_sub_epi64(current, last));
+		}
+		for (; i < count; ++i) dst[i] = src[i] - src[i - 1u];
+	}
+
+	static void DeltaDecode(uint32_t* values, const size_t count, uint32_t previous) {
+		// Prefix sum of 4 values at a time
+		__m128i carry = _mm_set1_epi32(static_cast<int>(previous));
+		size_t i = 0u;
+		for (; i + 4u <= count; i += 4u) {
+			__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+			x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+			x = _mm_add_epi32(x, _mm_slli_si128(x, 8));
+			x = _mm_add_epi32(x, carry);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(values + i), x);
+			carry = _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3));
+		}
+		if (i > 0u) previous = values[i - 1u];
+		DeltaDecode<uint32_t>(values + i, count - i, previous);
+	}
+
+	static void DeltaDecode(uint64_t* values, const size_t count, uint64_t previous) {
+		// Prefix sum of 2 values at a time
+		__m128i carry = _mm_set1_epi64x(static_cast<int64_t>(previous));
+		size_t i = 0u;
+		for (; i + 2u <= count; i += 2u) {
+			__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+			x = _mm_add_epi64(x, _mm_slli_si128(x, 8));
+			x = _mm_add_epi64(x, carry);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(values + i), x);
+			carry = _mm_unpackhi_epi64(x, x);
+		}
+		if (i > 0u) previous = values[i - 1u];
+		DeltaDecode<uint64_t>(values + i, count - i, previous);
+	}
+
+	static void ZigZagEncode(uint32_t* values, const size_t count) {
+		size_t i = 0u;
+	#if ANVIL_CODEC_AVX2
+		for (; i + 8u <= count; i += 8u) {
+			const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(values + i), _mm256_xor_si256(_mm256_slli_epi32(x, 1), _mm256_srai_epi32(x, 31)));
+		}
+	#endif
+		for (; i + 4u <= count; i += 4u) {
+			const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(values + i), _mm_xor_si128(_mm_slli_epi32(x, 1), _mm_srai_epi32(x, 31)));
+		}
+		ZigZagEncode<uint32_t>(values + i, count - i);
+	}
+
+	static void ZigZagDecode(uint32_t* values, const size_t count) {
+		size_t i = 0u;
+	#if ANVIL_CODEC_AVX2
+		const __m256i one8 = _mm256_set1_epi32(1);
+		for (; i + 8u <= count; i += 8u) {
+			const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+			const __m256i sign = _mm256_sub_epi32(_mm256_setzero_si256(), _mm256_and_si256(x, one8));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(values + i), _mm256_xor_si256(_mm256_srli_epi32(x, 1), sign));
+		}
+	#endif
+		const __m128i one4 = _mm_set1_epi32(1);
+		for (; i + 4u <= count; i += 4u) {
+			const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+			const __m128i sign = _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(x, one4));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(values + i), _mm_xor_si128(_mm_srli_epi32(x, 1), sign));
+		}
+		ZigZagDecode<uint32_t>(values + i, count - i);
+	}
+
+	static void ZigZagEncode(uint64_t* values, const size_t count) {
+		size_t i = 0u;
+	#if ANVIL_CODEC_AVX2
+		for (; i + 4u <= count; i += 4u) {
+			const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+			const __m256i sign = _mm256_cmpgt_epi64(_mm256_setzero_si256(), x);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(values + i), _mm256_xor_si256(_mm256_slli_epi64(x, 1), sign));
+		}
+	#endif
+		for (; i + 2u <= count; i += 2u) {
+			const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+			// Copy the sign of the high half into both halves of each value
+			const __m128i sign = _mm_shuffle_epi32(_mm_srai_epi32(x, 31), _MM_SHUFFLE(3, 3, 1, 1));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(values + i), _mm_xor_si128(_mm_slli_epi64(x, 1), sign));
+		}
+		ZigZagEncode<uint64_t>(values + i, count - i);
+	}
+
+	static void ZigZagDecode(uint64_t* values, const size_t count) {
+		size_t i = 0u;
+	#if ANVIL_CODEC_AVX2
+		const __m256i one4 = _mm256_set1_epi64x(1);
+		for (; i + 4u <= count; i += 4u) {
+			const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+			const __m256i sign = _mm256_sub_epi64(_mm256_setzero_si256(), _mm256_and_si256(x, one4));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(values + i), _mm256_xor_si256(_mm256_srli_epi64(x, 1), sign));
+		}
+	#endif
+		const __m128i one2 = _mm_set1_epi64x(1);
+		for (; i + 2u <= count; i += 2u) {
+			const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+			const __m128i sign = _mm_sub_epi64(_mm_setzero_si128(), _mm_and_si128(x, one2));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(values + i), _mm_xor_si128(_mm_srli_epi64(x, 1), sign));
+		}
+		ZigZagDecode<uint64_t>(values + i, count - i);
+	}
+
+	static void MinMax(const uint32_t* values, const size_t count, uint32_t& min, uint32_t& max) {
+		if (count < 8u) {
+			MinMax<uint32_t>(values, count, min, max);
+			return;
+		}
+
+		__m128i min4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values));
+		__m128i max4 = min4;
+		size_t i = 4u;
+		for (; i + 4u <= count; i += 4u) {
+			const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+			min4 = _mm_min_epu32(min4, x);
+			max4 = _mm_max_epu32(max4, x);
+		}
+
+		uint32_t mins[4u], maxs[4u];
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(mins), min4);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(maxs), max4);
+		min = mins[0u];
+		max = maxs[0u];
+		for (size_t j = 1u; j < 4u; ++j) {
+			if (mins[j] < min) min = mins[j];
+			if (maxs[j] > max) max = maxs[j];
+		}
+		for (; i < count; ++i) {
+			if (values[i] < min) min = values[i];
+			if (values[i] > max) max = values[i];
+		}
+	}
+#endif
+
+	// Bit packing
+
+	template<class T>
+	static uint8_t GetBitWidth(T value) {
+		uint8_t width = 0u;
+		while (value != 0u) {
+			value = static_cast<T>(value >> 1u);
+			++width;
+		}
+		return width;
+	}
+
+	template<class T>
+	static void PackBlock(const T* values, const size_t count, std::vector<uint8_t>& dst) {
+		T min, max;
+		MinMax(values, count, min, max);
+		uint8_t width = GetBitWidth(static_cast<T>(max - min));
+		if (width > MAX_PACKED_WIDTH) width = sizeof(T) * 8u;
+
+		// Block header
+		size_t offset = dst.size();
+		dst.resize(offset + sizeof(T) + 1u + (count * width + 7u) / 8u);
+		uint8_t* out = dst.data() + offset;
+		const T reference = ByteOrder::ToLittleEndian(min);
+		memcpy(out, &reference, sizeof(T));
+		out += sizeof(T);
+		*out++ = width;
+
+		if (width == sizeof(T) * 8u) {
+			// Too wide to pack
+			for (size_t i = 0u; i < count; ++i) {
+				const T value = ByteOrder::ToLittleEndian(static_cast<T>(values[i] - min));
+				memcpy(out, &value, sizeof(T));
+				out += sizeof(T);
+			}
+			return;
+		}
+
+		uint64_t accumulator = 0u;
+		uint32_t bits = 0u;
+		for (size_t i = 0u; i < count; ++i) {
+			accumulator |= static_cast<uint64_t>(static_cast<T>(values[i] - min)) << bits;
+			bits += width;
+			while (bits >= 8u) {
+				*out++ = static_cast<uint8_t>(accumulator);
+				accumulator >>= 8u;
+				bits -= 8u;
+			}
+		}
+		if (bits > 0u) *out++ = static_cast<uint8_t>(accumulator);
+	}
+
+	template<class T>
+	static const uint8_t* UnpackBlock(const uint8_t* src, const uint8_t* end, T* values, const size_t count) {
+		if (static_cast<size_t>(end - src) < sizeof(T) + 1u) throw std::runtime_error("ArrayCodec::Decode : Encoded values are truncated");
+		T min;
+		memcpy(&min, src, sizeof(T));
+		min = ByteOrder::FromLittleEndian(min);
+		src += sizeof(T);
+		const uint8_t width = *src++;
+		if (width > sizeof(T) * 8u) throw std::runtime_error("ArrayCodec::Decode : Invalid bit width");
+
+		const size_t bytes = (count * width + 7u) / 8u;
+		if (static_cast<size_t>(end - src) < bytes) throw std::runtime_error("ArrayCodec::Decode : Encoded values are truncated");
+
+		if (width == sizeof(T) * 8u) {
+			for (size_t i = 0u; i < count; ++i) {
+				T value;
+				memcpy(&value, src + i * sizeof(T), sizeof(T));
+				values[i] = static_cast<T>(ByteOrder::FromLittleEndian(value) + min);
+			}
+			return src + bytes;
+		}
+
+		const uint64_t mask = width == 0u ? 0u : (~static_cast<uint64_t>(0u) >> (64u - width));
+		const uint8_t* in = src;
+		uint64_t accumulator = 0u;
+		uint32_t bits = 0u;
+		for (size_t i = 0u; i < count; ++i) {
+			while (bits < width) {
+				accumulator |= static_cast<uint64_t>(*in++) << bits;
+				bits += 8u;
+			}
+			values[i] = static_cast<T>(static_cast<T>(accumulator & mask) + min);
+			accumulator >>= width;
+			bits -= width;
+		}
+		return src + bytes;
+	}
+
+	// Run length encoding
+
+	template<class T>
+	static void WriteRun(T value, const uint32_t length, std::vector<uint8_t>& dst) {
+		uint8_t run[BytePipeFormat::MAX_VARINT_SIZE + sizeof(T)];
+		size_t bytes = BytePipeFormat::WriteVarint(run, length);
+		value = ByteOrder::ToLittleEndian(value);
+		memcpy(run + bytes, &value, sizeof(T));
+		bytes += sizeof(T);
+		dst.insert(dst.end(), run, run + bytes);
+	}
+
+	// Array encoding
+
+	// The values can be at any address in the serialiser's buffer, so they are copied into aligned blocks before being read.
+	// They are little-endian in the buffer and the encoded bytes, but the transforms work on host order values
+	template<class T>
+	static size_t EncodeValues(const uint8_t* src, const size_t count, const uint8_t codec, std::vector<uint8_t>& dst) {
+		const size_t begin = dst.size();
+		dst.reserve(begin + count * sizeof(T) + (count / BLOCK_SIZE + 1u) * (sizeof(T) + 1u));
+
+		T values[BLOCK_SIZE];
+		T block[BLOCK_SIZE];
+		T previous = 0u;
+		T run_value = 0u;
+		uint32_t run_length = 0u;
+
+		for (size_t i = 0u; i < count; i += BLOCK_SIZE) {
+			const size_t block_count = count - i < BLOCK_SIZE ? count - i : BLOCK_SIZE;
+
+			if (codec & BytePipeFormat::CODEC_DELTA) {
+				memcpy(values, src + sizeof(T) * i, sizeof(T) * block_count);
+				ByteOrder::FromLittleEndian(values, sizeof(T), block_count);
+				DeltaEncode(values, block, block_count, previous);
+				previous = values[block_count - 1u];
+			} else {
+				memcpy(block, src + sizeof(T) * i, sizeof(T) * block_count);
+				ByteOrder::FromLittleEndian(block, sizeof(T), block_count);
+			}
+
+			if (codec & BytePipeFormat::CODEC_ZIGZAG) ZigZagEncode(block, block_count);
+
+			if (codec & BytePipeFormat::CODEC_BIT_PACK) {
+				PackBlock(block, block_count, dst);
+			} else if (codec & BytePipeFormat::CODEC_RUN_LENGTH) {
+				for (size_t j = 0u; j < block_count; ++j) {
+					if (run_length > 0u && block[j] == run_value && run_length < UINT32_MAX) {
+						++run_length;
+					} else {
+						if (run_length > 0u) WriteRun(run_value, run_length, dst);
+						run_value = block[j];
+						run_length = 1u;
+					}
+				}
+			} else {
+				ByteOrder::ToLittleEndian(block, sizeof(T), block_count);
+				const uint8_t* const bytes = reinterpret_cast<const uint8_t*>(block);
+				dst.insert(dst.end(), bytes, bytes + sizeof(T) * block_count);
+			}
+		}
+
+		if (run_length > 0u) WriteRun(run_value, run_length, dst);
+
+		return dst.size() - begin;
+	}
+
+	// The values are written little-endian, the same as an array that is not encoded
+	template<class T>
+	static void DecodeValues(const uint8_t* src, const size_t bytes, const size_t count, const uint8_t codec, T* dst) {
+		const uint8_t* const end = src + bytes;
+
+		if (codec & BytePipeFormat::CODEC_BIT_PACK) {
+			for (size_t i = 0u; i < count; i += BLOCK_SIZE) {
+				const size_t block_count = count - i < BLOCK_SIZE ? count - i : BLOCK_SIZE;
+				src = UnpackBlock(src, end, dst + i, block_count);
+			}
+		} else if (codec & BytePipeFormat::CODEC_RUN_LENGTH) {
+			size_t i = 0u;
+			while (i < count) {
+				uint32_t length;
+				const size_t varint_size = BytePipeFormat::ReadVarint(src, static_cast<size_t>(end - src), length);
+				if (varint_size + sizeof(T) > static_cast<size_t>(end - src)) throw std::runtime_error("ArrayCodec::Decode : Encoded values are truncated");
+				src += varint_size;
+				if (length > count - i) throw std::runtime_error("ArrayCodec::Decode : Run is longer than the array");
+
+				T value;
+				memcpy(&value, src, sizeof(T));
+				value = ByteOrder::FromLittleEndian(value);
+				src += sizeof(T);
+				for (uint32_t j = 0u; j < length; ++j) dst[i++] = value;
+			}
+		} else {
+			if (bytes < sizeof(T) * count) throw std::runtime_error("ArrayCodec::Decode : Encoded values are truncated");
+			memcpy(dst, src, sizeof(T) * count);
+			ByteOrder::FromLittleEndian(dst, sizeof(T), count);
+		}
+
+		// Undo the transforms in the reverse order
+		if (codec & BytePipeFormat::CODEC_ZIGZAG) ZigZagDecode(dst, count);
+		if (codec & BytePipeFormat::CODEC_DELTA) DeltaDecode(dst, count, static_cast<T>(0u));
+		ByteOrder::ToLittleEndian(dst, sizeof(T), count);
+	}
+
+	// Float kernels, values are handled as unsigned integers of the same size
+
+	template<class T>
+	static void XorEncode(const T* src, T* dst, const size_t count, T previous) {
+		for (size_t i = 0u; i < count; ++i) {
+			const T value = src[i];
+			dst[i] = static_cast<T>(value ^ previous);
+			previous = value;
+		}
+	}
+
+	template<class T>
+	static void XorDecode(T* values, const size_t count, T previous) {
+		for (size_t i = 0u; i < count; ++i) {
+			previous = static_cast<T>(previous ^ values[i]);
+			values[i] = previous;
+		}
+	}
+
+	template<class T>
+	static void ShuffleBytes(const T* src, uint8_t* dst, const size_t count, const size_t begin) {
+		const uint8_t* const src_bytes = reinterpret_cast<const uint8_t*>(src);
+		for (size_t i = begin; i < count; ++i) {
+			for (size_t j = 0u; j < sizeof(T); ++j) dst[j * count + i] = src_bytes[i * sizeof(T) + j];
+		}
+	}
+
+	template<class T>
+	static void UnshuffleBytes(const uint8_t* src, T* dst, const size_t count, const size_t begin) {
+		uint8_t* const dst_bytes = reinterpret_cast<uint8_t*>(dst);
+		for (size_t i = begin; i < count; ++i) {
+			for (size_t j = 0u; j < sizeof(T); ++j) dst_bytes[i * sizeof(T) + j] = src[j * count + i];
+		}
+	}
+
+#if ANVIL_CODEC_SSE41
+	static void XorEncode(const uint32_t* src, uint32_t* dst, const size_t count, const uint32_t previous) {
+		if (count == 0u) return;
+		dst[0u] = src[0u] ^ previous;
+		size_t i = 1u;
+		for (; i + 4u <= count; i += 4u) {
+			const __m128i current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			const __m128i last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i - 1u));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_xor_si128(current, last));
+		}
+		for (; i < count; ++i) dst[i] = src[i] ^ src[i - 1u];
+	}
+
+	static void XorEncode(const uint64_t* src, uint64_t* dst, const size_t count, const uint64_t previous) {
+		if (count == 0u) return;
+		dst[0u] = src[0u] ^ previous;
+		size_t i = 1u;
+	#if ANVIL_CODEC_AVX2
+		for (; i + 4u <= count; i += 4u) {
+			const __m256i current = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+			const __m256i last = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i - 1u));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_xor_si256(current, last));
+		}
+	#endif
+		for (; i + 2u <= count; i += 2u) {
+			const __m128i current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			const __m128i last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i - 1u));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_xor_si128(current, last));
+		}
+		for (; i < count; ++i) dst[i] = src[i] ^ src[i - 1u];
+	}
+
+	static void XorDecode(uint32_t* values, const size_t count, uint32_t previous) {
+		// Prefix XOR of 4 values at a time
+		__m128i carry = _mm_set1_epi32(static_cast<int>(previous));
+		size_t i = 0u;
+		for (; i + 4u <= count; i += 4u) {
+			__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+			x = _mm_xor_si128(x, _mm_slli_si128(x, 4));
+			x = _mm_xor_si128(x, _mm_slli_si128(x, 8));
+			x = _mm_xor_si128(x, carry);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(values + i), x);
+			carry = _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3));
+		}
+		if (i > 0u) previous = values[i - 1u];
+		XorDecode<uint32_t>(values + i, count - i, previous);
+	}
+
+	static void XorDecode(uint64_t* values, const size_t count, uint64_t previous) {
+		// Prefix XOR of 2 values at a time
+		__m128i carry = _mm_set1_epi64x(static_cast<int64_t>(previous));
+		size_t i = 0u;
+		for (; i + 2u <= count; i += 2u) {
+			__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+			x = _mm_xor_si128(x, _mm_slli_si128(x, 8));
+			x = _mm_xor_si128(x, carry);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(values + i), x);
+			carry = _mm_unpackhi_epi64(x, x);
+		}
+		if (i > 0u) previous = values[i - 1u];
+		XorDecode<uint64_t>(values + i, count - i, previous);
+	}
+
+	// Byte shuffles work on 16 values at a time, each byte position is gathered with a byte shuffle and then transposed
+
+	static void ShuffleBytes(const uint32_t* src, uint8_t* dst, const size_t count, const size_t begin) {
+		const __m128i mask = _mm_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+		size_t i = begin;
+		for (; i + 16u <= count; i += 16u) {
+			const __m128i a0 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)), mask);
+			const __m128i a1 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 4u)), mask);
+			const __m128i a2 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 8u)), mask);
+			const __m128i a3 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 12u)), mask);
+			const __m128i t0 = _mm_unpacklo_epi32(a0, a1);
+			const __m128i t1 = _mm_unpackhi_epi32(a0, a1);
+			const __m128i t2 = _mm_unpacklo_epi32(a2, a3);
+			const __m128i t3 = _mm_unpackhi_epi32(a2, a3);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_unpacklo_epi64(t0, t2));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + count + i), _mm_unpackhi_epi64(t0, t2));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + count * 2u + i), _mm_unpacklo_epi64(t1, t3));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + count * 3u + i), _mm_unpackhi_epi64(t1, t3));
+		}
+		ShuffleBytes<uint32_t>(src, dst, count, i);
+	}
+
+	static void UnshuffleBytes(const uint8_t* src, uint32_t* dst, const size_t count, const size_t begin) {
+		// Interleave the byte planes back into whole values
+		size_t i = begin;
+		for (; i + 16u <= count; i += 16u) {
+			const __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			const __m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + count + i));
+			const __m128i a2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + count * 2u + i));
+			const __m128i a3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + count * 3u + i));
+			const __m128i t0 = _mm_unpacklo_epi8(a0, a1);
+			const __m128i t1 = _mm_unpackhi_epi8(a0, a1);
+			const __m128i t2 = _mm_unpacklo_epi8(a2, a3);
+			const __m128i t3 = _mm_unpackhi_epi8(a2, a3);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_unpacklo_epi16(t0, t2));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 4u), _mm_unpackhi_epi16(t0, t2));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 8u), _mm_unpacklo_epi16(t1, t3));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 12u), _mm_unpackhi_epi16(t1, t3));
+		}
+		UnshuffleBytes<uint32_t>(src, dst, count, i);
+	}
+
+	static void ShuffleBytes(const uint64_t* src, uint8_t* dst, const size_t count, const size_t begin) {
+		// Interleave the bytes of each pair of values, then transpose the 8x8 matrix of 16-bit words
+		const __m128i mask = _mm_setr_epi8(0, 8, 1, 9, 2, 10, 3, 11, 4, 12, 5, 13, 6, 14, 7, 15);
+		size_t i = begin;
+		for (; i + 16u <= count; i += 16u) {
+			__m128i a[8u];
+			for (size_t j = 0u; j < 8u; ++j) a[j] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + j * 2u)), mask);
+
+			const __m128i t0 = _mm_unpacklo_epi16(a[0u], a[1u]);
+			const __m128i t1 = _mm_unpackhi_epi16(a[0u], a[1u]);
+			const __m128i t2 = _mm_unpacklo_epi16(a[2u], a[3u]);
+			const __m128i t3 = _mm_unpackhi_epi16(a[2u], a[3u]);
+			const __m128i t4 = _mm_unpacklo_epi16(a[4u], a[5u]);
+			const __m128i t5 = _mm_unpackhi_epi16(a[4u], a[5u]);
+			const __m128i t6 = _mm_unpacklo_epi16(a[6u], a[7u]);
+			const __m128i t7 = _mm_unpackhi_epi16(a[6u], a[7u]);
+
+			const __m128i u0 = _mm_unpacklo_epi32(t0, t2);
+			const __m128i u1 = _mm_unpackhi_epi32(t0, t2);
+			const __m128i u2 = _mm_unpacklo_epi32(t1, t3);
+			const __m128i u3 = _mm_unpackhi_epi32(t1, t3);
+			const __m128i u4 = _mm_unpacklo_epi32(t4, t6);
+			const __m128i u5 = _mm_unpackhi_epi32(t4, t6);
+			const __m128i u6 = _mm_unpacklo_epi32(t5, t7);
+			const __m128i u7 = _mm_unpackhi_epi32(t5, t7);
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_unpacklo_epi64(u0, u4));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + count + i), _mm_unpackhi_epi64(u0, u4));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + count * 2u + i), _mm_unpacklo_epi64(u1, u5));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + count * 3u + i), _mm_unpackhi_epi64(u1, u5));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + count * 4u + i), _mm_unpacklo_epi64(u2, u6));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + count * 5u + i), _mm_unpackhi_epi64(u2, u6));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + count * 6u + i), _mm_unpacklo_epi64(u3, u7));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + count * 7u + i), _mm_unpackhi_epi64(u3, u7));
+		}
+		ShuffleBytes<uint64_t>(src, dst, count, i);
+	}
+
+	static void UnshuffleBytes(const uint8_t* src, uint64_t* dst, const size_t count, const size_t begin) {
+		size_t i = begin;
+		for (; i + 16u <= count; i += 16u) {
+			__m128i a[8u];
+			for (size_t j = 0u; j < 8u; ++j) a[j] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + count * j + i));
+
+			// Interleave the byte planes back into whole values
+			const __m128i t0 = _mm_unpacklo_epi8(a[0u], a[1u]);
+			const __m128i t1 = _mm_unpackhi_epi8(a[0u], a[1u]);
+			const __m128i t2 = _mm_unpacklo_epi8(a[2u], a[3u]);
+			const __m128i t3 = _mm_unpackhi_epi8(a[2u], a[3u]);
+			const __m128i t4 = _mm_unpacklo_epi8(a[4u], a[5u]);
+			const __m128i t5 = _mm_unpackhi_epi8(a[4u], a[5u]);
+			const __m128i t6 = _mm_unpacklo_epi8(a[6u], a[7u]);
+			const __m128i t7 = _mm_unpackhi_epi8(a[6u], a[7u]);
+
+			const __m128i u0 = _mm_unpacklo_epi16(t0, t2);
+			const __m128i u1 = _mm_unpackhi_epi16(t0, t2);
+			const __m128i u2 = _mm_unpacklo_epi16(t1, t3);
+			const __m128i u3 = _mm_unpackhi_epi16(t1, t3);
+			const __m128i u4 = _mm_unpacklo_epi16(t4, t6);
+			const __m128i u5 = _mm_unpackhi_epi16(t4, t6);
+			const __m128i u6 = _mm_unpacklo_epi16(t5, t7);
+			const __m128i u7 = _mm_unpackhi_epi16(t5, t7);
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_unpacklo_epi32(u0, u4));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 2u), _mm_unpackhi_epi32(u0, u4));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 4u), _mm_unpacklo_epi32(u1, u5));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 6u), _mm_unpackhi_epi32(u1, u5));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 8u), _mm_unpacklo_epi32(u2, u6));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 10u), _mm_unpackhi_epi32(u2, u6));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 12u), _mm_unpacklo_epi32(u3, u7));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 14u), _mm_unpackhi_epi32(u3, u7));
+		}
+		UnshuffleBytes<uint64_t>(src, dst, count, i);
+	}
+#endif
+
+	// XOR packing, each XOR with the previous value is written as its meaningful bits between the leading and trailing zeros
+
+	static inline uint32_t CountLeadingZeros(const uint64_t value) {
+	#if defined(_MSC_VER)
+		unsigned long index;
+		return _BitScanReverse64(&index, value) ? 63u - index : 64u;
+	#else
+		return value == 0u ? 64u : static_cast<uint32_t>(__builtin_clzll(value));
+	#endif
+	}
+
+	static inline uint32_t CountTrailingZeros(const uint64_t value) {
+	#if defined(_MSC_VER)
+		unsigned long index;
+		return _BitScanForward64(&index, value) ? index : 64u;
+	#else
+		return value == 0u ? 64u : static_cast<uint32_t>(__builtin_ctzll(value));
+	#endif
+	}
+
+	class BitWriter {
+	private:
+		std::vector<uint8_t>& _dst;
+		uint64_t _accumulator;
+		uint32_t _bits;
+	public:
+		BitWriter(std::vector<uint8_t>& dst) :
+			_dst(dst),
+			_accumulator(0u),
+			_bits(0u)
+		{}
+
+		inline void Write(const uint64_t value, const uint32_t bits) {
+			// Write at most 32 bits at a time so that the accumulator cannot overflow
+			if (bits > 32u) {
+				Write(value & UINT32_MAX, 32u);
+				Write(value >> 32u, bits - 32u);
+				return;
+			}
+
+			_accumulator |= (value & ((1ull << bits) - 1ull)) << _bits;
+			_bits += bits;
+			if (_bits >= 32u) {
+				// Append whole words, little endian
+				const uint8_t word[4u] = {
+					static_cast<uint8_t>(_accumulator),
+					static_cast<uint8_t>(_accumulator >> 8u),
+					static_cast<uint8_t>(_accumulator >> 16u),
+					static_cast<uint8_t>(_accumulator >> 24u)
+				};
+				_dst.insert(_dst.end(), word, word + 4u);
+				_accumulator >>= 32u;
+				_bits -= 32u;
+			}
+		}
+
+		inline void Flush() {
+			while (_bits > 0u) {
+				_dst.push_back(static_cast<uint8_t>(_accumulator));
+				_accumulator >>= 8u;
+				_bits = _bits > 8u ? _bits - 8u : 0u;
+			}
+			_accumulator = 0u;
+		}
+	};
+
+	class BitReader {
+	private:
+		const uint8_t* _src;
+		const uint8_t* _end;
+		uint64_t _accumulator;
+		uint32_t _bits;
+	public:
+		BitReader(const uint8_t* src, const uint8_t* end) :
+			_src(src),
+			_end(end),
+			_accumulator(0u),
+			_bits(0u)
+		{}
+
+		inline uint64_t Read(const uint32_t bits) {
+			if (bits > 32u) {
+				const uint64_t low = Read(32u);
+				return low | (Read(bits - 32u) << 32u);
+			}
+
+			while (_bits < bits) {
+				if (_src == _end) throw std::runtime_error("ArrayCodec::Decode : Encoded values are truncated");
+				_accumulator |= static_cast<uint64_t>(*_src++) << _bits;
+				_bits += 8u;
+			}
+
+			const uint64_t value = _accumulator & ((1ull << bits) - 1ull);
+			_accumulator >>= bits;
+			_bits -= bits;
+			return value;
+		}
+	};
+
+	template<class T>
+	class XorPacker {
+	private:
+		enum : uint32_t {
+			BITS = sizeof(T) * 8u,
+			FIELD_BITS = sizeof(T) == 8u ? 6u : 5u	// Bits needed to store a zero count or meaningful length - 1
+		};
+
+		uint32_t _leading;
+		uint32_t _trailing;
+	public:
+		XorPacker() :
+			_leading(BITS),
+			_trailing(0u)
+		{}
+
+		void Pack(const T* values, const size_t count, BitWriter& writer) {
+			for (size_t i = 0u; i < count; ++i) {
+				const T value = values[i];
+				if (value == 0u) {
+					// Same as the previous value
+					writer.Write(0u, 1u);
+					continue;
+				}
+
+				const uint32_t leading = CountLeadingZeros(value) - (64u - BITS);
+				const uint32_t trailing = CountTrailingZeros(value);
+				if (leading >= _leading && trailing >= _trailing) {
+					// Fits within the previous window
+					writer.Write(1u, 2u);
+					writer.Write(value >> _trailing, BITS - _leading - _trailing);
+				} else {
+					// Start a new window
+					_leading = leading;
+					_trailing = trailing;
+					const uint32_t length = BITS - leading - trailing;
+					writer.Write(3u, 2u);
+					writer.Write(leading, FIELD_BITS);
+					writer.Write(length - 1u, FIELD_BITS);
+					writer.Write(value >> trailing, length);
+				}
+			}
+		}
+	};
+
+	template<class T>
+	static void XorUnpack(const uint8_t* src, const uint8_t* end, T* values, const size_t count) {
+		enum : uint32_t {
+			BITS = sizeof(T) * 8u,
+			FIELD_BITS = sizeof(T) == 8u ? 6u : 5u
+		};
+
+		BitReader reader(src, end);
+		uint32_t leading = BITS;
+		uint32_t trailing = 0u;
+		bool window = false;
+
+		for (size_t i = 0u; i < count; ++i) {
+			if (reader.Read(1u) == 0u) {
+				values[i] = 0u;
+				continue;
+			}
+
+			if (reader.Read(1u) == 1u) {
+				leading = static_cast<uint32_t>(reader.Read(FIELD_BITS));
+				const uint32_t length = static_cast<uint32_t>(reader.Read(FIELD_BITS)) + 1u;
+				if (leading + length > BITS) throw std::runtime_error("ArrayCodec::Decode : Invalid XOR window");
+				trailing = BITS - leading - length;
+				window = true;
+			} else if (!window) {
+				throw std::runtime_error("ArrayCodec::Decode : XOR window is used before it is defined");
+			}
+
+			values[i] = static_cast<T>(reader.Read(BITS - leading - trailing) << trailing);
+		}
+	}
+
+	// Byte planes, each is written raw or as run length pairs depending on which is smaller
+
+	enum : uint8_t {
+		PLANE_RAW,
+		PLANE_RUN_LENGTH
+	};
+
+	static void WritePlane(const uint8_t* plane, const size_t count, std::vector<uint8_t>& dst) {
+		// Count the size of the runs first
+		size_t run_bytes = 0u;
+		for (size_t i = 0u; i < count && run_bytes < count;) {
+			size_t j = i + 1u;
+			while (j < count && plane[j] == plane[i] && j - i < UINT32_MAX) ++j;
+			run_bytes += BytePipeFormat::GetVarintSize(static_cast<uint32_t>(j - i)) + 1u;
+			i = j;
+		}
+
+		if (run_bytes >= count) {
+			dst.push_back(PLANE_RAW);
+			dst.insert(dst.end(), plane, plane + count);
+			return;
+		}
+
+		dst.push_back(PLANE_RUN_LENGTH);
+		for (size_t i = 0u; i < count;) {
+			size_t j = i + 1u;
+			while (j < count && plane[j] == plane[i] && j - i < UINT32_MAX) ++j;
+			WriteRun(plane[i], static_cast<uint32_t>(j - i), dst);
+			i = j;
+		}
+	}
+
+	static const uint8_t* ReadPlane(const uint8_t* src, const uint8_t* end, uint8_t* plane, const size_t count) {
+		if (src == end) throw std::runtime_error("ArrayCodec::Decode : Encoded values are truncated");
+		const uint8_t mode = *src++;
+
+		if (mode == PLANE_RAW) {
+			if (static_cast<size_t>(end - src) < count) throw std::runtime_error("ArrayCodec::Decode : Encoded values are truncated");
+			memcpy(plane, src, count);
+			return src + count;
+		}
+
+		if (mode != PLANE_RUN_LENGTH) throw std::runtime_error("ArrayCodec::Decode : Unknown byte plane encoding");
+		size_t i = 0u;
+		while (i < count) {
+			uint32_t length;
+			const size_t varint_size = BytePipeFormat::ReadVarint(src, static_cast<size_t>(end - src), length);
+			if (varint_size + 1u > static_cast<size_t>(end - src)) throw std::runtime_error("ArrayCodec::Decode : Encoded values are truncated");
+			src += varint_size;
+			if (length > count - i) throw std::runtime_error("ArrayCodec::Decode : Run is longer than the array");
+			memset(plane + i, *src++, length);
+			i += length;
+		}
+		return src;
+	}
+
+	template<class T>
+	static size_t EncodeFloats(const uint8_t* src, const size_t count, const uint8_t codec, std::vector<uint8_t>& dst) {
+		const size_t begin = dst.size();
+		dst.reserve(begin + count * sizeof(T) + count / 4u + sizeof(T) * (count / SHUFFLE_BLOCK_SIZE + 1u));
+
+		// Work on one block at a time so that the scratch buffers stay in cache
+		std::vector<T> values(count < SHUFFLE_BLOCK_SIZE ? count : SHUFFLE_BLOCK_SIZE);
+		std::vector<T> raw((codec & BytePipeFormat::CODEC_XOR) ? values.size() : 0u);
+		std::vector<uint8_t> planes((codec & BytePipeFormat::CODEC_BYTE_SHUFFLE) ? sizeof(T) * values.size() : 0u);
+		T previous = 0u;
+		BitWriter writer(dst);
+		XorPacker<T> packer;
+
+		for (size_t i = 0u; i < count; i += SHUFFLE_BLOCK_SIZE) {
+			const size_t block_count = count - i < SHUFFLE_BLOCK_SIZE ? count - i : SHUFFLE_BLOCK_SIZE;
+
+			if (codec & BytePipeFormat::CODEC_XOR) {
+				memcpy(raw.data(), src + sizeof(T) * i, sizeof(T) * block_count);
+				ByteOrder::FromLittleEndian(raw.data(), sizeof(T), block_count);
+				XorEncode(raw.data(), values.data(), block_count, previous);
+				previous = raw[block_count - 1u];
+			} else {
+				memcpy(values.data(), src + sizeof(T) * i, sizeof(T) * block_count);
+				ByteOrder::FromLittleEndian(values.data(), sizeof(T), block_count);
+			}
+
+			if (codec & BytePipeFormat::CODEC_BYTE_SHUFFLE) {
+				// Byte planes are in little-endian order
+				ByteOrder::ToLittleEndian(values.data(), sizeof(T), block_count);
+				ShuffleBytes(values.data(), planes.data(), block_count, 0u);
+				for (size_t j = 0u; j < sizeof(T); ++j) WritePlane(planes.data() + block_count * j, block_count, dst);
+			} else {
+				packer.Pack(values.data(), block_count, writer);
+			}
+		}
+
+		writer.Flush();
+		return dst.size() - begin;
+	}
+
+	template<class T>
+	static void DecodeFloats(const uint8_t* src, const size_t bytes, const size_t count, const uint8_t codec, T* dst) {
+		const uint8_t* const end = src + bytes;
+
+		if (codec & BytePipeFormat::CODEC_BYTE_SHUFFLE) {
+			std::vector<uint8_t> planes(sizeof(T) * (count < SHUFFLE_BLOCK_SIZE ? count : SHUFFLE_BLOCK_SIZE));
+			for (size_t i = 0u; i < count; i += SHUFFLE_BLOCK_SIZE) {
+				const size_t block_count = count - i < SHUFFLE_BLOCK_SIZE ? count - i : SHUFFLE_BLOCK_SIZE;
+				for (size_t j = 0u; j < sizeof(T); ++j) src = ReadPlane(src, end, planes.data() + block_count * j, block_count);
+				UnshuffleBytes(planes.data(), dst + i, block_count, 0u);
+			}
+			ByteOrder::FromLittleEndian(dst, sizeof(T), count);
+		} else {
+			XorUnpack(src, end, dst, count);
+		}
+
+		if (codec & BytePipeFormat::CODEC_XOR) XorDecode(dst, count, static_cast<T>(0u));
+		ByteOrder::ToLittleEndian(dst, sizeof(T), count);
+	}
+
+	// Public interface
+
+	bool IsSupported(const Serialiser::Type type, const uint8_t codec) {
+		enum : uint8_t {
+			INTEGER_CODECS = BytePipeFormat::CODEC_DELTA | BytePipeFormat::CODEC_ZIGZAG | BytePipeFormat::CODEC_BIT_PACK | BytePipeFormat::CODEC_RUN_LENGTH,
+			FLOAT_CODECS = BytePipeFormat::CODEC_XOR | BytePipeFormat::CODEC_BYTE_SHUFFLE
+		};
+
+		if (codec == BytePipeFormat::CODEC_NONE) return true;
+		if (type == Serialiser::TYPE_FLOAT_32 || type == Serialiser::TYPE_FLOAT_64) return (codec & ~FLOAT_CODECS) == 0u;
+		if (type > Serialiser::TYPE_SIGNED_64) return false;
+		if ((codec & BytePipeFormat::CODEC_BIT_PACK) && (codec & BytePipeFormat::CODEC_RUN_LENGTH)) return false;
+		return (codec & ~INTEGER_CODECS) == 0u;
+	}
+
+	size_t Encode(const void* src, const size_t count, const Serialiser::Type type, const uint8_t codec, std::vector<uint8_t>& dst) {
+		if (!IsSupported(type, codec)) throw std::runtime_error("ArrayCodec::Encode : Codec is not supported for this type");
+
+		const uint8_t* const src_bytes = static_cast<const uint8_t*>(src);
+		if (type == Serialiser::TYPE_FLOAT_32) return EncodeFloats<uint32_t>(src_bytes, count, codec, dst);
+		if (type == Serialiser::TYPE_FLOAT_64) return EncodeFloats<uint64_t>(src_bytes, count, codec, dst);
+
+		// Signed values are encoded as unsigned values of the same size
+		switch (BytePipeFormat::GetPrimitiveSize(type)) {
+		case 1u:
+			return EncodeValues<uint8_t>(src_bytes, count, codec, dst);
+		case 2u:
+			return EncodeValues<uint16_t>(src_bytes, count, codec, dst);
+		case 4u:
+			return EncodeValues<uint32_t>(src_bytes, count, codec, dst);
+		default:
+			return EncodeValues<uint64_t>(src_bytes, count, codec, dst);
+		}
+	}
+
+	void Decode(const void* src, const size_t bytes, const size_t count, const Serialiser::Type type, const uint8_t codec, void* dst) {
+		if (!IsSupported(type, codec)) throw std::runtime_error("ArrayCodec::Decode : Codec is not supported for this type");
+
+		const uint8_t* const src_bytes = static_cast<const uint8_t*>(src);
+		if (type == Serialiser::TYPE_FLOAT_32) {
+			DecodeFloats(src_bytes, bytes, count, codec, static_cast<uint32_t*>(dst));
+			return;
+		} else if (type == Serialiser::TYPE_FLOAT_64) {
+			DecodeFloats(src_bytes, bytes, count, codec, static_cast<uint64_t*>(dst));
+			return;
+		}
+
+		switch (BytePipeFormat::GetPrimitiveSize(type)) {
+		case 1u:
+			DecodeValues(src_bytes, bytes, count, codec, static_cast<uint8_t*>(dst));
+			break;
+		case 2u:
+			DecodeValues(src_bytes, bytes, count, codec, static_cast<uint16_t*>(dst));
+			break;
+		case 4u:
+			DecodeValues(src_bytes, bytes, count, codec, static_cast<uint32_t*>(dst));
+			break;
+		default:
+			DecodeValues(src_bytes, bytes, count, codec, static_cast<uint64_t*>(dst));
+			break;
+		}
+	}
+
+}}
@@ -0,0 +1,195 @@
+// MIT License
+// 
+// Copyright(c) 2021 Adam Smith
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include "anvil/serialisation/AsyncPipe.hpp"
+
+namespace anvil {
+
+	// AsyncOutputPipe
+
+	AsyncOutputPipe::AsyncOutputPipe(BytePipe::OutputPipe& downstream, const uint32_t buffer_size, const uint32_t buffer_count) :
+		_downstream(downstream),
+		_head(0u),
+		_tail(0u),
+		_failed(false),
+		_stall_count(0u),
+		_stall_time(0u),
+		_max_queue_depth(0u),
+		_exit(false)
+	{
+		if (buffer_size == 0u) throw std::runtime_error("AsyncOutputPipe::AsyncOutputPipe : Invalid buffer size");
+		if (buffer_count < 2u) throw std::runtime_error("AsyncOutputPipe::AsyncOutputPipe : At least 2 buffers are required");
+
+		_buffers.resize(buffer_count);
+		for (Buffer& buffer : _buffers) {
+			buffer.data.resize(buffer_size);
+			buffer.size = 0u;
+			buffer.flush = false;
+		}
+
+		_thread = std::thread(&AsyncOutputPipe::_ThreadMain, this);
+	}
+
+	AsyncOutputPipe::~AsyncOutputPipe() {
+		try {
+			Flush();
+		} catch (...) {
+			// Destructors must not throw, call Flush first to see errors
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_exit = true;
+		}
+		_work_ready.notify_all();
+		_thread.join();
+	}
+
+	void AsyncOutputPipe::_ThreadMain() {
+		while (true) {
+			const uint64_t head = _head.load(std::memory_order_relaxed);
+
+			// Sleep until a buffer is handed over
+			if (head == _tail.load(std::memory_order_acquire)) {
+				std::unique_lock<std::mutex> lock(_mutex);
+				_work_ready.wait(lock, [this, head]()->bool { return _exit || head != _tail.load(std::memory_order_acquire); });
+				if (head == _tail.load(std::memory_order_acquire)) return;
+			}
+
+			Buffer& buffer = _buffers[head % _buffers.size()];
+			if (!_failed.load(std::memory_order_relaxed)) {
+				try {
+					const uint8_t* data = buffer.data.data();
+					size_t remaining = buffer.size;
+					while (remaining > 0u) {
+						const uint32_t written = _downstream.WriteBytes(data, static_cast<uint32_t>(remaining));
+						if (written == 0u) throw std::runtime_error("AsyncOutputPipe::_ThreadMain : Downstream pipe did not accept the buffer");
+						data += written;
+						remaining -= written;
+					}
+					if (buffer.flush) _downstream.Flush();
+				} catch (...) {
+					// Later buffers are discarded, the writer sees the error on its next call
+					_error = std::current_exception();
+					_failed.store(true, std::memory_order_release);
+				}
+			}
+
+			// Give the buffer back to the writer
+			_head.store(head + 1u, std::memory_order_release);
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+			}
+			_space_ready.notify_one();
+		}
+	}
+
+	void AsyncOutputPipe::_CheckError() {
+		if (_failed.load(std::memory_order_acquire)) std::rethrow_exception(_error);
+	}
+
+	void AsyncOutputPipe::_WaitForSpace() {
+		const uint64_t tail = _tail.load(std::memory_order_relaxed);
+		if (tail - _head.load(std::memory_order_acquire) < _buffers.size()) return;
+
+		const auto start = std::chrono::steady_clock::now();
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_space_ready.wait(lock, [this, tail]()->bool { return tail - _head.load(std::memory_order_acquire) < _buffers.size(); });
+		}
+		++_stall_count;
+		_stall_time += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+	}
+
+	void AsyncOutputPipe::_Submit(const bool flush) {
+		const uint64_t tail = _tail.load(std::memory_order_relaxed);
+		_buffers[tail % _buffers.size()].flush = flush;
+
+		// Hand the buffer to the I/O thread
+		_tail.store(tail + 1u, std::memory_order_release);
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+		}
+		_work_ready.notify_one();
+
+		const uint64_t depth = tail + 1u - _head.load(std::memory_order_acquire);
+		if (depth > _max_queue_depth) _max_queue_depth = depth;
+
+		// Make sure the next buffer is free before it is filled
+		_WaitForSpace();
+		_buffers[(tail + 1u) % _buffers.size()].size = 0u;
+	}
+
+	uint32_t AsyncOutputPipe::GetQueueDepth() const {
+		return static_cast<uint32_t>(_tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire));
+	}
+
+	uint32_t AsyncOutputPipe::GetMaxQueueDepth() const {
+		return static_cast<uint32_t>(_max_queue_depth);
+	}
+
+	uint64_t AsyncOutputPipe::GetStallCount() const {
+		return _stall_count;
+	}
+
+	uint64_t AsyncOutputPipe::GetStallTime() const {
+		return _stall_time;
+	}
+
+	uint32_t AsyncOutputPipe::WriteBytes(const void* src, const uint32_t bytes) {
+		_CheckError();
+
+		const uint8_t* src_bytes = static_cast<const uint8_t*>(src);
+		uint32_t remaining = bytes;
+		while (remaining > 0u) {
+			Buffer& buffer = _buffers[_tail.load(std::memory_order_relaxed) % _buffers.size()];
+			const size_t space = buffer.data.size() - buffer.size;
+			const uint32_t count = remaining < space ? remaining : static_cast<uint32_t>(space);
+			memcpy(buffer.data.data() + buffer.size, src_bytes, count);
+			buffer.size += count;
+			src_bytes += count;
+			remaining -= count;
+
+			if (buffer.size == buffer.data.size()) _Submit(false);
+		}
+
+		return bytes;
+	}
+
+	void AsyncOutputPipe::Flush() {
+		_CheckError();
+
+		// Submit the partial buffer, which also flushes the downstream pipe once everything before it is written
+		const uint64_t tail = _tail.load(std::memory_order_relaxed);
+		_Submit(true);
+
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_space_ready.wait(lock, [this, tail]()->bool { return _head.load(std::memory_order_acquire) > tail; });
+		}
+
+		_CheckError();
+	}
+}
@@ -0,0 +1,331 @@
+// MIT License
+// 
+// Copyright(c) 2021 Adam Smith
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstring>
+#include <stdexcept>
+#include "anvil/serialisation/BlockCompression.hpp"
+#include "anvil/serialisation/ByteOrder.hpp"
+
+#if ANVIL_USE_ZSTD
+	#include <zstd.h>
+#endif
+
+namespace anvil { namespace BlockCompression {
+
+	enum : uint32_t {
+		HASH_BITS = 14u,
+		MIN_MATCH = 4u,
+		MAX_OFFSET = 65535u,
+		SKIP_SHIFT = 6u		//!< Searches step further ahead after every 2^SKIP_SHIFT misses, so incompressible data is passed over quickly
+	};
+
+	static inline uint32_t Read32(const uint8_t* src) {
+		// Little-endian on every host so that checksums and frames match
+		return ByteOrder::LoadLittleEndian32(src);
+	}
+
+	static inline uint32_t RotateLeft(const uint32_t value, const uint32_t bits) {
+		return (value << bits) | (value >> (32u - bits));
+	}
+
+	// Checksum
+
+	uint32_t Checksum(const void* src, const size_t bytes) {
+		enum : uint32_t {
+			PRIME_1 = 2654435761u,
+			PRIME_2 = 2246822519u,
+			PRIME_3 = 3266489917u,
+			PRIME_4 = 668265263u,
+			PRIME_5 = 374761393u
+		};
+
+		const uint8_t* data = static_cast<const uint8_t*>(src);
+		const uint8_t* const end = data + bytes;
+		uint32_t hash;
+
+		if (bytes >= 16u) {
+			// Four independent lanes of 4 bytes
+			uint32_t v1 = PRIME_1 + PRIME_2;
+			uint32_t v2 = PRIME_2;
+			uint32_t v3 = 0u;
+			uint32_t v4 = 0u - PRIME_1;
+			const uint8_t* const limit = end - 16u;
+			do {
+				v1 = RotateLeft(v1 + Read32(data) * PRIME_2, 13u) * PRIME_1;
+				v2 = RotateLeft(v2 + Read32(data + 4u) * PRIME_2, 13u) * PRIME_1;
+				v3 = RotateLeft(v3 + Read32(data + 8u) * PRIME_2, 13u) * PRIME_1;
+				v4 = RotateLeft(v4 + Read32(data + 12u) * PRIME_2, 13u) * PRIME_1;
+				data += 16u;
+			} while (data <= limit);
+			hash = RotateLeft(v1, 1u) + RotateLeft(v2, 7u) + RotateLeft(v3, 12u) + RotateLeft(v4, 18u);
+		} else {
+			hash = PRIME_5;
+		}
+
+		hash += static_cast<uint32_t>(bytes);
+
+		while (data + 4u <= end) {
+			hash = RotateLeft(hash + Read32(data) * PRIME_3, 17u) * PRIME_4;
+			data += 4u;
+		}
+
+		while (data < end) {
+			hash = RotateLeft(hash + *data * PRIME_5, 11u) * PRIME_1;
+			++data;
+		}
+
+		hash ^= hash >> 15u;
+		hash *= PRIME_2;
+		hash ^= hash >> 13u;
+		hash *= PRIME_3;
+		hash ^= hash >> 16u;
+		return hash;
+	}
+
+	// LZ compression
+
+	static inline uint8_t* WriteCount(uint8_t* dst, size_t count) {
+		while (count >= 255u) {
+			*dst++ = 255u;
+			count -= 255u;
+		}
+		*dst++ = static_cast<uint8_t>(count);
+		return dst;
+	}
+
+	static uint8_t* WriteSequence(uint8_t* dst, const uint8_t* literals, const size_t literal_count, const uint32_t offset, const size_t match_length) {
+		uint8_t* const token = dst++;
+
+		*token = static_cast<uint8_t>((literal_count < 15u ? literal_count : 15u) << 4u);
+		if (literal_count >= 15u) dst = WriteCount(dst, literal_count - 15u);
+		memcpy(dst, literals, literal_count);
+		dst += literal_count;
+
+		// The last sequence only has literals
+		if (match_length == 0u) return dst;
+
+		const uint16_t offset16 = ByteOrder::ToLittleEndian(static_cast<uint16_t>(offset));
+		memcpy(dst, &offset16, sizeof(offset16));
+		dst += sizeof(offset16);
+
+		const size_t length = match_length - MIN_MATCH;
+		*token |= static_cast<uint8_t>(length < 15u ? length : 15u);
+		if (length >= 15u) dst = WriteCount(dst, length - 15u);
+		return dst;
+	}
+
+	static size_t CompressLZ(const uint8_t* src, const size_t bytes, uint8_t* dst) {
+		uint32_t table[1u << HASH_BITS];
+		memset(table, 0, sizeof(table));
+
+		const uint8_t* const end = src + bytes;
+		const uint8_t* ip = src;
+		const uint8_t* anchor = src;
+		uint8_t* op = dst;
+		uint32_t misses = 0u;
+
+		if (bytes >= MIN_MATCH) {
+			const uint8_t* const limit = end - MIN_MATCH;
+			while (ip <= limit) {
+				const uint32_t sequence = Read32(ip);
+				const uint32_t hash = (sequence * 2654435761u) >> (32u - HASH_BITS);
+				const uint8_t* const ref = src + table[hash];
+				table[hash] = static_cast<uint32_t>(ip - src);
+
+				if (ref < ip && static_cast<size_t>(ip - ref) <= MAX_OFFSET && Read32(ref) == sequence) {
+					// Extend the match as far as it goes
+					const uint8_t* match_end = ip + MIN_MATCH;
+					const uint8_t* ref_end = ref + MIN_MATCH;
+					while (match_end < end && *match_end == *ref_end) {
+						++match_end;
+						++ref_end;
+					}
+
+					op = WriteSequence(op, anchor, static_cast<size_t>(ip - anchor), static_cast<uint32_t>(ip - ref), static_cast<size_t>(match_end - ip));
+					ip = match_end;
+					anchor = ip;
+					misses = 0u;
+				} else {
+					ip += 1u + (misses++ >> SKIP_SHIFT);
+				}
+			}
+		}
+
+		op = WriteSequence(op, anchor, static_cast<size_t>(end - anchor), 0u, 0u);
+		return static_cast<size_t>(op - dst);
+	}
+
+	static void DecompressLZ(const uint8_t* src, const size_t bytes, uint8_t* dst, const size_t raw_size) {
+		const uint8_t* const end = src + bytes;
+		uint8_t* op = dst;
+		uint8_t* const op_end = dst + raw_size;
+
+		auto ReadCount = [&src, end](size_t count)->size_t {
+			if (count < 15u) return count;
+			uint8_t value;
+			do {
+				if (src == end) throw std::runtime_error("BlockCompression::ReadFramePayload : Compressed block is truncated");
+				value = *src++;
+				count += value;
+			} while (value == 255u);
+			return count;
+		};
+
+		while (true) {
+			if (src == end) throw std::runtime_error("BlockCompression::ReadFramePayload : Compressed block is truncated");
+			const uint8_t token = *src++;
+
+			const size_t literal_count = ReadCount(token >> 4u);
+			if (static_cast<size_t>(end - src) < literal_count || static_cast<size_t>(op_end - op) < literal_count) throw std::runtime_error("BlockCompression::ReadFramePayload : Literals overrun the block");
+			memcpy(op, src, literal_count);
+			op += literal_count;
+			src += literal_count;
+
+			if (src == end) break;
+
+			if (end - src < 2) throw std::runtime_error("BlockCompression::ReadFramePayload : Compressed block is truncated");
+			uint16_t offset;
+			memcpy(&offset, src, sizeof(offset));
+			offset = ByteOrder::FromLittleEndian(offset);
+			src += sizeof(offset);
+			if (offset == 0u || offset > op - dst) throw std::runtime_error("BlockCompression::ReadFramePayload : Match offset is out of range");
+
+			const size_t match_length = ReadCount(token & 15u) + MIN_MATCH;
+			if (static_cast<size_t>(op_end - op) < match_length) throw std::runtime_error("BlockCompression::ReadFramePayload : Match overruns the block");
+
+			const uint8_t* ref = op - offset;
+			if (offset >= match_length) {
+				memcpy(op, ref, match_length);
+				op += match_length;
+			} else {
+				// Overlapping matches repeat the bytes that were just written
+				for (size_t i = 0u; i < match_length; ++i) *op++ = *ref++;
+			}
+		}
+
+		if (op != op_end) throw std::runtime_error("BlockCompression::ReadFramePayload : Block size does not match");
+	}
+
+	// Frames
+
+	bool IsAvailable(const Codec codec) {
+		switch (codec) {
+		case COMPRESSION_NONE:
+		case COMPRESSION_LZ:
+			return true;
+		case COMPRESSION_ZSTD:
+#if ANVIL_USE_ZSTD
+			return true;
+#else
+			return false;
+#endif
+		default:
+			return false;
+		}
+	}
+
+	size_t WriteFrame(const void* src, const size_t bytes, const Codec codec, std::vector<uint8_t>& dst) {
+		if (bytes > MAX_BLOCK_SIZE) throw std::runtime_error("BlockCompression::WriteFrame : Block is too large");
+		if (!IsAvailable(codec)) throw std::runtime_error("BlockCompression::WriteFrame : Codec is not available");
+
+		const uint8_t* const src_bytes = static_cast<const uint8_t*>(src);
+		const size_t begin = dst.size();
+
+		// Reserve space for the worst case of the codec
+		size_t bound = bytes;
+		if (codec == COMPRESSION_LZ) bound = bytes + bytes / 255u + 16u;
+#if ANVIL_USE_ZSTD
+		if (codec == COMPRESSION_ZSTD) bound = ZSTD_compressBound(bytes);
+#endif
+		dst.resize(begin + FRAME_HEADER_SIZE + bound);
+		uint8_t* const payload = dst.data() + begin + FRAME_HEADER_SIZE;
+
+		Codec stored_codec = codec;
+		size_t stored_size = bytes;
+		if (codec == COMPRESSION_LZ) {
+			stored_size = CompressLZ(src_bytes, bytes, payload);
+		}
+#if ANVIL_USE_ZSTD
+		else if (codec == COMPRESSION_ZSTD) {
+			stored_size = ZSTD_compress(payload, bound, src_bytes, bytes, ZSTD_CLEVEL_DEFAULT);
+			if (ZSTD_isError(stored_size)) throw std::runtime_error("BlockCompression::WriteFrame : Zstandard compression failed");
+		}
+#endif
+
+		if (stored_size >= bytes) {
+			// Compression did not help
+			stored_codec = COMPRESSION_NONE;
+			stored_size = bytes;
+			if (bytes > 0u) memcpy(payload, src_bytes, bytes);
+		}
+
+		// Write the header
+		uint8_t* const header = dst.data() + begin;
+		const uint32_t raw_size32 = static_cast<uint32_t>(bytes);
+		const uint32_t stored_size32 = static_cast<uint32_t>(stored_size);
+		const uint32_t checksum = Checksum(src_bytes, bytes);
+		header[0u] = stored_codec;
+		ByteOrder::StoreLittleEndian32(header + 1u, raw_size32);
+		ByteOrder::StoreLittleEndian32(header + 5u, stored_size32);
+		ByteOrder::StoreLittleEndian32(header + 9u, checksum);
+
+		dst.resize(begin + FRAME_HEADER_SIZE + stored_size);
+		return FRAME_HEADER_SIZE + stored_size;
+	}
+
+	void ReadFrameHeader(const uint8_t* header, Codec& codec, uint32_t& raw_size, uint32_t& stored_size, uint32_t& checksum) {
+		codec = static_cast<Codec>(header[0u]);
+		raw_size = ByteOrder::LoadLittleEndian32(header + 1u);
+		stored_size = ByteOrder::LoadLittleEndian32(header + 5u);
+		checksum = ByteOrder::LoadLittleEndian32(header + 9u);
+
+		if (!IsAvailable(codec)) throw std::runtime_error("BlockCompression::ReadFrameHeader : Codec is not available");
+		if (raw_size > MAX_BLOCK_SIZE || stored_size > MAX_BLOCK_SIZE + MAX_BLOCK_SIZE / 255u + 16u) throw std::runtime_error("BlockCompression::ReadFrameHeader : Block is too large");
+		if (codec == COMPRESSION_NONE && stored_size != raw_size) throw std::runtime_error("BlockCompression::ReadFrameHeader : Stored block size does not match");
+	}
+
+	void ReadFramePayload(const uint8_t* payload, const Codec codec, const uint32_t raw_size, const uint32_t stored_size, const uint32_t checksum, void* dst) {
+		uint8_t* const dst_bytes = static_cast<uint8_t*>(dst);
+
+		switch (codec) {
+		case COMPRESSION_NONE:
+			if (raw_size > 0u) memcpy(dst_bytes, payload, raw_size);
+			break;
+		case COMPRESSION_LZ:
+			DecompressLZ(payload, stored_size, dst_bytes, raw_size);
+			break;
+#if ANVIL_USE_ZSTD
+		case COMPRESSION_ZSTD:
+			{
+				const size_t size = ZSTD_decompress(dst_bytes, raw_size, payload, stored_size);
+				if (ZSTD_isError(size) || size != raw_size) throw std::runtime_error("BlockCompression::ReadFramePayload : Zstandard decompression failed");
+			}
+			break;
+#endif
+		default:
+			throw std::runtime_error("BlockCompression::ReadFramePayload : Codec is not available");
+		}
+
+		if (Checksum(dst_bytes, raw_size) != checksum) throw std::runtime_error("BlockCompression::ReadFramePayload : Checksum does not match");
+	}
+
+}}
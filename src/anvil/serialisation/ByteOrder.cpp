@@ -0,0 +1,57 @@
+// MIT License
+// 
+// Copyright(c) 2021 Adam Smith
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <stdexcept>
+#include "anvil/serialisation/ByteOrder.hpp"
+
+namespace anvil { namespace ByteOrder {
+
+	// Values are only swapped on big-endian hosts, none of which are x86, so this is a plain loop for the compiler to vectorise
+	template<class T>
+	static void SwapValues(uint8_t* values, const size_t count) {
+		for (size_t i = 0u; i < count; ++i) {
+			T value;
+			memcpy(&value, values + sizeof(T) * i, sizeof(T));
+			value = Swap(value);
+			memcpy(values + sizeof(T) * i, &value, sizeof(T));
+		}
+	}
+
+	void SwapArray(void* values, const size_t size, const size_t count) {
+		uint8_t* const bytes = static_cast<uint8_t*>(values);
+		switch (size) {
+		case 1u:
+			break;
+		case 2u:
+			SwapValues<uint16_t>(bytes, count);
+			break;
+		case 4u:
+			SwapValues<uint32_t>(bytes, count);
+			break;
+		case 8u:
+			SwapValues<uint64_t>(bytes, count);
+			break;
+		default:
+			throw std::runtime_error("ByteOrder::SwapArray : Values must be 1, 2, 4 or 8 bytes");
+		}
+	}
+}}
@@ -0,0 +1,676 @@
+// MIT License
+// 
+// Copyright(c) 2021 Adam Smith
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstring>
+#include <stdexcept>
+#include "anvil/serialisation/ArrayCodec.hpp"
+#include "anvil/serialisation/BytePipeDeserialiser.hpp"
+
+namespace anvil {
+
+	// BytePipeDeserialiser
+
+	BytePipeDeserialiser::BytePipeDeserialiser(BytePipe::InputPipe& pipe, const size_t window_size) :
+		_pipe(pipe),
+		_window(window_size < 64u ? 64u : window_size),
+		_window_begin(0u),
+		_window_end(0u),
+		_value_compact(false),
+		_decoded_begin(0u)
+	{}
+
+	BytePipeDeserialiser::~BytePipeDeserialiser() {
+
+	}
+
+	void BytePipeDeserialiser::_Compact() {
+		// Move the unread bytes to the start of the window
+		const size_t available = _window_end - _window_begin;
+		if (_window_begin > 0u) {
+			memmove(_window.data(), _window.data() + _window_begin, available);
+			_window_begin = 0u;
+			_window_end = available;
+		}
+	}
+
+	void BytePipeDeserialiser::_Fill(const size_t bytes) {
+		size_t available = _window_end - _window_begin;
+		if (available >= bytes) return;
+		if (bytes > _window.size()) throw std::runtime_error("BytePipeDeserialiser::_Fill : Read is larger than the window");
+
+		_Compact();
+
+		// Read until there are enough bytes
+		while (available < bytes) {
+			const uint32_t read = _pipe.ReadBytes(_window.data() + _window_end, static_cast<uint32_t>(_window.size() - _window_end));
+			if (read == 0u) throw std::runtime_error("BytePipeDeserialiser::_Fill : Unexpected end of input");
+			_window_end += read;
+			available += read;
+		}
+	}
+
+	void BytePipeDeserialiser::_ReadBytes(void* dst, const size_t bytes) {
+		uint8_t* dst_bytes = static_cast<uint8_t*>(dst);
+		size_t remaining = bytes;
+
+		// Copy what is already in the window
+		size_t available = _window_end - _window_begin;
+		if (available > remaining) available = remaining;
+		if (available > 0u) {
+			memcpy(dst_bytes, _window.data() + _window_begin, available);
+			_window_begin += available;
+			dst_bytes += available;
+			remaining -= available;
+		}
+
+		if (remaining == 0u) return;
+
+		if (remaining >= _window.size() / 2u) {
+			// Large reads go straight into the destination
+			while (remaining > 0u) {
+				const uint32_t chunk = remaining > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(remaining);
+				const uint32_t read = _pipe.ReadBytes(dst_bytes, chunk);
+				if (read == 0u) throw std::runtime_error("BytePipeDeserialiser::_ReadBytes : Unexpected end of input");
+				dst_bytes += read;
+				remaining -= read;
+			}
+		} else {
+			// Small reads are buffered
+			_Fill(remaining);
+			memcpy(dst_bytes, _window.data() + _window_begin, remaining);
+			_window_begin += remaining;
+		}
+	}
+
+	void BytePipeDeserialiser::_SkipBytes(size_t bytes) {
+		while (bytes > 0u) {
+			size_t available = _window_end - _window_begin;
+			if (available == 0u) {
+				_Fill(bytes < _window.size() ? bytes : _window.size());
+				available = _window_end - _window_begin;
+			}
+
+			const size_t skipped = available < bytes ? available : bytes;
+			_window_begin += skipped;
+			bytes -= skipped;
+		}
+	}
+
+	uint32_t BytePipeDeserialiser::_ReadLength(const bool compact) {
+		uint32_t length = 0u;
+		size_t bytes = BytePipeFormat::ReadLength(_window.data() + _window_begin, _window_end - _window_begin, compact, length);
+		while (bytes > _window_end - _window_begin) {
+			_Fill(bytes);
+			bytes = BytePipeFormat::ReadLength(_window.data() + _window_begin, _window_end - _window_begin, compact, length);
+		}
+		_window_begin += bytes;
+		return length;
+	}
+
+	void BytePipeDeserialiser::_ReadString(std::string& dst, const bool compact) {
+		const uint32_t length = _ReadLength(compact);
+		dst.resize(length);
+		if (length > 0u) _ReadBytes(&dst[0], length);
+	}
+
+	void BytePipeDeserialiser::_ReadName() {
+		State& state = _states.back();
+		if (state.name_read) return;
+		if (state.remaining == 0u) throw std::runtime_error("BytePipeDeserialiser::GetNextMemberName : No members remaining in object");
+
+		if (state.interned) {
+			const uint32_t id = _ReadLength(state.compact);
+			if (id == 0u) {
+				// A new name, which is assigned the next ID
+				_ReadString(_name_buffer, state.compact);
+				if (_names.size() < BytePipeFormat::MAX_INTERNED_NAMES) _names.push_back(_name_buffer);
+			} else {
+				if (id > _names.size()) throw std::runtime_error("BytePipeDeserialiser::GetNextMemberName : Unknown member name ID");
+				_name_buffer = _names[id - 1u];
+			}
+		} else {
+			_ReadString(_name_buffer, state.compact);
+		}
+
+		state.name_read = true;
+	}
+
+	void BytePipeDeserialiser::_PeekContainerHeader(BytePipeFormat::ContainerInfo& info) {
+		size_t bytes = BytePipeFormat::ReadContainerHeader(_window.data() + _window_begin, _window_end - _window_begin, info);
+		while (bytes > _window_end - _window_begin) {
+			_Fill(bytes);
+			bytes = BytePipeFormat::ReadContainerHeader(_window.data() + _window_begin, _window_end - _window_begin, info);
+		}
+	}
+
+	uint8_t BytePipeDeserialiser::_PeekByte() {
+		_Fill(1u);
+		return _window[_window_begin];
+	}
+
+	BytePipeDeserialiser::Type BytePipeDeserialiser::_PeekType() {
+		return BytePipeFormat::GetType(_PeekByte());
+	}
+
+	void BytePipeDeserialiser::_BeginValue(const Type type, const uint32_t count) {
+		if (!_states.empty()) {
+			State& state = _states.back();
+			if (state.type == Serialiser::TYPE_ARRAY) {
+				if (state.remaining == 0u && state.chunked) _ReadSegment(state, false);
+				if (state.sub_type != type) throw std::runtime_error("BytePipeDeserialiser::_BeginValue : Type of value does not match the array");
+				if (state.remaining < count) throw std::runtime_error("BytePipeDeserialiser::_BeginValue : Not enough values remaining in array");
+				state.remaining -= count;
+
+				// Array values are not prefixed with their type
+				_value_compact = state.compact;
+				return;
+			} else {
+				if (count != 1u) throw std::runtime_error("BytePipeDeserialiser::_BeginValue : Current value is not an array");
+				_ReadName();
+				state.name_read = false;
+				--state.remaining;
+			}
+		} else if (count != 1u) {
+			throw std::runtime_error("BytePipeDeserialiser::_BeginValue : Current value is not an array");
+		}
+
+		const uint8_t type_byte = _PeekByte();
+		if (BytePipeFormat::GetType(type_byte) != type) throw std::runtime_error("BytePipeDeserialiser::_BeginValue : Type of value does not match");
+		_value_compact = (type_byte & BytePipeFormat::FLAG_COMPACT) != 0u;
+
+		// Containers begin with their type in the header, other values are prefixed with it
+		if (type != Serialiser::TYPE_ARRAY && type != Serialiser::TYPE_OBJECT) ++_window_begin;
+	}
+
+	void BytePipeDeserialiser::ReadBytes(void* dst, const size_t bytes, const Type type, const uint32_t count) {
+		if (count > 1u && !_states.empty() && _states.back().chunked && _states.back().remaining < count) {
+			// The values span several segments of a chunked array
+			const size_t size = bytes / count;
+			uint8_t* dst_bytes = static_cast<uint8_t*>(dst);
+			uint32_t remaining = count;
+			while (remaining > 0u) {
+				const uint32_t available = GetRemainingCount();
+				if (available == 0u) throw std::runtime_error("BytePipeDeserialiser::_BeginValue : Not enough values remaining in array");
+				const uint32_t values = remaining < available ? remaining : available;
+				ReadBytes(dst_bytes, size * values, type, values);
+				dst_bytes += size * values;
+				remaining -= values;
+			}
+			return;
+		}
+
+		_BeginValue(type, count);
+		if (!_states.empty() && _states.back().decoded) {
+			memcpy(dst, _decoded.data() + _decoded_begin, bytes);
+			_decoded_begin += bytes;
+		} else {
+			_ReadBytes(dst, bytes);
+		}
+		ByteOrder::FromLittleEndian(dst, BytePipeFormat::GetPrimitiveSize(type), count);
+	}
+
+	void BytePipeDeserialiser::BeginDocument() {
+		if (!_states.empty()) throw std::runtime_error("BytePipeDeserialiser::BeginDocument : A container is open");
+		_names.clear();
+	}
+
+	BytePipeDeserialiser::Type BytePipeDeserialiser::GetNextType() {
+		if (_states.empty()) return _PeekType();
+
+		State& state = _states.back();
+		if (state.type == Serialiser::TYPE_ARRAY) {
+			if (state.remaining == 0u && state.chunked) _ReadSegment(state, false);
+			if (state.remaining == 0u) throw std::runtime_error("BytePipeDeserialiser::GetNextType : No values remaining in array");
+			return state.sub_type;
+		} else {
+			_ReadName();
+			return _PeekType();
+		}
+	}
+
+	const std::string& BytePipeDeserialiser::GetNextMemberName() {
+		if (_states.empty() || _states.back().type != Serialiser::TYPE_OBJECT) throw std::runtime_error("BytePipeDeserialiser::GetNextMemberName : Current value is not an object");
+		_ReadName();
+		return _name_buffer;
+	}
+
+	uint32_t BytePipeDeserialiser::GetRemainingCount() {
+		if (_states.empty()) return 0u;
+
+		State& state = _states.back();
+		if (state.remaining == 0u && state.chunked) _ReadSegment(state, false);
+		return state.remaining;
+	}
+
+	uint8_t BytePipeDeserialiser::ReadValueU8() {
+		uint8_t value;
+		ReadBytes(&value, sizeof(value), Serialiser::TYPE_UNSIGNED_8, 1u);
+		return value;
+	}
+
+	uint16_t BytePipeDeserialiser::ReadValueU16() {
+		uint16_t value;
+		ReadBytes(&value, sizeof(value), Serialiser::TYPE_UNSIGNED_16, 1u);
+		return value;
+	}
+
+	uint32_t BytePipeDeserialiser::ReadValueU32() {
+		uint32_t value;
+		ReadBytes(&value, sizeof(value), Serialiser::TYPE_UNSIGNED_32, 1u);
+		return value;
+	}
+
+	uint64_t BytePipeDeserialiser::ReadValueU64() {
+		uint64_t value;
+		ReadBytes(&value, sizeof(value), Serialiser::TYPE_UNSIGNED_64, 1u);
+		return value;
+	}
+
+	int8_t BytePipeDeserialiser::ReadValueS8() {
+		int8_t value;
+		ReadBytes(&value, sizeof(value), Serialiser::TYPE_SIGNED_8, 1u);
+		return value;
+	}
+
+	int16_t BytePipeDeserialiser::ReadValueS16() {
+		int16_t value;
+		ReadBytes(&value, sizeof(value), Serialiser::TYPE_SIGNED_16, 1u);
+		return value;
+	}
+
+	int32_t BytePipeDeserialiser::ReadValueS32() {
+		int32_t value;
+		ReadBytes(&value, sizeof(value), Serialiser::TYPE_SIGNED_32, 1u);
+		return value;
+	}
+
+	int64_t BytePipeDeserialiser::ReadValueS64() {
+		int64_t value;
+		ReadBytes(&value, sizeof(value), Serialiser::TYPE_SIGNED_64, 1u);
+		return value;
+	}
+
+	float BytePipeDeserialiser::ReadValueF32() {
+		float value;
+		ReadBytes(&value, sizeof(value), Serialiser::TYPE_FLOAT_32, 1u);
+		return value;
+	}
+
+	double BytePipeDeserialiser::ReadValueF64() {
+		double value;
+		ReadBytes(&value, sizeof(value), Serialiser::TYPE_FLOAT_64, 1u);
+		return value;
+	}
+
+	std::string BytePipeDeserialiser::ReadValueString() {
+		std::string value;
+		ReadValueString(value);
+		return value;
+	}
+
+	void BytePipeDeserialiser::ReadValueString(std::string& value) {
+		_BeginValue(Serialiser::TYPE_STRING, 1u);
+		_ReadString(value, _value_compact);
+	}
+
+	void BytePipeDeserialiser::_DecodeArray(const BytePipeFormat::ContainerInfo& header) {
+		const size_t bytes = BytePipeFormat::GetPrimitiveSize(header.sub_type) * header.length;
+		if (!BytePipeFormat::IsPrimitiveType(header.sub_type)) throw std::runtime_error("BytePipeDeserialiser::StartArray : Encoded array does not contain primitive values");
+
+		_encoded.resize(header.encoded_size);
+		if (header.encoded_size > 0u) _ReadBytes(_encoded.data(), header.encoded_size);
+
+		_decoded.resize(bytes);
+		if (bytes > 0u) ArrayCodec::Decode(_encoded.data(), _encoded.size(), header.length, header.sub_type, header.codec, _decoded.data());
+		_decoded_begin = 0u;
+	}
+
+	void BytePipeDeserialiser::_ReadSegment(State& state, const bool first) {
+		_Fill(sizeof(uint32_t));
+		uint32_t length = 0u;
+		Type segment_type = state.sub_type;
+		size_t header_size = BytePipeFormat::ReadSegmentHeader(_window.data() + _window_begin, _window_end - _window_begin, length, segment_type);
+		while (header_size > _window_end - _window_begin) {
+			_Fill(header_size);
+			header_size = BytePipeFormat::ReadSegmentHeader(_window.data() + _window_begin, _window_end - _window_begin, length, segment_type);
+		}
+		_window_begin += header_size;
+
+		// A segment without values ends the array
+		if (length == 0u) {
+			state.chunked = false;
+			return;
+		}
+
+		if (first) {
+			state.sub_type = segment_type;
+		} else if (segment_type != state.sub_type) {
+			throw std::runtime_error("BytePipeDeserialiser::_ReadSegment : Segment type does not match the array");
+		}
+		state.remaining = length;
+	}
+
+	uint32_t BytePipeDeserialiser::StartArray(Type& sub_type) {
+		_BeginValue(Serialiser::TYPE_ARRAY, 1u);
+
+		BytePipeFormat::ContainerInfo header;
+		_PeekContainerHeader(header);
+		_window_begin += header.header_size;
+
+		State state;
+		state.type = Serialiser::TYPE_ARRAY;
+		state.sub_type = header.sub_type;
+		state.name_read = false;
+		state.compact = (header.flags & BytePipeFormat::FLAG_COMPACT) != 0u;
+		state.interned = false;
+		state.decoded = header.codec != BytePipeFormat::CODEC_NONE;
+		state.chunked = (header.flags & BytePipeFormat::FLAG_CHUNKED) != 0u;
+		state.remaining = header.length;
+		state.index_bytes = 0u;
+		if ((header.flags & BytePipeFormat::FLAG_INDEXED) && !BytePipeFormat::IsPrimitiveType(header.sub_type)) state.index_bytes = sizeof(uint32_t) * header.length;
+
+		// Encoded values are decoded up front, arrays that were not worth encoding are read as they are
+		if (state.decoded) _DecodeArray(header);
+
+		// The type of a chunked array is in the header of its first segment
+		if (state.chunked) _ReadSegment(state, true);
+
+		_states.push_back(state);
+
+		sub_type = state.sub_type;
+		return state.remaining;
+	}
+
+	uint32_t BytePipeDeserialiser::StartArray() {
+		Type sub_type;
+		return StartArray(sub_type);
+	}
+
+	void BytePipeDeserialiser::EndArray() {
+		// Check value is an array
+		if (_states.empty() || _states.back().type != Serialiser::TYPE_ARRAY) throw std::runtime_error("BytePipeDeserialiser::EndArray : Current value is not an array");
+
+		// Skip values that were not read
+		State& state = _states.back();
+		if (state.decoded) {
+			state.remaining = 0u;
+		} else if (BytePipeFormat::IsPrimitiveType(state.sub_type)) {
+			// Chunked arrays are skipped one segment at a time
+			const size_t size = BytePipeFormat::GetPrimitiveSize(state.sub_type);
+			while (GetRemainingCount() > 0u) {
+				_SkipBytes(size * state.remaining);
+				state.remaining = 0u;
+			}
+		} else {
+			while (GetRemainingCount() > 0u) SkipValue();
+		}
+
+		_SkipBytes(_states.back().index_bytes);
+		_states.pop_back();
+	}
+
+	uint32_t BytePipeDeserialiser::StartObject() {
+		_BeginValue(Serialiser::TYPE_OBJECT, 1u);
+
+		BytePipeFormat::ContainerInfo header;
+		_PeekContainerHeader(header);
+		_window_begin += header.header_size;
+
+		State state;
+		state.type = Serialiser::TYPE_OBJECT;
+		state.sub_type = Serialiser::TYPE_UNSIGNED_8;
+		state.name_read = false;
+		state.compact = (header.flags & BytePipeFormat::FLAG_COMPACT) != 0u;
+		state.interned = (header.flags & BytePipeFormat::FLAG_INTERNED) != 0u;
+		state.decoded = false;
+		state.chunked = false;
+		state.remaining = header.length;
+		state.index_bytes = 0u;
+		if (header.flags & BytePipeFormat::FLAG_INDEXED) state.index_bytes = sizeof(BytePipeFormat::IndexEntry) * header.length;
+
+		_states.push_back(state);
+
+		return header.length;
+	}
+
+	void BytePipeDeserialiser::EndObject() {
+		// Check value is an object
+		if (_states.empty() || _states.back().type != Serialiser::TYPE_OBJECT) throw std::runtime_error("BytePipeDeserialiser::EndObject : Current value is not an object");
+
+		// Skip members that were not read
+		while (_states.back().remaining > 0u) SkipValue();
+
+		_SkipBytes(_states.back().index_bytes);
+		_states.pop_back();
+	}
+
+	void BytePipeDeserialiser::ReadValueU8(uint8_t* value, const size_t count) {
+		ReadBytes(value, sizeof(uint8_t) * count, Serialiser::TYPE_UNSIGNED_8, static_cast<uint32_t>(count));
+	}
+
+	void BytePipeDeserialiser::ReadValueU16(uint16_t* value, const size_t count) {
+		ReadBytes(value, sizeof(uint16_t) * count, Serialiser::TYPE_UNSIGNED_16, static_cast<uint32_t>(count));
+	}
+
+	void BytePipeDeserialiser::ReadValueU32(uint32_t* value, const size_t count) {
+		ReadBytes(value, sizeof(uint32_t) * count, Serialiser::TYPE_UNSIGNED_32, static_cast<uint32_t>(count));
+	}
+
+	void BytePipeDeserialiser::ReadValueU64(uint64_t* value, const size_t count) {
+		ReadBytes(value, sizeof(uint64_t) * count, Serialiser::TYPE_UNSIGNED_64, static_cast<uint32_t>(count));
+	}
+
+	void BytePipeDeserialiser::ReadValueS8(int8_t* value, const size_t count) {
+		ReadBytes(value, sizeof(int8_t) * count, Serialiser::TYPE_SIGNED_8, static_cast<uint32_t>(count));
+	}
+
+	void BytePipeDeserialiser::ReadValueS16(int16_t* value, const size_t count) {
+		ReadBytes(value, sizeof(int16_t) * count, Serialiser::TYPE_SIGNED_16, static_cast<uint32_t>(count));
+	}
+
+	void BytePipeDeserialiser::ReadValueS32(int32_t* value, const size_t count) {
+		ReadBytes(value, sizeof(int32_t) * count, Serialiser::TYPE_SIGNED_32, static_cast<uint32_t>(count));
+	}
+
+	void BytePipeDeserialiser::ReadValueS64(int64_t* value, const size_t count) {
+		ReadBytes(value, sizeof(int64_t) * count, Serialiser::TYPE_SIGNED_64, static_cast<uint32_t>(count));
+	}
+
+	void BytePipeDeserialiser::ReadValueF32(float* value, const size_t count) {
+		ReadBytes(value, sizeof(float) * count, Serialiser::TYPE_FLOAT_32, static_cast<uint32_t>(count));
+	}
+
+	void BytePipeDeserialiser::ReadValueF64(double* value, const size_t count) {
+		ReadBytes(value, sizeof(double) * count, Serialiser::TYPE_FLOAT_64, static_cast<uint32_t>(count));
+	}
+
+	void BytePipeDeserialiser::SkipValue() {
+		const Type type = GetNextType();
+		switch (type) {
+		case Serialiser::TYPE_STRING:
+			{
+				_BeginValue(type, 1u);
+				_SkipBytes(_ReadLength(_value_compact));
+			}
+			break;
+		case Serialiser::TYPE_ARRAY:
+		case Serialiser::TYPE_OBJECT:
+			if (type == Serialiser::TYPE_ARRAY && (_PeekByte() & BytePipeFormat::FLAG_ENCODED)) {
+				// Encoded arrays only contain primitive values so can be skipped without decoding them
+				_BeginValue(type, 1u);
+				BytePipeFormat::ContainerInfo header;
+				_PeekContainerHeader(header);
+				_SkipBytes(header.header_size + header.encoded_size);
+			} else if (_PeekByte() & BytePipeFormat::FLAG_INDEXED) {
+				// Indexed containers can be skipped without reading their contents
+				_BeginValue(type, 1u);
+				BytePipeFormat::ContainerInfo header;
+				_PeekContainerHeader(header);
+				_SkipBytes(header.size);
+			} else if (type == Serialiser::TYPE_ARRAY) {
+				StartArray();
+				EndArray();
+			} else {
+				StartObject();
+				EndObject();
+			}
+			break;
+		default:
+			if (!BytePipeFormat::IsPrimitiveType(type)) throw std::runtime_error("BytePipeDeserialiser::SkipValue : Unknown type");
+			_BeginValue(type, 1u);
+			_SkipBytes(BytePipeFormat::GetPrimitiveSize(type));
+			break;
+		}
+	}
+
+	void BytePipeDeserialiser::_ReadArray(Deserialiser& dst, const Type sub_type, uint32_t length) {
+		const size_t size = BytePipeFormat::GetPrimitiveSize(sub_type);
+		const bool decoded = _states.back().decoded;
+		const size_t window_count = decoded ? UINT32_MAX : _window.size() / size;
+
+		while (length > 0u) {
+			// Pass values to the destination directly from the window
+			const uint32_t count = length < window_count ? length : static_cast<uint32_t>(window_count);
+			const void* src;
+			if (decoded) {
+				_BeginValue(sub_type, count);
+				ByteOrder::FromLittleEndian(_decoded.data() + _decoded_begin, size, count);
+				src = _decoded.data() + _decoded_begin;
+				_decoded_begin += size * count;
+			} else {
+				if (_window_begin % size != 0u) _Compact();
+				_BeginValue(sub_type, count);
+				_Fill(size * count);
+				ByteOrder::FromLittleEndian(_window.data() + _window_begin, size, count);
+				src = _window.data() + _window_begin;
+				_window_begin += size * count;
+			}
+
+			switch (sub_type) {
+			case Serialiser::TYPE_UNSIGNED_8:
+				dst.SetNextValueU8(static_cast<const uint8_t*>(src), count);
+				break;
+			case Serialiser::TYPE_UNSIGNED_16:
+				dst.SetNextValueU16(static_cast<const uint16_t*>(src), count);
+				break;
+			case Serialiser::TYPE_UNSIGNED_32:
+				dst.SetNextValueU32(static_cast<const uint32_t*>(src), count);
+				break;
+			case Serialiser::TYPE_UNSIGNED_64:
+				dst.SetNextValueU64(static_cast<const uint64_t*>(src), count);
+				break;
+			case Serialiser::TYPE_SIGNED_8:
+				dst.SetNextValueS8(static_cast<const int8_t*>(src), count);
+				break;
+			case Serialiser::TYPE_SIGNED_16:
+				dst.SetNextValueS16(static_cast<const int16_t*>(src), count);
+				break;
+			case Serialiser::TYPE_SIGNED_32:
+				dst.SetNextValueS32(static_cast<const int32_t*>(src), count);
+				break;
+			case Serialiser::TYPE_SIGNED_64:
+				dst.SetNextValueS64(static_cast<const int64_t*>(src), count);
+				break;
+			case Serialiser::TYPE_FLOAT_32:
+				dst.SetNextValueF32(static_cast<const float*>(src), count);
+				break;
+			case Serialiser::TYPE_FLOAT_64:
+				dst.SetNextValueF64(static_cast<const double*>(src), count);
+				break;
+			default:
+				throw std::runtime_error("BytePipeDeserialiser::_ReadArray : Type is not a primitive");
+			}
+
+			length -= count;
+		}
+	}
+
+	void BytePipeDeserialiser::ReadValue(Deserialiser& dst) {
+		const Type type = GetNextType();
+		if (!_states.empty() && _states.back().type == Serialiser::TYPE_OBJECT) dst.SetNextMemberName(_name_buffer.c_str());
+
+		switch (type) {
+		case Serialiser::TYPE_UNSIGNED_8:
+			dst.SetNextValueU8(ReadValueU8());
+			break;
+		case Serialiser::TYPE_UNSIGNED_16:
+			dst.SetNextValueU16(ReadValueU16());
+			break;
+		case Serialiser::TYPE_UNSIGNED_32:
+			dst.SetNextValueU32(ReadValueU32());
+			break;
+		case Serialiser::TYPE_UNSIGNED_64:
+			dst.SetNextValueU64(ReadValueU64());
+			break;
+		case Serialiser::TYPE_SIGNED_8:
+			dst.SetNextValueS8(ReadValueS8());
+			break;
+		case Serialiser::TYPE_SIGNED_16:
+			dst.SetNextValueS16(ReadValueS16());
+			break;
+		case Serialiser::TYPE_SIGNED_32:
+			dst.SetNextValueS32(ReadValueS32());
+			break;
+		case Serialiser::TYPE_SIGNED_64:
+			dst.SetNextValueS64(ReadValueS64());
+			break;
+		case Serialiser::TYPE_FLOAT_32:
+			dst.SetNextValueF32(ReadValueF32());
+			break;
+		case Serialiser::TYPE_FLOAT_64:
+			dst.SetNextValueF64(ReadValueF64());
+			break;
+		case Serialiser::TYPE_STRING:
+			dst.SetNextValueString(ReadValueString().c_str());
+			break;
+		case Serialiser::TYPE_ARRAY:
+			{
+				Type sub_type;
+				uint32_t length = StartArray(sub_type);
+				dst.StartArray();
+				if (BytePipeFormat::IsPrimitiveType(sub_type)) {
+					// Chunked arrays are passed on one segment at a time
+					while (length > 0u) {
+						_ReadArray(dst, sub_type, length);
+						length = GetRemainingCount();
+					}
+				} else {
+					while (GetRemainingCount() > 0u) ReadValue(dst);
+				}
+				dst.EndArray();
+				EndArray();
+			}
+			break;
+		case Serialiser::TYPE_OBJECT:
+			{
+				const uint32_t length = StartObject();
+				dst.StartObject();
+				for (uint32_t i = 0u; i < length; ++i) ReadValue(dst);
+				dst.EndObject();
+				EndObject();
+			}
+			break;
+		default:
+			throw std::runtime_error("BytePipeDeserialiser::ReadValue : Unknown type");
+		}
+	}
+}
@@ -20,73 +20,857 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <algorithm>
+#include <cstdlib>
+#include <atomic>
+#if ANVIL_SERIALISATION_STATS
+	#include <chrono>
+#endif
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include "anvil/serialisation/ArrayCodec.hpp"
 #include "anvil/serialisation/BytePipeSerialiser.hpp"
 
 namespace anvil {
+
+	/*!
+		\brief Lets the children of a parallel write use their parent's allocator, which does not have to be thread safe.
+	*/
+	class LockedAllocator final : public Allocator {
+	private:
+		Allocator& _allocator;
+		std::mutex _lock;
+	public:
+		LockedAllocator(Allocator& allocator) :
+			_allocator(allocator)
+		{}
+
+		void* Allocate(const size_t bytes) final {
+			std::lock_guard<std::mutex> lock(_lock);
+			return _allocator.Allocate(bytes);
+		}
+
+		void Deallocate(void* ptr, const size_t bytes) final {
+			std::lock_guard<std::mutex> lock(_lock);
+			_allocator.Deallocate(ptr, bytes);
+		}
+
+		bool TryExtend(void* ptr, const size_t old_bytes, const size_t new_bytes) final {
+			std::lock_guard<std::mutex> lock(_lock);
+			return _allocator.TryExtend(ptr, old_bytes, new_bytes);
+		}
+	};
 	
 	// BytePipeSerialiser
 
-	void BytePipeSerialiser::_WriteBytes(const void* data, const size_t bytes) {
-		State& state = _states.back();
+	void BytePipeSerialiser::_GrowBuffer(const size_t required) {
+		// Grow geometrically so that repeated appends are amortised constant time
+		size_t capacity = _buffer_capacity < 256u ? 256u : _buffer_capacity * 2u;
+		if (capacity < required) capacity = required;
+		ANVIL_SERIALISATION_STAT(++_stats.buffer_reallocations);
 
-		if (_states.empty()) {
+		if (_buffer != nullptr && _allocator.TryExtend(_buffer, _buffer_capacity, capacity)) {
+			_buffer_capacity = capacity;
+			return;
+		}
+
+		uint8_t* const buffer = static_cast<uint8_t*>(_allocator.Allocate(capacity));
+		if (_buffer != nullptr) {
+			memcpy(buffer, _buffer, _buffer_size);
+			_allocator.Deallocate(_buffer, _buffer_capacity);
+		}
+		_buffer = buffer;
+		_buffer_capacity = capacity;
+	}
+
+	void BytePipeSerialiser::_AppendLength(const uint32_t length) {
+		if (_mode & BytePipeFormat::MODE_COMPACT) {
+			BytePipeFormat::WriteVarint(_AllocateBytes(BytePipeFormat::GetVarintSize(length)), length);
+		} else {
+			ByteOrder::StoreLittleEndian32(_AllocateBytes(sizeof(uint32_t)), length);
+		}
+	}
+
+	void BytePipeSerialiser::_AppendPadding(const size_t alignment) {
+		// The padding count is a byte after the header, the values start at the next multiple of the alignment
+		const uint64_t position = _stream_position + _buffer_size + _reference_bytes + 1u;
+		const size_t padding = static_cast<size_t>((alignment - position % alignment) % alignment);
+		uint8_t* const dst = _AllocateBytes(1u + padding);
+		dst[0u] = static_cast<uint8_t>(padding);
+		memset(dst + 1u, 0, padding);
+	}
+
+	void BytePipeSerialiser::_AppendContainerHeader(const Type type, const uint32_t length, const Type sub_type) {
+		// Struct arrays are written in one go, so padding is decided before the header
+		const bool padded = (_mode & BytePipeFormat::MODE_ALIGNED) && type == TYPE_ARRAY && length > 0u && BytePipeFormat::IsPrimitiveType(sub_type) && BytePipeFormat::GetPrimitiveSize(sub_type) > 1u;
+		const Type sub_type_byte = padded ? static_cast<Type>(sub_type | BytePipeFormat::SUB_TYPE_PADDED) : sub_type;
+
+		// Only used when the length is known up front, so compact lengths do not need padding
+		if (_mode & BytePipeFormat::MODE_COMPACT) {
+			uint8_t* const dst = _AllocateBytes(type == TYPE_ARRAY ? 2u : 1u);
+			dst[0u] = static_cast<uint8_t>(type | BytePipeFormat::FLAG_COMPACT);
+			if (type == TYPE_ARRAY) dst[1u] = sub_type_byte;
+			_AppendLength(length);
+		} else if (type == TYPE_ARRAY) {
+			ArrayHeader header;
+			memset(&header, 0, sizeof(header));
+			header.type = TYPE_ARRAY;
+			header.length = ByteOrder::ToLittleEndian(length);
+			header.sub_type = sub_type_byte;
+			memcpy(_AllocateBytes(sizeof(header)), &header, sizeof(header));
+		} else {
+			ObjectHeader header;
+			memset(&header, 0, sizeof(header));
+			header.type = TYPE_OBJECT;
+			header.length = ByteOrder::ToLittleEndian(length);
+			memcpy(_AllocateBytes(sizeof(header)), &header, sizeof(header));
+		}
+
+		if (padded) _AppendPadding(BytePipeFormat::GetPrimitiveSize(sub_type));
+	}
+
+	void BytePipeSerialiser::_WriteBytes(const void* data, const size_t bytes) {
+		if (!_IsBuffered()) {
 			// Write to stream directly
-			_pipe.WriteBytes(data, bytes);
+			_WritePipe(data, static_cast<uint32_t>(bytes));
+		} else if (bytes > 0u) {
+			// Copy into the shared buffer in a single block
+			memcpy(_AllocateBytes(bytes), data, bytes);
+		}
+	}
+
+	void BytePipeSerialiser::_WriteLength(const uint32_t length) {
+		if (_mode & BytePipeFormat::MODE_COMPACT) {
+			uint8_t varint[BytePipeFormat::MAX_VARINT_SIZE];
+			_WriteBytes(varint, BytePipeFormat::WriteVarint(varint, length));
 		} else {
-			// Write to state buffer
-			state.byte_buffer.reserve(state.byte_buffer.size() + bytes);
-			const uint8_t* const byte_ptr = static_cast<const uint8_t*>(data);
-			for (uint32_t i = 0; i < bytes; ++i) {
-				state.byte_buffer.push_back(byte_ptr[i]);
-			}
+			const uint32_t value = ByteOrder::ToLittleEndian(length);
+			_WriteBytes(&value, sizeof(uint32_t));
 		}
 	}
 
 	void BytePipeSerialiser::_WriteString(const void* data, const size_t bytes) {
 		// Write string length first
-		uint32_t length = static_cast<uint32_t>(bytes);
-		_WriteBytes(&length, sizeof(uint32_t));
+		_WriteLength(static_cast<uint32_t>(bytes));
 
 		// Then write string contents
 		_WriteBytes(data, bytes);
 	}
 
-	void BytePipeSerialiser::WriteBytes(const void* data, const size_t bytes, const Type type, const uint32_t count) {
+	void BytePipeSerialiser::_WriteName(const std::string& name) {
+		if ((_mode & BytePipeFormat::MODE_INTERN_NAMES) == 0u) {
+			_WriteString(name.c_str(), name.size());
+			return;
+		}
+
+		// Refer to a name that has already been written by its ID
+		const uint32_t hash = BytePipeFormat::HashName(name.c_str(), name.size());
+		const uint32_t id = _FindName(name, hash);
+		if (id != UINT32_MAX) {
+			_WriteLength(id + 1u);
+			return;
+		}
+
+		// Write the name and assign it the next ID
+		_WriteLength(0u);
+		_WriteString(name.c_str(), name.size());
+		if (_names.size() < BytePipeFormat::MAX_INTERNED_NAMES) _InternName(name, hash);
+	}
+
+	uint32_t BytePipeSerialiser::_FindName(const std::string& name, const uint32_t hash) const {
+		if (_name_slots.empty()) return UINT32_MAX;
+
+		// Linear probing, the table is never more than half full so there is always an empty slot
+		const size_t mask = _name_slots.size() - 1u;
+		for (size_t slot = hash & mask; _name_slots[slot] != 0u; slot = (slot + 1u) & mask) {
+			const InternedName& interned = _names[_name_slots[slot] - 1u];
+			if (interned.hash == hash && interned.length == name.size() && memcmp(_name_chars.data() + interned.offset, name.c_str(), name.size()) == 0) return _name_slots[slot] - 1u;
+		}
+		return UINT32_MAX;
+	}
+
+	void BytePipeSerialiser::_InternName(const std::string& name, const uint32_t hash) {
+		if ((_names.size() + 1u) * 2u > _name_slots.size()) {
+			// Double the table and insert the names again
+			const size_t slot_count = _name_slots.empty() ? static_cast<size_t>(MIN_NAME_SLOTS) : _name_slots.size() * 2u;
+			_name_slots.assign(slot_count, 0u);
+			const size_t mask = slot_count - 1u;
+			for (size_t i = 0u; i < _names.size(); ++i) {
+				size_t slot = _names[i].hash & mask;
+				while (_name_slots[slot] != 0u) slot = (slot + 1u) & mask;
+				_name_slots[slot] = static_cast<uint32_t>(i + 1u);
+				_names[i].slot = static_cast<uint32_t>(slot);
+			}
+		}
+
+		const size_t mask = _name_slots.size() - 1u;
+		size_t slot = hash & mask;
+		while (_name_slots[slot] != 0u) slot = (slot + 1u) & mask;
+
+		InternedName interned;
+		interned.offset = _name_chars.size();
+		interned.length = static_cast<uint32_t>(name.size());
+		interned.hash = hash;
+		interned.slot = static_cast<uint32_t>(slot);
+		_name_chars.insert(_name_chars.end(), name.begin(), name.end());
+		_names.push_back(interned);
+		_name_slots[slot] = static_cast<uint32_t>(_names.size());
+	}
+
+	void BytePipeSerialiser::_ClearNames() {
+		// Only the used slots are emptied, so clearing between small documents does not touch the whole table
+		for (const InternedName& interned : _names) _name_slots[interned.slot] = 0u;
+		_names.clear();
+		_name_chars.clear();
+	}
+
+	void BytePipeSerialiser::_WriteContainerHeader(const Type type, const bool encoded) {
+		uint8_t header[BytePipeFormat::MAX_HEADER_SIZE];
+		size_t header_size;
+
+		uint8_t type_byte = type;
+		if (_mode & BytePipeFormat::MODE_INDEXED) type_byte |= BytePipeFormat::FLAG_INDEXED;
+		if (_mode & BytePipeFormat::MODE_COMPACT) type_byte |= BytePipeFormat::FLAG_COMPACT;
+		if (type == TYPE_OBJECT && (_mode & BytePipeFormat::MODE_INTERN_NAMES)) type_byte |= BytePipeFormat::FLAG_INTERNED;
+		if (encoded) type_byte |= BytePipeFormat::FLAG_ENCODED;
+
+		if (_mode & BytePipeFormat::MODE_COMPACT) {
+			// Type, sub-type and a varint length that is shrunk when the container ends
+			header[0u] = type_byte;
+			header_size = 1u;
+			if (type == TYPE_ARRAY) header[header_size++] = TYPE_UNSIGNED_8;
+			memset(header + header_size, 0, sizeof(uint32_t) + BytePipeFormat::MAX_VARINT_SIZE);
+			if (_mode & BytePipeFormat::MODE_INDEXED) header_size += sizeof(uint32_t);
+			header_size += BytePipeFormat::MAX_VARINT_SIZE;
+		} else {
+			if (type == TYPE_ARRAY) {
+				ArrayHeader array_header;
+				memset(&array_header, 0, sizeof(array_header));
+				array_header.type = static_cast<Type>(type_byte);
+				array_header.length = 0u;
+				array_header.sub_type = TYPE_UNSIGNED_8;
+				memcpy(header, &array_header, sizeof(array_header));
+				header_size = sizeof(array_header);
+			} else {
+				ObjectHeader object_header;
+				memset(&object_header, 0, sizeof(object_header));
+				object_header.type = static_cast<Type>(type_byte);
+				object_header.length = 0u;
+				memcpy(header, &object_header, sizeof(object_header));
+				header_size = sizeof(object_header);
+			}
+
+			// Reserve space for the container size
+			if (_mode & BytePipeFormat::MODE_INDEXED) {
+				memset(header + header_size, 0, sizeof(uint32_t));
+				header_size += sizeof(uint32_t);
+			}
+		}
+
+		// Reserve space for the codec and encoded size
+		if (encoded) {
+			memset(header + header_size, 0, 1u + sizeof(uint32_t));
+			header_size += 1u + sizeof(uint32_t);
+		}
+
+		_WriteBytes(header, header_size);
+	}
+
+	void BytePipeSerialiser::_BeginValue(const Type type, const uint32_t count) {
+		if (_cursor_open) throw std::runtime_error("BinarySerialiser::WriteBytes : An ArrayCursor is open");
+		ANVIL_SERIALISATION_STAT(_stats.values[type] += count);
+
+		if (_states.empty()) {
+			if (count != 1) throw std::runtime_error("BinarySerialiser::WriteBytes : Current value is not an array or object");
+		} else {
+			State& state = _states.back();
+			if (state.type == TYPE_ARRAY) {
+				// Elements of chunked arrays are written out once enough of them are buffered
+				if (_IsSegmentFull(state)) _WriteSegment();
+
+				if (!_HasArrayType(state)) {
+					state.array_data.type = type;
+				} else if (state.array_data.type != type) {
+					throw std::runtime_error("BinarySerialiser::WriteBytes : Type of value does not match previous values in array");
+				}
+				_BeginArrayValues(state, type);
+				state.array_data.length += count;
+
+				// Encoded values must be contiguous in the buffer
+				if (state.array_data.codec != BytePipeFormat::CODEC_NONE && !BytePipeFormat::IsPrimitiveType(type)) {
+					throw std::runtime_error("BinarySerialiser::WriteBytes : Encoded arrays can only contain primitive values");
+				}
+
+				// Record where the element starts, primitive elements have a fixed size so do not need an entry
+				if ((_mode & BytePipeFormat::MODE_INDEXED) && !BytePipeFormat::IsPrimitiveType(type) && !state.array_data.chunked) {
+					IndexEntry entry;
+					entry.hash = 0u;
+					entry.offset = _GetOffset(state);
+					_index.push_back(entry);
+				}
+
+				// Array values share the sub-type in the array header
+				return;
+			} else if(state.type == TYPE_OBJECT) {
+				if (count != 1) throw std::runtime_error("BinarySerialiser::WriteBytes : Undefined member names");
+				if (_name_buffer.empty()) throw std::runtime_error("BinarySerialiser::WriteBytes : Undefined member name");
+				++state.object_data.member_count;
+
+				// Record where the member starts
+				if (_mode & BytePipeFormat::MODE_INDEXED) {
+					IndexEntry entry;
+					entry.hash = BytePipeFormat::HashName(_name_buffer.c_str(), _name_buffer.size());
+					entry.offset = _GetOffset(state);
+					_index.push_back(entry);
+				}
+
+				// Write the object name
+				_WriteName(_name_buffer);
+				_name_buffer.clear();
+			}
+		}
+
+		// Other values are prefixed with their type so that they can be read back, containers begin with their type in the header
+		if (type != TYPE_ARRAY && type != TYPE_OBJECT) {
+			const uint8_t type_byte = (_mode & BytePipeFormat::MODE_COMPACT) ? (type | BytePipeFormat::FLAG_COMPACT) : type;
+			_WriteBytes(&type_byte, sizeof(type_byte));
+		}
+	}
+
+	void BytePipeSerialiser::_EndContainer(const uint32_t length, const Type sub_type) {
+		if (_cursor_open) throw std::runtime_error("BytePipeSerialiser::_EndContainer : An ArrayCursor is open");
+
+		const State& state = _states.back();
+		uint8_t* const header = _buffer + state.header_offset;
+		size_t size_offset;	// Offset of the container size from the header
+		size_t shift = 0u;	// Number of bytes the contents moved back by
+
+		if (_mode & BytePipeFormat::MODE_COMPACT) {
+			size_offset = 1u;
+			if (state.type == TYPE_ARRAY) header[size_offset++] = state.array_data.padded ? static_cast<uint8_t>(sub_type | BytePipeFormat::SUB_TYPE_PADDED) : static_cast<uint8_t>(sub_type);
+
+			// Write the length into the space reserved after the header
+			const size_t length_offset = size_offset + ((_mode & BytePipeFormat::MODE_INDEXED) ? sizeof(uint32_t) : 0u);
+			uint8_t* const length_ptr = header + length_offset;
+			const size_t content_offset = state.header_offset + length_offset + BytePipeFormat::MAX_VARINT_SIZE;
+			const size_t content_bytes = _buffer_size - content_offset;
+
+			if (content_bytes <= COMPACT_SHRINK_LIMIT && (_mode & BytePipeFormat::MODE_ALIGNED) == 0u && (_references.empty() || _references.back().offset < content_offset)) {
+				// Small containers are moved back so that the length uses as few bytes as possible, which would undo any alignment
+				const size_t varint_size = BytePipeFormat::WriteVarint(length_ptr, length);
+				shift = BytePipeFormat::MAX_VARINT_SIZE - varint_size;
+				memmove(length_ptr + varint_size, _buffer + content_offset, content_bytes);
+				ANVIL_SERIALISATION_STAT(_stats.bytes_moved += content_bytes);
+				_buffer_size -= shift;
+			} else {
+				// Moving large containers would cost more than it saves
+				BytePipeFormat::WriteVarint(length_ptr, length, BytePipeFormat::MAX_VARINT_SIZE);
+			}
+		} else if (state.type == TYPE_ARRAY) {
+			ArrayHeader array_header;
+			memcpy(&array_header, header, sizeof(array_header));
+			array_header.length = ByteOrder::ToLittleEndian(length);
+			array_header.sub_type = state.array_data.padded ? static_cast<Type>(sub_type | BytePipeFormat::SUB_TYPE_PADDED) : sub_type;
+			memcpy(header, &array_header, sizeof(array_header));
+			size_offset = sizeof(array_header);
+		} else {
+			ObjectHeader object_header;
+			memcpy(&object_header, header, sizeof(object_header));
+			object_header.length = ByteOrder::ToLittleEndian(length);
+			memcpy(header, &object_header, sizeof(object_header));
+			size_offset = sizeof(object_header);
+		}
+
+		if (_mode & BytePipeFormat::MODE_INDEXED) {
+			IndexEntry* const begin = _index.data() + state.index_begin;
+			IndexEntry* const end = _index.data() + _index.size();
+			for (IndexEntry* i = begin; i < end; ++i) i->offset -= static_cast<uint32_t>(shift);
+
+			if (state.type == TYPE_OBJECT) {
+				// Sort members by name hash so that they can be binary searched
+				std::sort(begin, end, [](const IndexEntry& lhs, const IndexEntry& rhs)->bool {
+					return lhs.hash == rhs.hash ? lhs.offset < rhs.offset : lhs.hash < rhs.hash;
+				});
+				for (IndexEntry* i = begin; i < end; ++i) {
+					i->hash = ByteOrder::ToLittleEndian(i->hash);
+					i->offset = ByteOrder::ToLittleEndian(i->offset);
+				}
+				_WriteBytes(begin, sizeof(IndexEntry) * (end - begin));
+			} else {
+				for (IndexEntry* i = begin; i < end; ++i) {
+					const uint32_t offset = ByteOrder::ToLittleEndian(i->offset);
+					_WriteBytes(&offset, sizeof(uint32_t));
+				}
+			}
+			_index.resize(state.index_begin);
+
+			// Patch the size of the container, which follows the header
+			ByteOrder::StoreLittleEndian32(_buffer + state.header_offset + size_offset, _GetOffset(state));
+		}
+
+		// Remove the state from the stack, a name set for a member that was never written belongs to the closed object
+		_states.pop_back();
+		_name_buffer.clear();
+
+		// Write the value once the outermost container is complete, unless it is part of a document
+		if (!_IsBuffered()) _WriteOutput();
+	}
+
+	void BytePipeSerialiser::_WriteSegment() {
 		State& state = _states.back();
+		uint8_t* const header = _buffer + state.header_offset;
+		ByteOrder::StoreLittleEndian32(header, state.array_data.length);
+		header[sizeof(uint32_t)] = _GetSubTypeByte(state);
+		_WriteOutput();
+		++_segment_count;
+
+		// The next segment starts at the beginning of the buffer
+		state.header_offset = 0u;
+		state.reference_bytes = 0u;
+		state.array_data.length = 0u;
+		state.array_data.padded = false;
+		_AllocateBytes(BytePipeFormat::SEGMENT_HEADER_SIZE);
+	}
+
+	void BytePipeSerialiser::_EndChunkedArray() {
+		if (_cursor_open) throw std::runtime_error("BytePipeSerialiser::EndArray : An ArrayCursor is open");
+
+		State& state = _states.back();
+		if (state.array_data.length > 0u) {
+			uint8_t* const header = _buffer + state.header_offset;
+			ByteOrder::StoreLittleEndian32(header, state.array_data.length);
+			header[sizeof(uint32_t)] = _GetSubTypeByte(state);
+		} else {
+			// Nothing follows the header of an empty segment, so it is removed
+			_buffer_size = state.header_offset;
+		}
+
+		// A segment without values ends the array
+		ByteOrder::StoreLittleEndian32(_AllocateBytes(sizeof(uint32_t)), 0u);
+
+		_states.pop_back();
+		_name_buffer.clear();
+		_segment_count = 0u;
+		_WriteOutput();
+	}
+
+	void BytePipeSerialiser::_WriteOutput() {
+		if (_references.empty()) {
+			_WritePipe(_buffer, static_cast<uint32_t>(_buffer_size));
+			_buffer_size = 0u;
+			return;
+		}
+
+		// Interleave the buffer with the referenced arrays
+		_fragments.clear();
+		size_t begin = 0u;
+		for (const Reference& reference : _references) {
+			if (reference.offset > begin) _fragments.push_back(GatherOutputPipe::Fragment{ _buffer + begin, reference.offset - begin });
+			_fragments.push_back(GatherOutputPipe::Fragment{ reference.data, reference.bytes });
+			begin = reference.offset;
+		}
+		if (_buffer_size > begin) _fragments.push_back(GatherOutputPipe::Fragment{ _buffer + begin, _buffer_size - begin });
+
+		const size_t total_bytes = _buffer_size + _reference_bytes;
+		_references.clear();
+		_reference_bytes = 0u;
+		_buffer_size = 0u;
+
+		GatherOutputPipe* const gather = dynamic_cast<GatherOutputPipe*>(_pipe);
+		if (gather != nullptr) {
+#if ANVIL_SERIALISATION_STATS
+			const auto start = std::chrono::steady_clock::now();
+			gather->WriteGather(_fragments.data(), _fragments.size());
+			_stream_position += total_bytes;
+			_stats.pipe_write_time += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+			_stats.bytes_written += total_bytes;
+			++_stats.pipe_writes;
+#else
+			gather->WriteGather(_fragments.data(), _fragments.size());
+			_stream_position += total_bytes;
+#endif
+		} else {
+			for (const GatherOutputPipe::Fragment& fragment : _fragments) {
+				const uint8_t* data = static_cast<const uint8_t*>(fragment.data);
+				size_t remaining = fragment.bytes;
+				while (remaining > 0u) {
+					const uint32_t bytes = remaining > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(remaining);
+					_WritePipe(data, bytes);
+					data += bytes;
+					remaining -= bytes;
+				}
+			}
+		}
+	}
+
+	void BytePipeSerialiser::_WritePipe(const void* data, const uint32_t bytes) {
+#if ANVIL_SERIALISATION_STATS
+		const auto start = std::chrono::steady_clock::now();
+		_pipe->WriteBytes(data, bytes);
+		_stream_position += bytes;
+		_stats.pipe_write_time += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+		_stats.bytes_written += bytes;
+		++_stats.pipe_writes;
+#else
+		_pipe->WriteBytes(data, bytes);
+		_stream_position += bytes;
+#endif
+	}
+
+	void BytePipeSerialiser::_Splice(const BytePipeSerialiser& child) {
+		if (child._states.size() != 1u) throw std::runtime_error("BytePipeSerialiser::WriteParallel : Containers were not ended");
+
+		State& state = _states.back();
+		const State& child_state = child._states.back();
 		if (state.type == TYPE_ARRAY) {
-			if (state.array_data.length == 0) {
-				state.array_data.type = type;
-			} else if (state.array_data.type != type) {
-				throw std::runtime_error("BinarySerialiser::WriteBytes : Type of value does not match previous values in array");
+			if (child_state.array_data.length > 0u) {
+				// Chunked arrays write a segment between children, the values of one child are never split
+				if (_IsSegmentFull(state)) _WriteSegment();
+
+				if (!_HasArrayType(state)) {
+					state.array_data.type = child_state.array_data.type;
+				} else if (state.array_data.type != child_state.array_data.type) {
+					throw std::runtime_error("BytePipeSerialiser::WriteParallel : Type of value does not match previous values in array");
+				}
+
+				if (state.array_data.codec != BytePipeFormat::CODEC_NONE && !BytePipeFormat::IsPrimitiveType(child_state.array_data.type)) {
+					throw std::runtime_error("BytePipeSerialiser::WriteParallel : Encoded arrays can only contain primitive values");
+				}
+
+				_BeginArrayValues(state, child_state.array_data.type);
+				state.array_data.length += child_state.array_data.length;
 			}
-			state.array_data.length += count;
-		} else if(state.type == TYPE_OBJECT) {
-			if (count != 1) throw std::runtime_error("BinarySerialiser::WriteBytes : Undefined member names");
-			if (state.name_buffer.empty()) throw std::runtime_error("BinarySerialiser::WriteBytes : Undefined member name");
-			++state.object_data.member_count;
-
-			// Write the object name
-			_WriteString(state.name_buffer.c_str(), state.name_buffer.size());
-			state.name_buffer.clear();
 		} else {
-			if (count != 1) throw std::runtime_error("BinarySerialiser::WriteBytes : Current value is not an array or object");
+			state.object_data.member_count += child_state.object_data.member_count;
+		}
+
+		// Index entries are relative to the start of the child's buffer, elements of chunked arrays are not indexed
+		if (state.type == TYPE_OBJECT || !state.array_data.chunked) {
+			const uint32_t offset = _GetOffset(state);
+			for (IndexEntry entry : child._index) {
+				entry.offset += offset;
+				_index.push_back(entry);
+			}
+		}
+
+		if (child._buffer_size > 0u) memcpy(_AllocateBytes(child._buffer_size), child._buffer, child._buffer_size);
+
+#if ANVIL_SERIALISATION_STATS
+		// The child's depth includes the container that is open here
+		SerialiserStats child_stats = child._stats;
+		child_stats.max_depth += static_cast<uint32_t>(_states.size() - 1u);
+		child_stats.bytes_moved += child._buffer_size;
+		_stats.Add(child_stats);
+#endif
+	}
+
+	void BytePipeSerialiser::_EncodeArray(State& state) {
+		// The values are the last bytes in the buffer, preceded by the space reserved for the codec and size
+		const size_t raw_bytes = BytePipeFormat::GetPrimitiveSize(state.array_data.type) * state.array_data.length;
+		uint8_t* const values = _buffer + _buffer_size - raw_bytes;
+		uint8_t* const codec_ptr = values - (1u + sizeof(uint32_t));
+
+		uint8_t codec = state.array_data.codec;
+		size_t encoded_bytes = raw_bytes;
+		const bool encode = state.array_data.length > 0u && ArrayCodec::IsSupported(state.array_data.type, codec);
+		if (encode) {
+			_codec_buffer.clear();
+			encoded_bytes = ArrayCodec::Encode(values, state.array_data.length, state.array_data.type, codec, _codec_buffer);
+		}
+
+		if (encoded_bytes < raw_bytes) {
+			memcpy(values, _codec_buffer.data(), encoded_bytes);
+			ANVIL_SERIALISATION_STAT(_stats.bytes_moved += encoded_bytes);
+			_buffer_size -= raw_bytes - encoded_bytes;
+		} else {
+			// Encoding would not save anything
+			codec = BytePipeFormat::CODEC_NONE;
+			encoded_bytes = raw_bytes;
+		}
+
+		codec_ptr[0u] = codec;
+		ByteOrder::StoreLittleEndian32(codec_ptr + 1u, static_cast<uint32_t>(encoded_bytes));
+	}
+
+	void BytePipeSerialiser::_PadArray(State& state, const Type type) {
+		if (!BytePipeFormat::IsPrimitiveType(type)) return;
+		const size_t size = BytePipeFormat::GetPrimitiveSize(type);
+		if (size == 1u) return;
+
+		_AppendPadding(size);
+		state.array_data.padded = true;
+	}
+
+	void BytePipeSerialiser::_WriteValues(const void* data, const size_t bytes, const size_t size) {
+#if ANVIL_SERIALISATION_BIG_ENDIAN
+		if (size > 1u) {
+			if (_IsBuffered()) {
+				uint8_t* const dst = _AllocateBytes(bytes);
+				memcpy(dst, data, bytes);
+				ByteOrder::ToLittleEndian(dst, size, bytes / size);
+			} else {
+				// Values outside of a container are written one at a time
+				uint64_t value;
+				memcpy(&value, data, size);
+				ByteOrder::ToLittleEndian(&value, size, 1u);
+				_WritePipe(&value, static_cast<uint32_t>(size));
+			}
+			return;
+		}
+#else
+		(void)size;
+#endif
+		_WriteBytes(data, bytes);
+	}
+
+	void BytePipeSerialiser::WriteBytes(const void* data, const size_t bytes, const Type type, const uint32_t count) {
+		if (count > 1u && !_states.empty() && _states.back().type == TYPE_ARRAY && _states.back().array_data.chunked) {
+			// Split runs of values so that no segment grows much past the segment size
+			const size_t size = bytes / count;
+			const size_t per_segment = _segment_size > size ? _segment_size / size : 1u;
+			const uint8_t* src = static_cast<const uint8_t*>(data);
+			uint32_t remaining = count;
+			while (remaining > 0u) {
+				const uint32_t values = remaining < per_segment ? remaining : static_cast<uint32_t>(per_segment);
+				_BeginValue(type, values);
+				_WriteValues(src, size * values, size);
+				src += size * values;
+				remaining -= values;
+			}
+			return;
 		}
 
+		_BeginValue(type, count);
+
 		if (type == TYPE_STRING) {
 			if (count != 1) throw std::runtime_error("BinarySerialiser::WriteBytes : Can only write one string at a time");
 			_WriteString(data, bytes);
+		} else if (_reference_threshold > 0u && bytes >= _reference_threshold && !_states.empty() && _states.back().type == TYPE_ARRAY && _states.back().array_data.codec == BytePipeFormat::CODEC_NONE && (!ANVIL_SERIALISATION_BIG_ENDIAN || BytePipeFormat::GetPrimitiveSize(type) == 1u)) {
+			// Record where the values belong instead of copying them, encoded arrays need their values in the buffer and big-endian values must be swapped
+			Reference reference;
+			reference.offset = _buffer_size;
+			reference.data = data;
+			reference.bytes = bytes;
+			_references.push_back(reference);
+			_reference_bytes += bytes;
 		} else {
-			_WriteBytes(data, bytes);
+			_WriteValues(data, bytes, BytePipeFormat::GetPrimitiveSize(type));
 		}
 
 	}
 
-	BytePipeSerialiser::BytePipeSerialiser(BytePipe::OutputPipe& pipe) :
-		_pipe(pipe)
-	{}
+	size_t BytePipeSerialiser::SetNextValueRaw(const BytePipeView& value) {
+		const Type type = value.GetType();
+		const uint8_t* const begin = static_cast<const uint8_t*>(value.GetBegin());
+		const size_t bytes = static_cast<size_t>(static_cast<const uint8_t*>(value.GetEnd()) - begin);
+
+		// The bytes are only readable here if they use the same layout
+		const uint8_t layout =
+			((_mode & BytePipeFormat::MODE_COMPACT) ? static_cast<uint8_t>(BytePipeFormat::FLAG_COMPACT) : static_cast<uint8_t>(0u)) |
+			((_mode & BytePipeFormat::MODE_INDEXED) ? static_cast<uint8_t>(BytePipeFormat::FLAG_INDEXED) : static_cast<uint8_t>(0u));
+		if (type == TYPE_ARRAY || type == TYPE_OBJECT) {
+			const uint8_t flags = *begin & ~BytePipeFormat::TYPE_MASK;
+			if ((flags & (BytePipeFormat::FLAG_COMPACT | BytePipeFormat::FLAG_INDEXED)) != layout) throw std::runtime_error("BytePipeSerialiser::SetNextValueRaw : Value does not use the same layout as the serialiser");
+			if (value.HasInternedNames()) throw std::runtime_error("BytePipeSerialiser::SetNextValueRaw : Values with interned member names cannot be copied");
+		} else if (type == TYPE_STRING && (value.GetFlags() & BytePipeFormat::FLAG_COMPACT) != (layout & BytePipeFormat::FLAG_COMPACT)) {
+			throw std::runtime_error("BytePipeSerialiser::SetNextValueRaw : Value does not use the same layout as the serialiser");
+		}
+
+		// Writes the type byte of values that are not containers, containers begin with their header
+		_BeginValue(type, 1u);
+
+		if (_reference_threshold > 0u && bytes >= _reference_threshold && !_states.empty() && !(_states.back().type == TYPE_ARRAY && _states.back().array_data.codec != BytePipeFormat::CODEC_NONE)) {
+			Reference reference;
+			reference.offset = _buffer_size;
+			reference.data = begin;
+			reference.bytes = bytes;
+			_references.push_back(reference);
+			_reference_bytes += bytes;
+		} else {
+			_WriteBytes(begin, bytes);
+		}
+
+		return bytes;
+	}
+
+	BytePipeSerialiser::BytePipeSerialiser(BytePipe::OutputPipe& pipe, const uint32_t mode, Allocator& allocator) :
+		_pipe(&pipe),
+		_allocator(allocator),
+		_states(StlAllocator<State>(allocator)),
+		_index(StlAllocator<IndexEntry>(allocator)),
+		_buffer(nullptr),
+		_buffer_size(0u),
+		_buffer_capacity(0u),
+		_mode(mode),
+		_document_open(false),
+		_base_depth(0u),
+		_cursor_open(false),
+		_names(StlAllocator<InternedName>(allocator)),
+		_name_slots(StlAllocator<uint32_t>(allocator)),
+		_name_chars(StlAllocator<char>(allocator)),
+		_reference_bytes(0u),
+		_reference_threshold(0u),
+		_segment_size(DEFAULT_SEGMENT_SIZE),
+		_segment_count(0u),
+		_stream_position(0u)
+#if ANVIL_SERIALISATION_STATS
+		, _stats_sink(nullptr)
+#endif
+	{
+		// Skipping an indexed container would also skip the names it assigns IDs to
+		if ((mode & BytePipeFormat::MODE_INDEXED) && (mode & BytePipeFormat::MODE_INTERN_NAMES)) throw std::runtime_error("BytePipeSerialiser::BytePipeSerialiser : MODE_INDEXED cannot be combined with MODE_INTERN_NAMES");
+	}
+
+	BytePipeSerialiser::BytePipeSerialiser(BytePipe::OutputPipe& pipe, const uint32_t mode, const Type container, Allocator& allocator) :
+		BytePipeSerialiser(pipe, mode & ~(BytePipeFormat::MODE_INTERN_NAMES | BytePipeFormat::MODE_ALIGNED), allocator)
+	{
+		// The container is open in the parent, so only its contents are written here
+		_states.push_back(State());
+		State& state = _states.back();
+
+		state.type = container;
+		state.header_offset = 0u;
+		state.index_begin = 0u;
+		state.reference_bytes = 0u;
+		if (container == TYPE_ARRAY) {
+			state.array_data.length = 0u;
+			state.array_data.type = TYPE_UNSIGNED_8;
+			state.array_data.codec = BytePipeFormat::CODEC_NONE;
+			state.array_data.chunked = false;
+			state.array_data.padded = false;
+		} else {
+			state.object_data.member_count = 0u;
+		}
+		_base_depth = 1u;
+	}
 
 	BytePipeSerialiser::~BytePipeSerialiser() {
-		_pipe.Flush();
+		ANVIL_SERIALISATION_STAT(if (_stats_sink != nullptr) _stats_sink->Report(_stats));
+		if (_buffer != nullptr) _allocator.Deallocate(_buffer, _buffer_capacity);
+	}
+
+	void BytePipeSerialiser::BeginDocument() {
+		if (_document_open) throw std::runtime_error("BytePipeSerialiser::BeginDocument : A document is already open");
+		if (!_states.empty()) throw std::runtime_error("BytePipeSerialiser::BeginDocument : A container is open");
+
+		_document_open = true;
+		_ClearNames();
+	}
+
+	void BytePipeSerialiser::EndDocument() {
+		if (!_document_open) throw std::runtime_error("BytePipeSerialiser::EndDocument : No document is open");
+		if (!_states.empty()) throw std::runtime_error("BytePipeSerialiser::EndDocument : A container is open");
+
+		_document_open = false;
+		if (_buffer_size > 0u) _WriteOutput();
+	}
+
+	void BytePipeSerialiser::Reset() {
+		if (_cursor_open) throw std::runtime_error("BytePipeSerialiser::Reset : An ArrayCursor is open");
+
+		_states.clear();
+		_index.clear();
+		_name_buffer.clear();
+		_ClearNames();
+		_references.clear();
+		_reference_bytes = 0u;
+		_buffer_size = 0u;
+		_segment_count = 0u;
+		_document_open = false;
+	}
+
+	void BytePipeSerialiser::SetReferenceThreshold(const size_t bytes) {
+		_reference_threshold = bytes;
+	}
+
+	void BytePipeSerialiser::SetStreamPosition(const uint64_t position) {
+		if (_IsBuffered()) throw std::runtime_error("BytePipeSerialiser::SetStreamPosition : A document or container is open");
+		_stream_position = position;
+	}
+
+	void BytePipeSerialiser::SetPipe(BytePipe::OutputPipe& pipe) {
+		if (_IsBuffered()) throw std::runtime_error("BytePipeSerialiser::SetPipe : A document or container is open");
+		_pipe = &pipe;
+	}
+
+	void BytePipeSerialiser::Flush() {
+#if ANVIL_SERIALISATION_STATS
+		const auto start = std::chrono::steady_clock::now();
+		_pipe->Flush();
+		_stats.pipe_flush_time += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+		if (_stats_sink != nullptr) _stats_sink->Report(_stats);
+#else
+		_pipe->Flush();
+#endif
+	}
+
+#if ANVIL_SERIALISATION_STATS
+	const SerialiserStats& BytePipeSerialiser::GetStats() const {
+		return _stats;
+	}
+
+	void BytePipeSerialiser::ResetStats() {
+		_stats.Clear();
+	}
+
+	void BytePipeSerialiser::SetStatsSink(SerialiserStatsSink* sink) {
+		_stats_sink = sink;
+	}
+#endif
+
+	void BytePipeSerialiser::WriteParallel(const size_t count, const std::function<void(BytePipeSerialiser&, const size_t)>& write, size_t threads) {
+		if (_states.empty()) throw std::runtime_error("BytePipeSerialiser::WriteParallel : Current value is not an array or object");
+
+		const Type type = _states.back().type;
+		if (type == TYPE_OBJECT && (_mode & BytePipeFormat::MODE_INTERN_NAMES)) throw std::runtime_error("BytePipeSerialiser::WriteParallel : Objects cannot be written in parallel with interned names");
+		if (count == 0u) return;
+
+		if (threads == 0u) threads = std::thread::hardware_concurrency();
+		if (threads == 0u) threads = 1u;
+
+		size_t chunk_count = threads * PARALLEL_CHUNKS_PER_THREAD;
+		if (chunk_count > count) chunk_count = count;
+		if (threads > chunk_count) threads = chunk_count;
+
+		// Each chunk is written into its own buffer by whichever thread claims it next, the buffers come from this serialiser's allocator
+		LockedAllocator allocator(_allocator);
+		std::vector<std::unique_ptr<BytePipeSerialiser>> children(chunk_count);
+		std::atomic<size_t> next_chunk(0u);
+		std::exception_ptr error;
+		std::mutex error_lock;
+
+		const auto worker = [&]() {
+			for (size_t chunk = next_chunk++; chunk < chunk_count; chunk = next_chunk++) {
+				try {
+					children[chunk].reset(new BytePipeSerialiser(*_pipe, _mode, type, allocator));
+					const size_t end = (count * (chunk + 1u)) / chunk_count;
+					for (size_t i = (count * chunk) / chunk_count; i < end; ++i) write(*children[chunk], i);
+				} catch (...) {
+					std::lock_guard<std::mutex> lock(error_lock);
+					if (!error) error = std::current_exception();
+					next_chunk = chunk_count;
+				}
+			}
+		};
+
+		std::vector<std::thread> workers;
+		workers.reserve(threads - 1u);
+		for (size_t i = 1u; i < threads; ++i) workers.emplace_back(worker);
+		worker();
+		for (std::thread& thread : workers) thread.join();
+
+		if (error) std::rethrow_exception(error);
+
+		// Append the chunks in order, freeing each one once it has been copied
+		for (std::unique_ptr<BytePipeSerialiser>& child : children) {
+			_Splice(*child);
+			child.reset();
+		}
 	}
 
 	void BytePipeSerialiser::SetNextValueU8(const uint8_t value) {
@@ -130,121 +914,169 @@ namespace anvil {
 	}
 
 	void BytePipeSerialiser::SetNextValueString(const char* value) {
-		WriteBytes(&value, strlen(value), TYPE_STRING, 1u);
+		WriteBytes(value, strlen(value), TYPE_STRING, 1u);
 	}
 
 	void BytePipeSerialiser::StartArray() {
+		// The array is a value of the parent container
+		_BeginValue(TYPE_ARRAY, 1u);
+
 		// Create a new state
 		_states.push_back(State());
+		ANVIL_SERIALISATION_STAT(if (_states.size() > _stats.max_depth) _stats.max_depth = static_cast<uint32_t>(_states.size()));
 		State& state = _states.back();
 
 		// Initialise state
 		state.type = TYPE_ARRAY;
+		state.header_offset = _buffer_size;
+		state.index_begin = _index.size();
+		state.reference_bytes = _reference_bytes;
 		state.array_data.length = 0u;
 		state.array_data.type = TYPE_UNSIGNED_8;
+		state.array_data.codec = BytePipeFormat::CODEC_NONE;
+		state.array_data.chunked = false;
+		state.array_data.padded = false;
 
-		// Write header
-		ArrayHeader header;
-		header.type = TYPE_ARRAY;
+		// Write header, the length and sub-type are patched when the array ends
+		_WriteContainerHeader(TYPE_ARRAY, false);
+	}
+
+	void BytePipeSerialiser::StartArray(const uint8_t codec) {
+		if (codec == BytePipeFormat::CODEC_NONE) {
+			StartArray();
+			return;
+		}
+
+		if (!ArrayCodec::IsSupported(TYPE_UNSIGNED_8, codec) && !ArrayCodec::IsSupported(TYPE_FLOAT_64, codec)) throw std::runtime_error("BytePipeSerialiser::StartArray : Invalid combination of codecs");
+
+		_BeginValue(TYPE_ARRAY, 1u);
+		_states.push_back(State());
+		ANVIL_SERIALISATION_STAT(if (_states.size() > _stats.max_depth) _stats.max_depth = static_cast<uint32_t>(_states.size()));
+		State& state = _states.back();
+
+		state.type = TYPE_ARRAY;
+		state.header_offset = _buffer_size;
+		state.index_begin = _index.size();
+		state.reference_bytes = _reference_bytes;
 		state.array_data.length = 0u;
-		header.sub_type = TYPE_UNSIGNED_8;
-		state.byte_buffer.resize(sizeof(header));
-		memcpy(state.byte_buffer.data(), &header, sizeof(header));
+		state.array_data.type = TYPE_UNSIGNED_8;
+		state.array_data.codec = codec;
+		state.array_data.chunked = false;
+		state.array_data.padded = false;
+
+		// The codec and encoded size follow the header and are written when the array ends
+		_WriteContainerHeader(TYPE_ARRAY, true);
 	}
 
-	void BytePipeSerialiser::EndArray() {
-		// Check value is an array
-		if (_states.back().type != TYPE_ARRAY) throw std::runtime_error("BinarySerialiser::EndArray : Current value is not an array");
+	void BytePipeSerialiser::StartChunkedArray(const size_t segment_size) {
+		// Segments are written as they fill, so nothing around the array can be waiting in the buffer
+		if (_IsBuffered()) throw std::runtime_error("BytePipeSerialiser::StartChunkedArray : Chunked arrays must be the outermost value and cannot be part of a document");
 
-		// Remove the state from the stack
-		State state = std::move(_states.back());
-		_states.pop_back();
+		_BeginValue(TYPE_ARRAY, 1u);
+		_states.push_back(State());
+		ANVIL_SERIALISATION_STAT(if (_states.size() > _stats.max_depth) _stats.max_depth = static_cast<uint32_t>(_states.size()));
+		State& state = _states.back();
 
-		// Update header
-		ArrayHeader& header = *reinterpret_cast<ArrayHeader*>(state.byte_buffer.data());
-		header.length = state.array_data.length;
-		header.sub_type = state.array_data.type;
+		state.type = TYPE_ARRAY;
+		state.index_begin = _index.size();
+		state.reference_bytes = _reference_bytes;
+		state.array_data.length = 0u;
+		state.array_data.type = TYPE_UNSIGNED_8;
+		state.array_data.codec = BytePipeFormat::CODEC_NONE;
+		state.array_data.chunked = true;
+		state.array_data.padded = false;
+		_segment_size = segment_size;
+		_segment_count = 0u;
+
+		// The header is a single type byte followed by the header of the first segment, which is patched when the segment is written
+		const uint8_t type_byte = static_cast<uint8_t>(TYPE_ARRAY | BytePipeFormat::FLAG_CHUNKED | ((_mode & BytePipeFormat::MODE_COMPACT) ? static_cast<uint8_t>(BytePipeFormat::FLAG_COMPACT) : static_cast<uint8_t>(0u)));
+		_WriteBytes(&type_byte, sizeof(type_byte));
+		state.header_offset = _buffer_size;
+		_AllocateBytes(BytePipeFormat::SEGMENT_HEADER_SIZE);
+	}
 
-		// Write array
-		WriteBytes(state.byte_buffer.data(), state.byte_buffer.size(), TYPE_ARRAY, 1);
+	void BytePipeSerialiser::EndArray() {
+		// Check value is an array
+		if (_states.size() <= _base_depth || _states.back().type != TYPE_ARRAY) throw std::runtime_error("BinarySerialiser::EndArray : Current value is not an array");
+
+		State& state = _states.back();
+		if (state.array_data.chunked) {
+			_EndChunkedArray();
+			return;
+		}
+		if (state.array_data.codec != BytePipeFormat::CODEC_NONE) _EncodeArray(state);
+		_EndContainer(state.array_data.length, state.array_data.type);
 	}
 
 	void BytePipeSerialiser::StartObject() {
+		// The object is a value of the parent container
+		_BeginValue(TYPE_OBJECT, 1u);
+
 		// Create a new state
 		_states.push_back(State());
+		ANVIL_SERIALISATION_STAT(if (_states.size() > _stats.max_depth) _stats.max_depth = static_cast<uint32_t>(_states.size()));
 		State& state = _states.back();
 
 		// Initialise state
 		state.type = TYPE_OBJECT;
+		state.header_offset = _buffer_size;
+		state.index_begin = _index.size();
+		state.reference_bytes = _reference_bytes;
 		state.object_data.member_count = 0u;
 
-		// Write header
-		ObjectHeader header;
-		header.type = TYPE_OBJECT;
-		state.array_data.length = 0u;
-		state.byte_buffer.resize(sizeof(header));
-		memcpy(state.byte_buffer.data(), &header, sizeof(header));
+		// Write header, the length is patched when the object ends
+		_WriteContainerHeader(TYPE_OBJECT, false);
 	}
 
 	void BytePipeSerialiser::EndObject() {
 		// Check value is an object
-		if (_states.back().type != TYPE_OBJECT) throw std::runtime_error("BinarySerialiser::EndObject : Current value is not an object");
+		if (_states.size() <= _base_depth || _states.back().type != TYPE_OBJECT) throw std::runtime_error("BinarySerialiser::EndObject : Current value is not an object");
 
-		// Remove the state from the stack
-		State state = std::move(_states.back());
-		_states.pop_back();
-
-		// Update header
-		ObjectHeader& header = *reinterpret_cast<ObjectHeader*>(state.byte_buffer.data());
-		header.length = state.array_data.length;
-
-		// Write array
-		WriteBytes(state.byte_buffer.data(), state.byte_buffer.size(), TYPE_OBJECT, 1);
+		_EndContainer(_states.back().object_data.member_count, TYPE_UNSIGNED_8);
 	}
 
 	void BytePipeSerialiser::SetNextMemberName(const char* name) {
-		State& state = _states.back();
-		if (state.type != TYPE_OBJECT) throw std::runtime_error("BinarySerialiser::SetNextMemberName : Current value is not an object");
-		state.name_buffer = name;
+		if (_states.empty() || _states.back().type != TYPE_OBJECT) throw std::runtime_error("BinarySerialiser::SetNextMemberName : Current value is not an object");
+		_name_buffer = name;
 	}
 
 	void BytePipeSerialiser::SetNextValueU8(const uint8_t* value, const size_t count) {
-		WriteBytes(&value, sizeof(uint8_t) * count, TYPE_UNSIGNED_8, count);
+		WriteBytes(value, sizeof(uint8_t) * count, TYPE_UNSIGNED_8, count);
 	}
 
 	void BytePipeSerialiser::SetNextValueU16(const uint16_t* value, const size_t count) {
-		WriteBytes(&value, sizeof(uint16_t) * count, TYPE_UNSIGNED_16, count);
+		WriteBytes(value, sizeof(uint16_t) * count, TYPE_UNSIGNED_16, count);
 	}
 
 	void BytePipeSerialiser::SetNextValueU32(const uint32_t* value, const size_t count) {
-		WriteBytes(&value, sizeof(uint32_t) * count, TYPE_UNSIGNED_32, count);
+		WriteBytes(value, sizeof(uint32_t) * count, TYPE_UNSIGNED_32, count);
 	}
 
 	void BytePipeSerialiser::SetNextValueU64(const uint64_t* value, const size_t count) {
-		WriteBytes(&value, sizeof(uint64_t) * count, TYPE_UNSIGNED_64, count);
+		WriteBytes(value, sizeof(uint64_t) * count, TYPE_UNSIGNED_64, count);
 	}
 
 	void BytePipeSerialiser::SetNextValueS8(const int8_t* value, const size_t count) {
-		WriteBytes(&value, sizeof(int8_t) * count, TYPE_SIGNED_8, count);
+		WriteBytes(value, sizeof(int8_t) * count, TYPE_SIGNED_8, count);
 	}
 
 	void BytePipeSerialiser::SetNextValueS16(const int16_t* value, const size_t count) {
-		WriteBytes(&value, sizeof(int16_t) * count, TYPE_SIGNED_16, count);
+		WriteBytes(value, sizeof(int16_t) * count, TYPE_SIGNED_16, count);
 	}
 
 	void BytePipeSerialiser::SetNextValueS32(const int32_t* value, const size_t count) {
-		WriteBytes(&value, sizeof(int32_t) * count, TYPE_SIGNED_32, count);
+		WriteBytes(value, sizeof(int32_t) * count, TYPE_SIGNED_32, count);
 	}
 
 	void BytePipeSerialiser::SetNextValueS64(const int64_t* value, const size_t count) {
-		WriteBytes(&value, sizeof(int64_t) * count, TYPE_SIGNED_64, count);
+		WriteBytes(value, sizeof(int64_t) * count, TYPE_SIGNED_64, count);
 	}
 
 	void BytePipeSerialiser::SetNextValueF32(const float* value, const size_t count) {
-		WriteBytes(&value, sizeof(float) * count, TYPE_FLOAT_32, count);
+		WriteBytes(value, sizeof(float) * count, TYPE_FLOAT_32, count);
 	}
 
 	void BytePipeSerialiser::SetNextValueF64(const double* value, const size_t count) {
-		WriteBytes(&value, sizeof(double) * count, TYPE_FLOAT_64, count);
+		WriteBytes(value, sizeof(double) * count, TYPE_FLOAT_64, count);
 	}
 }
\ No newline at end of file
@@ -0,0 +1,255 @@
+// MIT License
+// 
+// Copyright(c) 2021 Adam Smith
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <stdexcept>
+#include "anvil/serialisation/BytePipeTranscoder.hpp"
+
+namespace anvil {
+
+	template<class T>
+	static void WriteArrayValues(BytePipeSerialiser& dst, const BytePipeView& value, const uint32_t count, std::vector<uint8_t>& buffer) {
+		// Decoded into a buffer so that the values are aligned
+		buffer.resize(sizeof(T) * count);
+		T* const values = reinterpret_cast<T*>(buffer.data());
+		value.CopyArray(values);
+		Reflection::WriteArray(dst, values, count);
+	}
+
+	// BytePipeTranscoder
+
+	BytePipeTranscoder::BytePipeTranscoder(BytePipeSerialiser& dst, Filter* filter) :
+		_dst(dst),
+		_filter(filter),
+		_copied_bytes(0u),
+		_layout(static_cast<uint8_t>(
+			((dst.GetMode() & BytePipeFormat::MODE_COMPACT) ? static_cast<uint8_t>(BytePipeFormat::FLAG_COMPACT) : static_cast<uint8_t>(0u)) |
+			((dst.GetMode() & BytePipeFormat::MODE_INDEXED) ? static_cast<uint8_t>(BytePipeFormat::FLAG_INDEXED) : static_cast<uint8_t>(0u))
+		)),
+		_codec(BytePipeFormat::CODEC_NONE),
+		_recode(false)
+	{}
+
+	bool BytePipeTranscoder::_CanCopy(const BytePipeView& value) const {
+		switch (value.GetType()) {
+		case Serialiser::TYPE_ARRAY:
+		case Serialiser::TYPE_OBJECT:
+			{
+				// Any container could hold arrays that need to be encoded again, or aligned at their new position
+				if (_recode || (_dst.GetMode() & BytePipeFormat::MODE_ALIGNED)) return false;
+
+				const uint8_t flags = *static_cast<const uint8_t*>(value.GetBegin()) & ~BytePipeFormat::TYPE_MASK;
+				if ((flags & (BytePipeFormat::FLAG_COMPACT | BytePipeFormat::FLAG_INDEXED)) != _layout) return false;
+
+				// Interned names anywhere inside the value refer to IDs of the source stream
+				return !value.HasInternedNames();
+			}
+		case Serialiser::TYPE_STRING:
+			return (value.GetFlags() & BytePipeFormat::FLAG_COMPACT) == (_layout & BytePipeFormat::FLAG_COMPACT);
+		default:
+			return true;
+		}
+	}
+
+	void BytePipeTranscoder::_Write(const BytePipeView& value, const bool filter, const size_t depth) {
+		switch (value.GetType()) {
+		case Serialiser::TYPE_OBJECT:
+			if (!filter && _CanCopy(value)) {
+				_copied_bytes += _dst.SetNextValueRaw(value);
+			} else {
+				_WriteObject(value, filter, depth);
+			}
+			break;
+		case Serialiser::TYPE_ARRAY:
+			_WriteArray(value, filter, depth);
+			break;
+		default:
+			if (_CanCopy(value)) {
+				_copied_bytes += _dst.SetNextValueRaw(value);
+			} else {
+				_WriteScalar(value);
+			}
+			break;
+		}
+	}
+
+	void BytePipeTranscoder::_WriteObject(const BytePipeView& value, const bool filter, const size_t depth) {
+		if (_members.size() <= depth) _members.resize(depth + 1u);
+		value.GetMembers(_members[depth]);
+
+		_dst.StartObject();
+		const size_t count = _members[depth].size();
+		for (size_t i = 0u; i < count; ++i) {
+			// Copied because nested values can resize _members
+			const BytePipeView::Member member = _members[depth][i];
+
+			_name.assign(member.name, member.name_length);
+			const Action action = filter ? _filter->FilterMember(_path, _name) : MEMBER_KEEP;
+			if (action == MEMBER_DROP) continue;
+
+			_dst.SetNextMemberName(_name.c_str());
+			if (action == MEMBER_TRANSCODE) {
+				_path.push_back(std::string(member.name, member.name_length));
+				_Write(member.value, true, depth + 1u);
+				_path.pop_back();
+			} else {
+				_Write(member.value, false, depth + 1u);
+			}
+		}
+		_dst.EndObject();
+	}
+
+	void BytePipeTranscoder::_WriteArray(const BytePipeView& value, const bool filter, const size_t depth) {
+		// Primitive arrays cannot contain anything to filter
+		const bool primitive = value.GetCount() == 0u || BytePipeFormat::IsPrimitiveType(value.GetArraySubType());
+		if ((primitive || !filter) && _CanCopy(value)) {
+			_copied_bytes += _dst.SetNextValueRaw(value);
+			return;
+		}
+
+		if (primitive) {
+			_WritePrimitiveArray(value);
+			return;
+		}
+
+		if (_elements.size() <= depth) _elements.resize(depth + 1u);
+		value.GetElements(_elements[depth]);
+
+		_dst.StartArray();
+		const size_t count = _elements[depth].size();
+		for (size_t i = 0u; i < count; ++i) {
+			const BytePipeView element = _elements[depth][i];
+			_Write(element, filter, depth + 1u);
+		}
+		_dst.EndArray();
+	}
+
+	void BytePipeTranscoder::_WritePrimitiveArray(const BytePipeView& value) {
+		const uint32_t count = value.GetCount();
+		_dst.StartArray(_recode ? _codec : value.GetArrayCodec());
+
+		if (count > 0u) {
+			switch (value.GetArraySubType()) {
+			case Serialiser::TYPE_UNSIGNED_8:
+				WriteArrayValues<uint8_t>(_dst, value, count, _array_buffer);
+				break;
+			case Serialiser::TYPE_UNSIGNED_16:
+				WriteArrayValues<uint16_t>(_dst, value, count, _array_buffer);
+				break;
+			case Serialiser::TYPE_UNSIGNED_32:
+				WriteArrayValues<uint32_t>(_dst, value, count, _array_buffer);
+				break;
+			case Serialiser::TYPE_UNSIGNED_64:
+				WriteArrayValues<uint64_t>(_dst, value, count, _array_buffer);
+				break;
+			case Serialiser::TYPE_SIGNED_8:
+				WriteArrayValues<int8_t>(_dst, value, count, _array_buffer);
+				break;
+			case Serialiser::TYPE_SIGNED_16:
+				WriteArrayValues<int16_t>(_dst, value, count, _array_buffer);
+				break;
+			case Serialiser::TYPE_SIGNED_32:
+				WriteArrayValues<int32_t>(_dst, value, count, _array_buffer);
+				break;
+			case Serialiser::TYPE_SIGNED_64:
+				WriteArrayValues<int64_t>(_dst, value, count, _array_buffer);
+				break;
+			case Serialiser::TYPE_FLOAT_32:
+				WriteArrayValues<float>(_dst, value, count, _array_buffer);
+				break;
+			case Serialiser::TYPE_FLOAT_64:
+				WriteArrayValues<double>(_dst, value, count, _array_buffer);
+				break;
+			default:
+				throw std::runtime_error("BytePipeTranscoder::_WritePrimitiveArray : Array is not primitive");
+			}
+		}
+
+		_dst.EndArray();
+	}
+
+	void BytePipeTranscoder::_WriteScalar(const BytePipeView& value) {
+		switch (value.GetType()) {
+		case Serialiser::TYPE_UNSIGNED_8:
+			_dst.SetNextValueU8(value.GetValueU8());
+			break;
+		case Serialiser::TYPE_UNSIGNED_16:
+			_dst.SetNextValueU16(value.GetValueU16());
+			break;
+		case Serialiser::TYPE_UNSIGNED_32:
+			_dst.SetNextValueU32(value.GetValueU32());
+			break;
+		case Serialiser::TYPE_UNSIGNED_64:
+			_dst.SetNextValueU64(value.GetValueU64());
+			break;
+		case Serialiser::TYPE_SIGNED_8:
+			_dst.SetNextValueS8(value.GetValueS8());
+			break;
+		case Serialiser::TYPE_SIGNED_16:
+			_dst.SetNextValueS16(value.GetValueS16());
+			break;
+		case Serialiser::TYPE_SIGNED_32:
+			_dst.SetNextValueS32(value.GetValueS32());
+			break;
+		case Serialiser::TYPE_SIGNED_64:
+			_dst.SetNextValueS64(value.GetValueS64());
+			break;
+		case Serialiser::TYPE_FLOAT_32:
+			_dst.SetNextValueF32(value.GetValueF32());
+			break;
+		case Serialiser::TYPE_FLOAT_64:
+			_dst.SetNextValueF64(value.GetValueF64());
+			break;
+		case Serialiser::TYPE_STRING:
+			{
+				uint32_t length;
+				const char* const str = value.GetValueString(length);
+				_string_buffer.assign(str, length);
+				_dst.SetNextValueString(_string_buffer.c_str());
+			}
+			break;
+		default:
+			throw std::runtime_error("BytePipeTranscoder::_WriteScalar : Value is a container");
+		}
+	}
+
+	void BytePipeTranscoder::SetArrayCodec(const uint8_t codec) {
+		_codec = codec;
+		_recode = true;
+	}
+
+	void BytePipeTranscoder::Transcode(const BytePipeView& value) {
+		_Write(value, _filter != nullptr, 0u);
+	}
+
+	size_t BytePipeTranscoder::Transcode(const void* data, const size_t bytes) {
+		const uint8_t* pos = static_cast<const uint8_t*>(data);
+		const uint8_t* const end = pos + bytes;
+		size_t count = 0u;
+		while (pos < end) {
+			const BytePipeView value(pos, static_cast<size_t>(end - pos));
+			Transcode(value);
+			pos = static_cast<const uint8_t*>(value.GetEnd());
+			++count;
+		}
+		return count;
+	}
+}
@@ -0,0 +1,585 @@
+// MIT License
+// 
+// Copyright(c) 2021 Adam Smith
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstring>
+#include <stdexcept>
+#include "anvil/serialisation/ArrayCodec.hpp"
+#include "anvil/serialisation/BytePipeView.hpp"
+
+namespace anvil {
+
+	static inline void CheckBounds(const uint8_t* data, const uint8_t* end, const size_t bytes) {
+		if (data > end || static_cast<size_t>(end - data) < bytes) throw std::runtime_error("BytePipeView : Value extends past the end of the buffer");
+	}
+
+	static inline const uint8_t* ReadContainerHeader(const uint8_t* data, const uint8_t* end, BytePipeFormat::ContainerInfo& info) {
+		CheckBounds(data, end, 0u);
+		const size_t available = static_cast<size_t>(end - data);
+		const size_t bytes = BytePipeFormat::ReadContainerHeader(data, available, info);
+		CheckBounds(data, end, bytes);
+		return data + bytes;
+	}
+
+	static inline const uint8_t* ReadSegmentHeader(const uint8_t* data, const uint8_t* end, uint32_t& length, Serialiser::Type& sub_type) {
+		CheckBounds(data, end, 0u);
+		const size_t bytes = BytePipeFormat::ReadSegmentHeader(data, static_cast<size_t>(end - data), length, sub_type);
+		CheckBounds(data, end, bytes);
+		return data + bytes;
+	}
+
+	// BytePipeView
+
+	BytePipeView::BytePipeView() :
+		_data(nullptr),
+		_end(nullptr),
+		_type(Serialiser::TYPE_UNSIGNED_8),
+		_flags(0u)
+	{}
+
+	BytePipeView::BytePipeView(const uint8_t* data, const uint8_t* end, const Type type, const uint8_t flags) :
+		_data(data),
+		_end(end),
+		_type(type),
+		_flags(flags)
+	{}
+
+	BytePipeView::BytePipeView(const void* data, const size_t bytes) :
+		BytePipeView()
+	{
+		const uint8_t* const begin = static_cast<const uint8_t*>(data);
+		*this = ReadTaggedValue(begin, begin + bytes);
+	}
+
+	BytePipeView BytePipeView::ReadTaggedValue(const uint8_t* data, const uint8_t* end) {
+		CheckBounds(data, end, 1u);
+		const Type type = BytePipeFormat::GetType(*data);
+		const uint8_t flags = *data & ~BytePipeFormat::TYPE_MASK;
+		if (type > Serialiser::TYPE_OBJECT) throw std::runtime_error("BytePipeView::ReadTaggedValue : Unknown type");
+
+		// Containers begin with their type in the header, other values are prefixed with it
+		if (type != Serialiser::TYPE_ARRAY && type != Serialiser::TYPE_OBJECT) ++data;
+		return BytePipeView(data, end, type, flags);
+	}
+
+	const uint8_t* BytePipeView::ReadString(const uint8_t* data, const uint8_t* end, const bool compact, const char*& str, uint32_t& length) {
+		CheckBounds(data, end, 0u);
+		const size_t bytes = BytePipeFormat::ReadLength(data, static_cast<size_t>(end - data), compact, length);
+		CheckBounds(data, end, bytes);
+		data += bytes;
+		CheckBounds(data, end, length);
+		str = reinterpret_cast<const char*>(data);
+		return data + length;
+	}
+
+	const uint8_t* BytePipeView::ReadMemberName(const uint8_t* data, const uint8_t* end, const uint8_t flags, const char*& name, uint32_t& length) {
+		const bool compact = (flags & BytePipeFormat::FLAG_COMPACT) != 0u;
+
+		if (flags & BytePipeFormat::FLAG_INTERNED) {
+			uint32_t id = 0u;
+			CheckBounds(data, end, 0u);
+			const size_t bytes = BytePipeFormat::ReadLength(data, static_cast<size_t>(end - data), compact, id);
+			CheckBounds(data, end, bytes);
+			data += bytes;
+
+			// The name of a previously assigned ID cannot be resolved without reading the stream in order
+			if (id != 0u) {
+				name = nullptr;
+				length = 0u;
+				return data;
+			}
+		}
+
+		return ReadString(data, end, compact, name, length);
+	}
+
+	const uint8_t* BytePipeView::SkipElements(const uint8_t* data, const uint8_t* end, const Type sub_type, const uint8_t flags, const uint32_t count) {
+		if (BytePipeFormat::IsPrimitiveType(sub_type)) {
+			const size_t bytes = BytePipeFormat::GetPrimitiveSize(sub_type) * count;
+			CheckBounds(data, end, bytes);
+			return data + bytes;
+		}
+
+		for (uint32_t i = 0u; i < count; ++i) data = SkipValue(data, end, sub_type, flags);
+		return data;
+	}
+
+	const uint8_t* BytePipeView::SkipValue(const uint8_t* data, const uint8_t* end, const Type type, const uint8_t flags) {
+		switch (type) {
+		case Serialiser::TYPE_STRING:
+			{
+				const char* str;
+				uint32_t length;
+				return ReadString(data, end, (flags & BytePipeFormat::FLAG_COMPACT) != 0u, str, length);
+			}
+		case Serialiser::TYPE_ARRAY:
+		case Serialiser::TYPE_OBJECT:
+			{
+				BytePipeFormat::ContainerInfo info;
+				const uint8_t* content = ReadContainerHeader(data, end, info);
+
+				// Indexed containers record their size
+				if (info.flags & BytePipeFormat::FLAG_INDEXED) {
+					CheckBounds(data, end, info.size);
+					return data + info.size;
+				}
+
+				if (type == Serialiser::TYPE_ARRAY) {
+					// Encoded arrays record the size of their values
+					if (info.flags & BytePipeFormat::FLAG_ENCODED) {
+						CheckBounds(content, end, info.encoded_size);
+						return content + info.encoded_size;
+					}
+
+					// Chunked arrays are skipped one segment at a time
+					if (info.flags & BytePipeFormat::FLAG_CHUNKED) {
+						uint32_t length = 0u;
+						Type sub_type = Serialiser::TYPE_UNSIGNED_8;
+						for (;;) {
+							content = ReadSegmentHeader(content, end, length, sub_type);
+							if (length == 0u) return content;
+							content = SkipElements(content, end, sub_type, info.flags, length);
+						}
+					}
+
+					content = SkipElements(content, end, info.sub_type, info.flags, info.length);
+				} else {
+					for (uint32_t i = 0u; i < info.length; ++i) {
+						const char* name;
+						uint32_t name_length;
+						content = ReadMemberName(content, end, info.flags, name, name_length);
+						const BytePipeView member = ReadTaggedValue(content, end);
+						content = SkipValue(member._data, end, member._type, member._flags);
+					}
+				}
+				return content;
+			}
+		default:
+			{
+				if (!BytePipeFormat::IsPrimitiveType(type)) throw std::runtime_error("BytePipeView::SkipValue : Unknown type");
+				const size_t bytes = BytePipeFormat::GetPrimitiveSize(type);
+				CheckBounds(data, end, bytes);
+				return data + bytes;
+			}
+		}
+	}
+
+	const uint8_t* BytePipeView::GetContainer(BytePipeFormat::ContainerInfo& info, const Type type) const {
+		if (_type != type) throw std::runtime_error(type == Serialiser::TYPE_ARRAY ? "BytePipeView::GetContainer : Value is not an array" : "BytePipeView::GetContainer : Value is not an object");
+		return ReadContainerHeader(_data, _end, info);
+	}
+
+	const uint8_t* BytePipeView::GetPrimitive(void* dst, const Type type) const {
+		if (_type != type) throw std::runtime_error("BytePipeView::GetPrimitive : Type of value does not match");
+		const size_t bytes = BytePipeFormat::GetPrimitiveSize(type);
+		CheckBounds(_data, _end, bytes);
+		memcpy(dst, _data, bytes);
+		ByteOrder::FromLittleEndian(dst, bytes, 1u);
+		return _data + bytes;
+	}
+
+	const void* BytePipeView::GetArrayData(const Type sub_type, uint32_t& length) const {
+		BytePipeFormat::ContainerInfo info;
+		const uint8_t* data = GetContainer(info, Serialiser::TYPE_ARRAY);
+
+		// The values of a chunked array are only contiguous if it has a single segment
+		if (info.flags & BytePipeFormat::FLAG_CHUNKED) {
+			data = ReadSegmentHeader(data, _end, info.length, info.sub_type);
+			if (info.length > 0u) {
+				uint32_t next_length = 0u;
+				Type next_type;
+				ReadSegmentHeader(SkipElements(data, _end, info.sub_type, info.flags, info.length), _end, next_length, next_type);
+				if (next_length > 0u) throw std::runtime_error("BytePipeView::GetArrayData : Chunked array has more than one segment");
+			}
+		}
+
+		// An empty array can be read as any type
+		if (info.length == 0u) {
+			length = 0u;
+			return data;
+		}
+
+		if (info.sub_type != sub_type) throw std::runtime_error("BytePipeView::GetArrayData : Type of array does not match");
+		if (info.codec != BytePipeFormat::CODEC_NONE) throw std::runtime_error("BytePipeView::GetArrayData : Array is encoded");
+#if ANVIL_SERIALISATION_BIG_ENDIAN
+		if (BytePipeFormat::GetPrimitiveSize(sub_type) > 1u) throw std::runtime_error("BytePipeView::GetArrayData : Values are little-endian, use CopyArray on big-endian hosts");
+#endif
+		CheckBounds(data, _end, BytePipeFormat::GetPrimitiveSize(sub_type) * info.length);
+		length = info.length;
+		return data;
+	}
+
+	void BytePipeView::CopyArrayData(const Type sub_type, void* dst) const {
+		BytePipeFormat::ContainerInfo info;
+		const uint8_t* data = GetContainer(info, Serialiser::TYPE_ARRAY);
+
+		if (info.flags & BytePipeFormat::FLAG_CHUNKED) {
+			uint8_t* dst_bytes = static_cast<uint8_t*>(dst);
+			const size_t size = BytePipeFormat::GetPrimitiveSize(sub_type);
+			for (;;) {
+				data = ReadSegmentHeader(data, _end, info.length, info.sub_type);
+				if (info.length == 0u) return;
+				if (info.sub_type != sub_type) throw std::runtime_error("BytePipeView::CopyArrayData : Type of array does not match");
+				CheckBounds(data, _end, size * info.length);
+				memcpy(dst_bytes, data, size * info.length);
+				ByteOrder::FromLittleEndian(dst_bytes, size, info.length);
+				dst_bytes += size * info.length;
+				data += size * info.length;
+			}
+		}
+
+		if (info.length == 0u) return;
+		if (info.sub_type != sub_type) throw std::runtime_error("BytePipeView::CopyArrayData : Type of array does not match");
+
+		if (info.codec == BytePipeFormat::CODEC_NONE) {
+			const size_t bytes = BytePipeFormat::GetPrimitiveSize(sub_type) * info.length;
+			CheckBounds(data, _end, bytes);
+			memcpy(dst, data, bytes);
+			ByteOrder::FromLittleEndian(dst, BytePipeFormat::GetPrimitiveSize(sub_type), info.length);
+		} else {
+			CheckBounds(data, _end, info.encoded_size);
+			ArrayCodec::Decode(data, info.encoded_size, info.length, sub_type, info.codec, dst);
+			ByteOrder::FromLittleEndian(dst, BytePipeFormat::GetPrimitiveSize(sub_type), info.length);
+		}
+	}
+
+	const void* BytePipeView::GetEnd() const {
+		return SkipValue(_data, _end, _type, _flags);
+	}
+
+	uint8_t BytePipeView::GetValueU8() const {
+		uint8_t value;
+		GetPrimitive(&value, Serialiser::TYPE_UNSIGNED_8);
+		return value;
+	}
+
+	uint16_t BytePipeView::GetValueU16() const {
+		uint16_t value;
+		GetPrimitive(&value, Serialiser::TYPE_UNSIGNED_16);
+		return value;
+	}
+
+	uint32_t BytePipeView::GetValueU32() const {
+		uint32_t value;
+		GetPrimitive(&value, Serialiser::TYPE_UNSIGNED_32);
+		return value;
+	}
+
+	uint64_t BytePipeView::GetValueU64() const {
+		uint64_t value;
+		GetPrimitive(&value, Serialiser::TYPE_UNSIGNED_64);
+		return value;
+	}
+
+	int8_t BytePipeView::GetValueS8() const {
+		int8_t value;
+		GetPrimitive(&value, Serialiser::TYPE_SIGNED_8);
+		return value;
+	}
+
+	int16_t BytePipeView::GetValueS16() const {
+		int16_t value;
+		GetPrimitive(&value, Serialiser::TYPE_SIGNED_16);
+		return value;
+	}
+
+	int32_t BytePipeView::GetValueS32() const {
+		int32_t value;
+		GetPrimitive(&value, Serialiser::TYPE_SIGNED_32);
+		return value;
+	}
+
+	int64_t BytePipeView::GetValueS64() const {
+		int64_t value;
+		GetPrimitive(&value, Serialiser::TYPE_SIGNED_64);
+		return value;
+	}
+
+	float BytePipeView::GetValueF32() const {
+		float value;
+		GetPrimitive(&value, Serialiser::TYPE_FLOAT_32);
+		return value;
+	}
+
+	double BytePipeView::GetValueF64() const {
+		double value;
+		GetPrimitive(&value, Serialiser::TYPE_FLOAT_64);
+		return value;
+	}
+
+	const char* BytePipeView::GetValueString(uint32_t& length) const {
+		if (_type != Serialiser::TYPE_STRING) throw std::runtime_error("BytePipeView::GetValueString : Value is not a string");
+		const char* str;
+		ReadString(_data, _end, (_flags & BytePipeFormat::FLAG_COMPACT) != 0u, str, length);
+		return str;
+	}
+
+	std::string BytePipeView::GetValueString() const {
+		uint32_t length;
+		const char* const str = GetValueString(length);
+		return std::string(str, length);
+	}
+
+	uint32_t BytePipeView::GetCount() const {
+		BytePipeFormat::ContainerInfo info;
+		const uint8_t* data = GetContainer(info, _type == Serialiser::TYPE_ARRAY ? Serialiser::TYPE_ARRAY : Serialiser::TYPE_OBJECT);
+		if ((info.flags & BytePipeFormat::FLAG_CHUNKED) == 0u) return info.length;
+
+		uint32_t count = 0u;
+		uint32_t length = 0u;
+		Type sub_type = Serialiser::TYPE_UNSIGNED_8;
+		for (;;) {
+			data = ReadSegmentHeader(data, _end, length, sub_type);
+			if (length == 0u) return count;
+			count += length;
+			data = SkipElements(data, _end, sub_type, info.flags, length);
+		}
+	}
+
+	BytePipeView::Type BytePipeView::GetArraySubType() const {
+		BytePipeFormat::ContainerInfo info;
+		const uint8_t* const data = GetContainer(info, Serialiser::TYPE_ARRAY);
+
+		// Every segment of a chunked array has the same type
+		if (info.flags & BytePipeFormat::FLAG_CHUNKED) ReadSegmentHeader(data, _end, info.length, info.sub_type);
+		return info.sub_type;
+	}
+
+	uint8_t BytePipeView::GetArrayCodec() const {
+		BytePipeFormat::ContainerInfo info;
+		GetContainer(info, Serialiser::TYPE_ARRAY);
+		return info.codec;
+	}
+
+	BytePipeView BytePipeView::GetElement(const uint32_t index) const {
+		BytePipeFormat::ContainerInfo info;
+		const uint8_t* data = GetContainer(info, Serialiser::TYPE_ARRAY);
+
+		if (info.flags & BytePipeFormat::FLAG_CHUNKED) {
+			// Skip whole segments until the one that contains the element
+			uint32_t remaining = index;
+			for (;;) {
+				data = ReadSegmentHeader(data, _end, info.length, info.sub_type);
+				if (info.length == 0u) throw std::runtime_error("BytePipeView::GetElement : Index is out of bounds");
+				if (remaining < info.length) break;
+				data = SkipElements(data, _end, info.sub_type, info.flags, info.length);
+				remaining -= info.length;
+			}
+
+			data = SkipElements(data, _end, info.sub_type, info.flags, remaining);
+			return BytePipeView(data, _end, info.sub_type, info.flags & BytePipeFormat::FLAG_COMPACT);
+		}
+
+		if (index >= info.length) throw std::runtime_error("BytePipeView::GetElement : Index is out of bounds");
+
+		if (BytePipeFormat::IsPrimitiveType(info.sub_type)) {
+			// Primitive values have a fixed size
+			if (info.codec != BytePipeFormat::CODEC_NONE) throw std::runtime_error("BytePipeView::GetElement : Array is encoded");
+			data += BytePipeFormat::GetPrimitiveSize(info.sub_type) * index;
+		} else if (info.flags & BytePipeFormat::FLAG_INDEXED) {
+			// Look up the element offset in the index
+			CheckBounds(_data, _end, info.size);
+			const uint8_t* const container_end = _data + info.size;
+			const uint8_t* const entry = container_end - sizeof(uint32_t) * (info.length - index);
+			CheckBounds(data, entry, 0u);
+			data = _data + ByteOrder::LoadLittleEndian32(entry);
+			CheckBounds(data, container_end, 0u);
+		} else {
+			for (uint32_t i = 0u; i < index; ++i) data = SkipValue(data, _end, info.sub_type, info.flags);
+		}
+
+		return BytePipeView(data, _end, info.sub_type, info.flags & BytePipeFormat::FLAG_COMPACT);
+	}
+
+	void BytePipeView::GetElements(std::vector<BytePipeView>& elements) const {
+		BytePipeFormat::ContainerInfo info;
+		const uint8_t* data = GetContainer(info, Serialiser::TYPE_ARRAY);
+		const uint8_t flags = info.flags & BytePipeFormat::FLAG_COMPACT;
+
+		elements.clear();
+
+		if (info.flags & BytePipeFormat::FLAG_CHUNKED) {
+			for (;;) {
+				data = ReadSegmentHeader(data, _end, info.length, info.sub_type);
+				if (info.length == 0u) return;
+				for (uint32_t i = 0u; i < info.length; ++i) {
+					elements.push_back(BytePipeView(data, _end, info.sub_type, flags));
+					data = SkipValue(data, _end, info.sub_type, info.flags);
+				}
+			}
+		}
+
+		elements.reserve(info.length);
+
+		if (BytePipeFormat::IsPrimitiveType(info.sub_type)) {
+			if (info.codec != BytePipeFormat::CODEC_NONE) throw std::runtime_error("BytePipeView::GetElements : Array is encoded");
+			const size_t size = BytePipeFormat::GetPrimitiveSize(info.sub_type);
+			CheckBounds(data, _end, size * info.length);
+			for (uint32_t i = 0u; i < info.length; ++i) elements.push_back(BytePipeView(data + size * i, _end, info.sub_type, flags));
+		} else if (info.flags & BytePipeFormat::FLAG_INDEXED) {
+			CheckBounds(_data, _end, info.size);
+			const uint8_t* const container_end = _data + info.size;
+			const uint8_t* const index = container_end - sizeof(uint32_t) * info.length;
+			CheckBounds(data, index, 0u);
+			for (uint32_t i = 0u; i < info.length; ++i) {
+				const uint32_t offset = ByteOrder::LoadLittleEndian32(index + sizeof(uint32_t) * i);
+				CheckBounds(_data + offset, index, 0u);
+				elements.push_back(BytePipeView(_data + offset, _end, info.sub_type, flags));
+			}
+		} else {
+			for (uint32_t i = 0u; i < info.length; ++i) {
+				elements.push_back(BytePipeView(data, _end, info.sub_type, flags));
+				data = SkipValue(data, _end, info.sub_type, info.flags);
+			}
+		}
+	}
+
+	bool BytePipeView::HasInternedNames() const {
+		BytePipeFormat::ContainerInfo info;
+
+		if (_type == Serialiser::TYPE_OBJECT) {
+			const uint8_t* data = GetContainer(info, Serialiser::TYPE_OBJECT);
+			if (info.flags & BytePipeFormat::FLAG_INTERNED) return true;
+
+			for (uint32_t i = 0u; i < info.length; ++i) {
+				const char* name;
+				uint32_t name_length;
+				data = ReadMemberName(data, _end, info.flags, name, name_length);
+				const BytePipeView member = ReadTaggedValue(data, _end);
+				if (member.HasInternedNames()) return true;
+				data = SkipValue(member._data, _end, member._type, member._flags);
+			}
+			return false;
+		}
+
+		if (_type != Serialiser::TYPE_ARRAY) return false;
+
+		const uint8_t* data = GetContainer(info, Serialiser::TYPE_ARRAY);
+		const bool chunked = (info.flags & BytePipeFormat::FLAG_CHUNKED) != 0u;
+		do {
+			if (chunked) {
+				data = ReadSegmentHeader(data, _end, info.length, info.sub_type);
+				if (info.length == 0u) break;
+			}
+
+			// Only containers can hold objects
+			if (info.sub_type == Serialiser::TYPE_ARRAY || info.sub_type == Serialiser::TYPE_OBJECT) {
+				for (uint32_t i = 0u; i < info.length; ++i) {
+					const BytePipeView element(data, _end, info.sub_type, info.flags & BytePipeFormat::FLAG_COMPACT);
+					if (element.HasInternedNames()) return true;
+					data = SkipValue(data, _end, info.sub_type, info.flags);
+				}
+			} else if (chunked) {
+				data = SkipElements(data, _end, info.sub_type, info.flags, info.length);
+			}
+		} while (chunked);
+
+		return false;
+	}
+
+	BytePipeView BytePipeView::GetMember(const char* name) const {
+		BytePipeFormat::ContainerInfo info;
+		const uint8_t* data = GetContainer(info, Serialiser::TYPE_OBJECT);
+		const size_t length = strlen(name);
+
+		if (info.flags & BytePipeFormat::FLAG_INDEXED) {
+			// Binary search the index for the name hash
+			CheckBounds(_data, _end, info.size);
+			const uint8_t* const container_end = _data + info.size;
+			const uint8_t* const index = container_end - sizeof(BytePipeFormat::IndexEntry) * info.length;
+			CheckBounds(data, index, 0u);
+			const uint32_t hash = BytePipeFormat::HashName(name, length);
+
+			BytePipeFormat::IndexEntry entry;
+			uint32_t lower = 0u;
+			uint32_t upper = info.length;
+			while (lower < upper) {
+				const uint32_t middle = lower + (upper - lower) / 2u;
+				if (ByteOrder::LoadLittleEndian32(index + sizeof(entry) * middle + offsetof(BytePipeFormat::IndexEntry, hash)) < hash) {
+					lower = middle + 1u;
+				} else {
+					upper = middle;
+				}
+			}
+
+			// Check each member with a matching hash
+			for (uint32_t i = lower; i < info.length; ++i) {
+				memcpy(&entry, index + sizeof(entry) * i, sizeof(entry));
+				entry.hash = ByteOrder::FromLittleEndian(entry.hash);
+				entry.offset = ByteOrder::FromLittleEndian(entry.offset);
+				if (entry.hash != hash) break;
+
+				const char* member_name;
+				uint32_t member_name_length;
+				const uint8_t* const member_data = ReadMemberName(_data + entry.offset, index, info.flags, member_name, member_name_length);
+				if (member_name == nullptr) throw std::runtime_error("BytePipeView::GetMember : Member name is interned");
+				if (member_name_length == length && memcmp(member_name, name, length) == 0) return ReadTaggedValue(member_data, index);
+			}
+
+			return BytePipeView();
+		}
+
+		for (uint32_t i = 0u; i < info.length; ++i) {
+			const char* member_name;
+			uint32_t member_name_length;
+			data = ReadMemberName(data, _end, info.flags, member_name, member_name_length);
+			if (member_name == nullptr) throw std::runtime_error("BytePipeView::GetMember : Member name is interned");
+			const BytePipeView member = ReadTaggedValue(data, _end);
+			if (member_name_length == length && memcmp(member_name, name, length) == 0) return member;
+			data = SkipValue(member._data, _end, member._type, member._flags);
+		}
+
+		return BytePipeView();
+	}
+
+	BytePipeView BytePipeView::GetMember(const uint32_t index, const char*& name, uint32_t& name_length) const {
+		BytePipeFormat::ContainerInfo info;
+		const uint8_t* data = GetContainer(info, Serialiser::TYPE_OBJECT);
+		if (index >= info.length) throw std::runtime_error("BytePipeView::GetMember : Index is out of bounds");
+
+		for (uint32_t i = 0u; i < index; ++i) {
+			data = ReadMemberName(data, _end, info.flags, name, name_length);
+			const BytePipeView member = ReadTaggedValue(data, _end);
+			data = SkipValue(member._data, _end, member._type, member._flags);
+		}
+
+		data = ReadMemberName(data, _end, info.flags, name, name_length);
+		if (name == nullptr) throw std::runtime_error("BytePipeView::GetMember : Member name is interned");
+		return ReadTaggedValue(data, _end);
+	}
+
+	void BytePipeView::GetMembers(std::vector<Member>& members) const {
+		BytePipeFormat::ContainerInfo info;
+		const uint8_t* data = GetContainer(info, Serialiser::TYPE_OBJECT);
+
+		members.clear();
+		members.reserve(info.length);
+
+		for (uint32_t i = 0u; i < info.length; ++i) {
+			Member member;
+			data = ReadMemberName(data, _end, info.flags, member.name, member.name_length);
+			if (member.name == nullptr) throw std::runtime_error("BytePipeView::GetMembers : Member name is interned");
+			member.value = ReadTaggedValue(data, _end);
+			data = SkipValue(member.value._data, _end, member.value._type, member.value._flags);
+			members.push_back(member);
+		}
+	}
+}
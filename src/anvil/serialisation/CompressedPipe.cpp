@@ -0,0 +1,238 @@
+// MIT License
+// 
+// Copyright(c) 2021 Adam Smith
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstring>
+#include <stdexcept>
+#include "anvil/serialisation/CompressedPipe.hpp"
+
+namespace anvil {
+
+	// CompressedOutputPipe
+
+	CompressedOutputPipe::CompressedOutputPipe(BytePipe::OutputPipe& downstream, const uint32_t block_size, const uint32_t threads, const BlockCompression::Codec codec) :
+		_downstream(downstream),
+		_current(new Block()),
+		_block_size(block_size),
+		_codec(codec),
+		_exit(false)
+	{
+		if (block_size == 0u || block_size > BlockCompression::MAX_BLOCK_SIZE) throw std::runtime_error("CompressedOutputPipe::CompressedOutputPipe : Invalid block size");
+		if (!BlockCompression::IsAvailable(codec)) throw std::runtime_error("CompressedOutputPipe::CompressedOutputPipe : Codec is not available");
+
+		_current->raw.reserve(block_size);
+		for (uint32_t i = 0u; i < threads; ++i) _workers.push_back(std::thread(&CompressedOutputPipe::_WorkerMain, this));
+	}
+
+	CompressedOutputPipe::~CompressedOutputPipe() {
+		try {
+			Flush();
+		} catch (...) {
+			// Destructors must not throw, call Flush first to see errors
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_exit = true;
+		}
+		_work_ready.notify_all();
+		for (std::thread& worker : _workers) worker.join();
+	}
+
+	void CompressedOutputPipe::_WorkerMain() {
+		std::unique_lock<std::mutex> lock(_mutex);
+		while (true) {
+			_work_ready.wait(lock, [this]()->bool { return _exit || !_queue.empty(); });
+			if (_queue.empty()) return;
+
+			Block* const block = _queue.front();
+			_queue.pop_front();
+
+			// Compress without holding the lock
+			lock.unlock();
+			try {
+				block->frame.clear();
+				BlockCompression::WriteFrame(block->raw.data(), block->raw.size(), _codec, block->frame);
+			} catch (...) {
+				block->error = std::current_exception();
+			}
+			lock.lock();
+
+			block->done = true;
+			_work_done.notify_all();
+		}
+	}
+
+	void CompressedOutputPipe::_WriteFrame(Block& block) {
+		const uint8_t* data = block.frame.data();
+		size_t remaining = block.frame.size();
+		while (remaining > 0u) {
+			const uint32_t written = _downstream.WriteBytes(data, static_cast<uint32_t>(remaining));
+			if (written == 0u) throw std::runtime_error("CompressedOutputPipe::_WriteFrame : Downstream pipe did not accept the frame");
+			data += written;
+			remaining -= written;
+		}
+	}
+
+	void CompressedOutputPipe::_WriteCompleted(const size_t max_pending) {
+		while (!_pending.empty()) {
+			Block& block = *_pending.front();
+
+			// Wait for the oldest block while too many are in flight
+			{
+				std::unique_lock<std::mutex> lock(_mutex);
+				if (!block.done) {
+					if (_pending.size() <= max_pending) return;
+					_work_done.wait(lock, [&block]()->bool { return block.done; });
+				}
+			}
+
+			std::unique_ptr<Block> completed = std::move(_pending.front());
+			_pending.pop_front();
+			if (completed->error) std::rethrow_exception(completed->error);
+			_WriteFrame(*completed);
+			_free_blocks.push_back(std::move(completed));
+		}
+	}
+
+	void CompressedOutputPipe::_SubmitBlock() {
+		if (_workers.empty()) {
+			// Compress on this thread and reuse the block
+			_current->frame.clear();
+			BlockCompression::WriteFrame(_current->raw.data(), _current->raw.size(), _codec, _current->frame);
+			_WriteFrame(*_current);
+			_current->raw.clear();
+			return;
+		}
+
+		// Hand the block to a worker
+		Block* const block = _current.get();
+		block->done = false;
+		block->error = nullptr;
+		_pending.push_back(std::move(_current));
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_queue.push_back(block);
+		}
+		_work_ready.notify_one();
+
+		// Start the next block
+		if (_free_blocks.empty()) {
+			_current.reset(new Block());
+			_current->raw.reserve(_block_size);
+		} else {
+			_current = std::move(_free_blocks.back());
+			_free_blocks.pop_back();
+			_current->raw.clear();
+		}
+
+		// Keep each worker busy with up to two blocks
+		_WriteCompleted(_workers.size() * 2u);
+	}
+
+	uint32_t CompressedOutputPipe::WriteBytes(const void* src, const uint32_t bytes) {
+		const uint8_t* src_bytes = static_cast<const uint8_t*>(src);
+		uint32_t remaining = bytes;
+
+		while (remaining > 0u) {
+			const size_t space = _block_size - _current->raw.size();
+			const uint32_t count = remaining < space ? remaining : static_cast<uint32_t>(space);
+			_current->raw.insert(_current->raw.end(), src_bytes, src_bytes + count);
+			src_bytes += count;
+			remaining -= count;
+
+			if (_current->raw.size() == _block_size) _SubmitBlock();
+		}
+
+		return bytes;
+	}
+
+	void CompressedOutputPipe::Flush() {
+		if (!_current->raw.empty()) _SubmitBlock();
+		_WriteCompleted(0u);
+		_downstream.Flush();
+	}
+
+	// CompressedInputPipe
+
+	CompressedInputPipe::CompressedInputPipe(BytePipe::InputPipe& upstream) :
+		_upstream(upstream),
+		_block_begin(0u)
+	{}
+
+	CompressedInputPipe::~CompressedInputPipe() {
+
+	}
+
+	bool CompressedInputPipe::_ReadUpstream(void* dst, const size_t bytes, const bool allow_end) {
+		uint8_t* dst_bytes = static_cast<uint8_t*>(dst);
+		size_t remaining = bytes;
+		while (remaining > 0u) {
+			const uint32_t read = _upstream.ReadBytes(dst_bytes, static_cast<uint32_t>(remaining));
+			if (read == 0u) {
+				// The stream can only end between frames
+				if (allow_end && remaining == bytes) return false;
+				throw std::runtime_error("CompressedInputPipe::_ReadUpstream : Frame is truncated");
+			}
+			dst_bytes += read;
+			remaining -= read;
+		}
+		return true;
+	}
+
+	bool CompressedInputPipe::_ReadBlock() {
+		uint8_t header[BlockCompression::FRAME_HEADER_SIZE];
+		if (!_ReadUpstream(header, sizeof(header), true)) return false;
+
+		BlockCompression::Codec codec;
+		uint32_t raw_size, stored_size, checksum;
+		BlockCompression::ReadFrameHeader(header, codec, raw_size, stored_size, checksum);
+
+		_payload.resize(stored_size);
+		_ReadUpstream(_payload.data(), stored_size, false);
+
+		_block.resize(raw_size);
+		BlockCompression::ReadFramePayload(_payload.data(), codec, raw_size, stored_size, checksum, _block.data());
+		_block_begin = 0u;
+		return true;
+	}
+
+	uint32_t CompressedInputPipe::ReadBytes(void* dst, const uint32_t bytes) {
+		uint8_t* dst_bytes = static_cast<uint8_t*>(dst);
+		uint32_t remaining = bytes;
+
+		while (remaining > 0u) {
+			if (_block_begin == _block.size()) {
+				if (!_ReadBlock()) break;
+				continue;
+			}
+
+			const size_t available = _block.size() - _block_begin;
+			const uint32_t count = remaining < available ? remaining : static_cast<uint32_t>(available);
+			memcpy(dst_bytes, _block.data() + _block_begin, count);
+			_block_begin += count;
+			dst_bytes += count;
+			remaining -= count;
+		}
+
+		return bytes - remaining;
+	}
+}
@@ -0,0 +1,95 @@
+// MIT License
+// 
+// Copyright(c) 2021 Adam Smith
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cerrno>
+#include <stdexcept>
+#include "anvil/serialisation/GatherPipe.hpp"
+
+#if !defined(_WIN32)
+	#include <sys/uio.h>
+	#include <unistd.h>
+#endif
+
+namespace anvil {
+
+	// FileOutputPipe
+
+	FileOutputPipe::FileOutputPipe(const char* path) :
+		_file(fopen(path, "wb"))
+	{
+		if (_file == nullptr) throw std::runtime_error("FileOutputPipe::FileOutputPipe : Failed to open file");
+	}
+
+	FileOutputPipe::~FileOutputPipe() {
+		fclose(_file);
+	}
+
+	uint32_t FileOutputPipe::WriteBytes(const void* src, const uint32_t bytes) {
+		if (fwrite(src, 1u, bytes, _file) != bytes) throw std::runtime_error("FileOutputPipe::WriteBytes : Failed to write to file");
+		return bytes;
+	}
+
+	void FileOutputPipe::Flush() {
+		if (fflush(_file) != 0) throw std::runtime_error("FileOutputPipe::Flush : Failed to flush file");
+	}
+
+	void FileOutputPipe::WriteGather(const Fragment* fragments, const size_t count) {
+#if defined(_WIN32)
+		for (size_t i = 0u; i < count; ++i) {
+			if (fwrite(fragments[i].data, 1u, fragments[i].bytes, _file) != fragments[i].bytes) throw std::runtime_error("FileOutputPipe::WriteGather : Failed to write to file");
+		}
+#else
+		// Bytes already buffered by stdio must go first
+		Flush();
+
+		enum : size_t { MAX_VECTORS = 64u };
+		struct iovec vectors[MAX_VECTORS];
+		const int fd = fileno(_file);
+
+		size_t next = 0u;
+		size_t skip = 0u;	// Bytes of fragments[next] that have already been written
+		while (next < count) {
+			int vector_count = 0;
+			for (size_t i = next; i < count && vector_count < static_cast<int>(MAX_VECTORS); ++i) {
+				const size_t offset = i == next ? skip : 0u;
+				vectors[vector_count].iov_base = const_cast<uint8_t*>(static_cast<const uint8_t*>(fragments[i].data) + offset);
+				vectors[vector_count].iov_len = fragments[i].bytes - offset;
+				++vector_count;
+			}
+
+			ssize_t written = writev(fd, vectors, vector_count);
+			if (written < 0) {
+				if (errno == EINTR) continue;
+				throw std::runtime_error("FileOutputPipe::WriteGather : Failed to write to file");
+			}
+
+			// Advance past the fragments that were written, writes can be partial
+			while (next < count && static_cast<size_t>(written) >= fragments[next].bytes - skip) {
+				written -= static_cast<ssize_t>(fragments[next].bytes - skip);
+				skip = 0u;
+				++next;
+			}
+			skip += static_cast<size_t>(written);
+		}
+#endif
+	}
+}
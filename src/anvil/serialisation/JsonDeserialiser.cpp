@@ -0,0 +1,506 @@
+// MIT License
+// 
+// Copyright(c) 2021 Adam Smith
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <clocale>
+#include <cmath>
+#include <cstdlib>
+#include "anvil/serialisation/JsonDeserialiser.hpp"
+
+#if defined(__has_include)
+	#if __has_include(<charconv>) && __cplusplus >= 201703L
+		#include <charconv>
+	#endif
+#endif
+
+#if defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define ANVIL_JSON_SSE2 1
+#endif
+
+namespace anvil {
+
+	static inline bool IsDigit(const char c) {
+		return c >= '0' && c <= '9';
+	}
+
+	static inline bool IsSpecial(const char c) {
+		return c == '"' || c == '\\' || static_cast<uint8_t>(c) < 0x20u;
+	}
+
+#if ANVIL_JSON_SSE2
+	static inline uint32_t CountTrailingZeros(const uint32_t value) {
+	#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanForward(&index, value);
+		return index;
+	#else
+		return static_cast<uint32_t>(__builtin_ctz(value));
+	#endif
+	}
+#endif
+
+	/*!
+		\brief Return the first quote, backslash or control character in [begin, end), or end if there is none.
+	*/
+	static const char* FindSpecial(const char* begin, const char* const end) {
+#if ANVIL_JSON_SSE2
+		// Test 16 characters at a time, control characters are the ones that are unchanged by an unsigned max with 0x1F
+		const __m128i quote = _mm_set1_epi8('"');
+		const __m128i backslash = _mm_set1_epi8('\\');
+		const __m128i control = _mm_set1_epi8(0x1F);
+		while (end - begin >= 16) {
+			const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+			const __m128i special = _mm_or_si128(
+				_mm_or_si128(_mm_cmpeq_epi8(chars, quote), _mm_cmpeq_epi8(chars, backslash)),
+				_mm_cmpeq_epi8(_mm_max_epu8(chars, control), control)
+			);
+			const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(special));
+			if (mask != 0u) return begin + CountTrailingZeros(mask);
+			begin += 16;
+		}
+#endif
+		while (begin < end && !IsSpecial(*begin)) ++begin;
+		return begin;
+	}
+
+	static void AppendUtf8(std::string& dst, const uint32_t code_point) {
+		if (code_point < 0x80u) {
+			dst += static_cast<char>(code_point);
+		} else if (code_point < 0x800u) {
+			dst += static_cast<char>(0xC0u | (code_point >> 6u));
+			dst += static_cast<char>(0x80u | (code_point & 0x3Fu));
+		} else if (code_point < 0x10000u) {
+			dst += static_cast<char>(0xE0u | (code_point >> 12u));
+			dst += static_cast<char>(0x80u | ((code_point >> 6u) & 0x3Fu));
+			dst += static_cast<char>(0x80u | (code_point & 0x3Fu));
+		} else {
+			dst += static_cast<char>(0xF0u | (code_point >> 18u));
+			dst += static_cast<char>(0x80u | ((code_point >> 12u) & 0x3Fu));
+			dst += static_cast<char>(0x80u | ((code_point >> 6u) & 0x3Fu));
+			dst += static_cast<char>(0x80u | (code_point & 0x3Fu));
+		}
+	}
+
+	static uint32_t ReadHex(const char* src) {
+		uint32_t value = 0u;
+		for (size_t i = 0u; i < 4u; ++i) {
+			const char c = src[i];
+			value <<= 4u;
+			if (c >= '0' && c <= '9') {
+				value |= static_cast<uint32_t>(c - '0');
+			} else if (c >= 'a' && c <= 'f') {
+				value |= static_cast<uint32_t>(c - 'a' + 10);
+			} else if (c >= 'A' && c <= 'F') {
+				value |= static_cast<uint32_t>(c - 'A' + 10);
+			} else {
+				throw std::runtime_error("JsonDeserialiser::_ReadString : Invalid unicode escape");
+			}
+		}
+		return value;
+	}
+
+	// JsonDeserialiser
+
+	JsonDeserialiser::JsonDeserialiser(const char* data, const size_t bytes) :
+		_pos(data),
+		_end(data + bytes),
+		_depth(0u)
+	{}
+
+	JsonDeserialiser::JsonDeserialiser(BytePipe::InputPipe& pipe) :
+		_pos(nullptr),
+		_end(nullptr),
+		_depth(0u)
+	{
+		size_t size = 0u;
+		for (;;) {
+			_input.resize(size + READ_BLOCK_SIZE);
+			const uint32_t bytes = pipe.ReadBytes(_input.data() + size, static_cast<uint32_t>(READ_BLOCK_SIZE));
+			if (bytes == 0u) break;
+			size += bytes;
+		}
+		_input.resize(size);
+
+		_pos = _input.data();
+		_end = _pos + size;
+	}
+
+	JsonDeserialiser::~JsonDeserialiser() {
+
+	}
+
+	void JsonDeserialiser::_SkipWhitespace() {
+		while (_pos < _end && (*_pos == ' ' || *_pos == '\n' || *_pos == '\r' || *_pos == '\t')) ++_pos;
+	}
+
+	char JsonDeserialiser::_Peek() {
+		_SkipWhitespace();
+		if (_pos == _end) throw std::runtime_error("JsonDeserialiser::_Peek : Unexpected end of input");
+		return *_pos;
+	}
+
+	void JsonDeserialiser::_Expect(const char c) {
+		if (_Peek() != c) throw std::runtime_error(std::string("JsonDeserialiser::_Expect : Expected '") + c + "'");
+		++_pos;
+	}
+
+	bool JsonDeserialiser::_Consume(const char c) {
+		_SkipWhitespace();
+		if (_pos == _end || *_pos != c) return false;
+		++_pos;
+		return true;
+	}
+
+	void JsonDeserialiser::_ReadLiteral(const char* literal, const size_t length) {
+		if (static_cast<size_t>(_end - _pos) < length || memcmp(_pos, literal, length) != 0) throw std::runtime_error("JsonDeserialiser::_ReadLiteral : Invalid value");
+		_pos += length;
+	}
+
+	void JsonDeserialiser::_ReadString(std::string& dst) {
+		_Expect('"');
+		dst.clear();
+
+		for (;;) {
+			// Copy the characters up to the next quote or escape in one block
+			const char* const special = FindSpecial(_pos, _end);
+			dst.append(_pos, special);
+			_pos = special;
+			if (_pos == _end) throw std::runtime_error("JsonDeserialiser::_ReadString : Unterminated string");
+
+			const char c = *_pos++;
+			if (c == '"') return;
+			if (c != '\\') throw std::runtime_error("JsonDeserialiser::_ReadString : Control character in string");
+			if (_pos == _end) throw std::runtime_error("JsonDeserialiser::_ReadString : Unterminated string");
+
+			const char escape = *_pos++;
+			switch (escape) {
+			case '"':
+			case '\\':
+			case '/':
+				dst += escape;
+				break;
+			case 'b':
+				dst += '\b';
+				break;
+			case 'f':
+				dst += '\f';
+				break;
+			case 'n':
+				dst += '\n';
+				break;
+			case 'r':
+				dst += '\r';
+				break;
+			case 't':
+				dst += '\t';
+				break;
+			case 'u':
+				{
+					if (_end - _pos < 4) throw std::runtime_error("JsonDeserialiser::_ReadString : Invalid unicode escape");
+					uint32_t code_point = ReadHex(_pos);
+					_pos += 4;
+
+					// Characters outside of the basic plane are written as a pair of surrogates
+					if (code_point >= 0xD800u && code_point < 0xDC00u && _end - _pos >= 6 && _pos[0u] == '\\' && _pos[1u] == 'u') {
+						const uint32_t low = ReadHex(_pos + 2);
+						if (low >= 0xDC00u && low < 0xE000u) {
+							code_point = 0x10000u + ((code_point - 0xD800u) << 10u) + (low - 0xDC00u);
+							_pos += 6;
+						}
+					}
+					AppendUtf8(dst, code_point);
+				}
+				break;
+			default:
+				throw std::runtime_error("JsonDeserialiser::_ReadString : Invalid escape sequence");
+			}
+		}
+	}
+
+	void JsonDeserialiser::_SkipString() {
+		_Expect('"');
+
+		for (;;) {
+			_pos = FindSpecial(_pos, _end);
+			if (_pos == _end) throw std::runtime_error("JsonDeserialiser::_SkipString : Unterminated string");
+
+			const char c = *_pos++;
+			if (c == '"') return;
+			if (c != '\\') throw std::runtime_error("JsonDeserialiser::_SkipString : Control character in string");
+
+			// The escaped character cannot end the string, unicode escapes are followed by plain hex digits
+			if (_pos == _end) throw std::runtime_error("JsonDeserialiser::_SkipString : Unterminated string");
+			++_pos;
+		}
+	}
+
+	void JsonDeserialiser::_ReadNumber(Number& number) {
+		const char* const begin = _pos;
+		const char* pos = _pos;
+		const bool negative = pos < _end && *pos == '-';
+		if (negative) ++pos;
+
+		// Accumulate the integer part while it fits
+		const char* const digits = pos;
+		uint64_t value = 0u;
+		bool overflow = false;
+		while (pos < _end && IsDigit(*pos)) {
+			const uint64_t digit = static_cast<uint64_t>(*pos - '0');
+			if (value > (UINT64_MAX - digit) / 10u) overflow = true;
+			value = value * 10u + digit;
+			++pos;
+		}
+		if (pos == digits) throw std::runtime_error("JsonDeserialiser::_ReadNumber : Invalid value");
+
+		bool integer = !overflow;
+		while (pos < _end && (IsDigit(*pos) || *pos == '.' || *pos == 'e' || *pos == 'E' || *pos == '+' || *pos == '-')) {
+			integer = false;
+			++pos;
+		}
+		_pos = pos;
+
+		if (integer) {
+			if (!negative) {
+				if (value <= static_cast<uint64_t>(INT64_MAX)) {
+					number.type = NUMBER_SIGNED;
+					number.s = static_cast<int64_t>(value);
+				} else {
+					number.type = NUMBER_UNSIGNED;
+					number.u = value;
+				}
+				return;
+			} else if (value <= static_cast<uint64_t>(INT64_MAX) + 1u) {
+				// Negate as unsigned so that the smallest value does not overflow
+				number.type = NUMBER_SIGNED;
+				number.s = static_cast<int64_t>(0u - value);
+				return;
+			}
+		}
+
+		number.type = NUMBER_FLOAT;
+#if defined(__cpp_lib_to_chars)
+		const std::from_chars_result result = std::from_chars(begin, pos, number.f);
+		if (result.ec != std::errc() || result.ptr != pos) throw std::runtime_error("JsonDeserialiser::_ReadNumber : Invalid number");
+#else
+		// strtod needs a terminated string and reads the decimal point of the current locale
+		_string_buffer.assign(begin, pos);
+		const size_t point = _string_buffer.find('.');
+		if (point != std::string::npos) _string_buffer.replace(point, 1u, localeconv()->decimal_point);
+		char* parsed_end;
+		number.f = strtod(_string_buffer.c_str(), &parsed_end);
+		if (parsed_end != _string_buffer.c_str() + _string_buffer.size()) throw std::runtime_error("JsonDeserialiser::_ReadNumber : Invalid number");
+#endif
+	}
+
+	void JsonDeserialiser::_ReadPrimitive(Number& number) {
+		switch (_Peek()) {
+		case 't':
+			_ReadLiteral("true", 4u);
+			number.type = NUMBER_SIGNED;
+			number.s = 1;
+			break;
+		case 'f':
+			_ReadLiteral("false", 5u);
+			number.type = NUMBER_SIGNED;
+			number.s = 0;
+			break;
+		case 'n':
+			_ReadLiteral("null", 4u);
+			number.type = NUMBER_FLOAT;
+			number.f = std::nan("");
+			break;
+		default:
+			_ReadNumber(number);
+			break;
+		}
+	}
+
+	bool JsonDeserialiser::_ReadNumberArray(Deserialiser& dst) {
+		// Values are collected so that the array can be passed in one call with a single type
+		const char* const begin = _pos;
+		_integers.clear();
+		_floats.clear();
+		NumberType type = NUMBER_SIGNED;
+		bool negative = false;
+
+		do {
+			// Non-finite floats are written as null, so it is read as a NaN to keep the array in one call
+			const char c = _Peek();
+			if (c != '-' && c != 'n' && !IsDigit(c)) {
+				_pos = begin;
+				return false;
+			}
+
+			Number number;
+			_ReadPrimitive(number);
+			if (type != NUMBER_FLOAT) {
+				// Integers stay exact while they all fit one type, values too large for int64_t need every value to be non-negative
+				const bool is_negative = number.type == NUMBER_SIGNED && number.s < 0;
+				const bool fits = number.type == NUMBER_SIGNED ? !(is_negative && type == NUMBER_UNSIGNED) : number.type == NUMBER_UNSIGNED && !negative;
+				if (fits) {
+					_integers.push_back(number.type == NUMBER_SIGNED ? static_cast<uint64_t>(number.s) : number.u);
+					if (number.type == NUMBER_UNSIGNED) type = NUMBER_UNSIGNED;
+					negative = negative || is_negative;
+					continue;
+				}
+
+				// Switch the values read so far to doubles
+				for (const uint64_t value : _integers) _floats.push_back(type == NUMBER_UNSIGNED ? static_cast<double>(value) : static_cast<double>(static_cast<int64_t>(value)));
+				type = NUMBER_FLOAT;
+			}
+			_floats.push_back(number.type == NUMBER_FLOAT ? number.f : number.type == NUMBER_SIGNED ? static_cast<double>(number.s) : static_cast<double>(number.u));
+		} while (_Consume(','));
+		_Expect(']');
+
+		if (type == NUMBER_SIGNED) {
+			// Signed and unsigned integers of the same size can alias each other
+			dst.SetNextValueS64(reinterpret_cast<const int64_t*>(_integers.data()), _integers.size());
+		} else if (type == NUMBER_UNSIGNED) {
+			dst.SetNextValueU64(_integers.data(), _integers.size());
+		} else {
+			dst.SetNextValueF64(_floats.data(), _floats.size());
+		}
+		return true;
+	}
+
+	void JsonDeserialiser::_ReadArray(Deserialiser& dst) {
+		if (++_depth > MAX_DEPTH) throw std::runtime_error("JsonDeserialiser::ReadValue : Values are nested too deeply");
+		_Expect('[');
+		dst.StartArray();
+
+		if (!_Consume(']') && !_ReadNumberArray(dst)) {
+			do {
+				ReadValue(dst);
+			} while (_Consume(','));
+			_Expect(']');
+		}
+
+		dst.EndArray();
+		--_depth;
+	}
+
+	void JsonDeserialiser::_ReadObject(Deserialiser& dst) {
+		if (++_depth > MAX_DEPTH) throw std::runtime_error("JsonDeserialiser::ReadValue : Values are nested too deeply");
+		_Expect('{');
+		dst.StartObject();
+
+		if (!_Consume('}')) {
+			do {
+				_ReadString(_name_buffer);
+				_Expect(':');
+				dst.SetNextMemberName(_name_buffer.c_str());
+				ReadValue(dst);
+			} while (_Consume(','));
+			_Expect('}');
+		}
+
+		dst.EndObject();
+		--_depth;
+	}
+
+	bool JsonDeserialiser::HasNextValue() {
+		_SkipWhitespace();
+		return _pos < _end;
+	}
+
+	void JsonDeserialiser::ReadValue(Deserialiser& dst) {
+		switch (_Peek()) {
+		case '{':
+			_ReadObject(dst);
+			break;
+		case '[':
+			_ReadArray(dst);
+			break;
+		case '"':
+			_ReadString(_string_buffer);
+			dst.SetNextValueString(_string_buffer.c_str());
+			break;
+		case 't':
+			_ReadLiteral("true", 4u);
+			dst.SetNextValueU8(1u);
+			break;
+		case 'f':
+			_ReadLiteral("false", 5u);
+			dst.SetNextValueU8(0u);
+			break;
+		case 'n':
+			_ReadLiteral("null", 4u);
+			dst.SetNextValueF64(std::nan(""));
+			break;
+		default:
+			{
+				Number number;
+				_ReadNumber(number);
+				if (number.type == NUMBER_SIGNED) {
+					dst.SetNextValueS64(number.s);
+				} else if (number.type == NUMBER_UNSIGNED) {
+					dst.SetNextValueU64(number.u);
+				} else {
+					dst.SetNextValueF64(number.f);
+				}
+			}
+			break;
+		}
+	}
+
+	void JsonDeserialiser::SkipValue() {
+		switch (_Peek()) {
+		case '{':
+			if (++_depth > MAX_DEPTH) throw std::runtime_error("JsonDeserialiser::SkipValue : Values are nested too deeply");
+			++_pos;
+			if (!_Consume('}')) {
+				do {
+					_SkipString();
+					_Expect(':');
+					SkipValue();
+				} while (_Consume(','));
+				_Expect('}');
+			}
+			--_depth;
+			break;
+		case '[':
+			if (++_depth > MAX_DEPTH) throw std::runtime_error("JsonDeserialiser::SkipValue : Values are nested too deeply");
+			++_pos;
+			if (!_Consume(']')) {
+				do {
+					SkipValue();
+				} while (_Consume(','));
+				_Expect(']');
+			}
+			--_depth;
+			break;
+		case '"':
+			_SkipString();
+			break;
+		default:
+			{
+				Number number;
+				_ReadPrimitive(number);
+			}
+			break;
+		}
+	}
+}
@@ -0,0 +1,482 @@
+// MIT License
+// 
+// Copyright(c) 2021 Adam Smith
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <clocale>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include "anvil/serialisation/JsonSerialiser.hpp"
+
+#if defined(__has_include)
+	#if __has_include(<charconv>) && __cplusplus >= 201703L
+		#include <charconv>
+	#endif
+#endif
+
+#if defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define ANVIL_JSON_SSE2 1
+#endif
+
+namespace anvil {
+
+	static const char DIGIT_PAIRS[] =
+		"00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+		"40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+		"8081828384858687888990919293949596979899";
+
+	static const char HEX_DIGITS[] = "0123456789abcdef";
+
+	static inline bool NeedsEscape(const char c) {
+		return c == '"' || c == '\\' || static_cast<uint8_t>(c) < 0x20u;
+	}
+
+#if ANVIL_JSON_SSE2
+	static inline uint32_t CountTrailingZeros(const uint32_t value) {
+	#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanForward(&index, value);
+		return index;
+	#else
+		return static_cast<uint32_t>(__builtin_ctz(value));
+	#endif
+	}
+#endif
+
+	/*!
+		\brief Return the position of the first character in [begin, end) that must be escaped, or end if there is none.
+	*/
+	static size_t FindEscape(const char* str, size_t begin, const size_t end) {
+#if ANVIL_JSON_SSE2
+		// Test 16 characters at a time, control characters are the ones that are unchanged by an unsigned max with 0x1F
+		const __m128i quote = _mm_set1_epi8('"');
+		const __m128i backslash = _mm_set1_epi8('\\');
+		const __m128i control = _mm_set1_epi8(0x1F);
+		while (begin + 16u <= end) {
+			const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + begin));
+			const __m128i special = _mm_or_si128(
+				_mm_or_si128(_mm_cmpeq_epi8(chars, quote), _mm_cmpeq_epi8(chars, backslash)),
+				_mm_cmpeq_epi8(_mm_max_epu8(chars, control), control)
+			);
+			const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(special));
+			if (mask != 0u) return begin + CountTrailingZeros(mask);
+			begin += 16u;
+		}
+#endif
+		while (begin < end && !NeedsEscape(str[begin])) ++begin;
+		return begin;
+	}
+
+	static size_t FormatValue(char* dst, uint64_t value) {
+		// Digits are written backwards two at a time, then moved to the front
+		char digits[20u];
+		char* pos = digits + sizeof(digits);
+		while (value >= 100u) {
+			const size_t pair = static_cast<size_t>(value % 100u) * 2u;
+			value /= 100u;
+			pos -= 2;
+			memcpy(pos, DIGIT_PAIRS + pair, 2u);
+		}
+		if (value >= 10u) {
+			pos -= 2;
+			memcpy(pos, DIGIT_PAIRS + value * 2u, 2u);
+		} else {
+			*--pos = static_cast<char>('0' + value);
+		}
+
+		const size_t size = static_cast<size_t>(digits + sizeof(digits) - pos);
+		memcpy(dst, pos, size);
+		return size;
+	}
+
+	static size_t FormatValue(char* dst, const int64_t value) {
+		if (value >= 0) return FormatValue(dst, static_cast<uint64_t>(value));
+
+		// Negate as unsigned so that the smallest value does not overflow
+		*dst = '-';
+		return 1u + FormatValue(dst + 1, 0u - static_cast<uint64_t>(value));
+	}
+
+	static inline size_t FormatValue(char* dst, const uint8_t value) { return FormatValue(dst, static_cast<uint64_t>(value)); }
+	static inline size_t FormatValue(char* dst, const uint16_t value) { return FormatValue(dst, static_cast<uint64_t>(value)); }
+	static inline size_t FormatValue(char* dst, const uint32_t value) { return FormatValue(dst, static_cast<uint64_t>(value)); }
+	static inline size_t FormatValue(char* dst, const int8_t value) { return FormatValue(dst, static_cast<int64_t>(value)); }
+	static inline size_t FormatValue(char* dst, const int16_t value) { return FormatValue(dst, static_cast<int64_t>(value)); }
+	static inline size_t FormatValue(char* dst, const int32_t value) { return FormatValue(dst, static_cast<int64_t>(value)); }
+
+#if !defined(__cpp_lib_to_chars)
+	static inline bool ReadsBack(const char* str, const float value) { return strtof(str, nullptr) == value; }
+	static inline bool ReadsBack(const char* str, const double value) { return strtod(str, nullptr) == value; }
+#endif
+
+	template<class T>
+	static size_t FormatFloat(char* dst, const T value) {
+		// JSON has no representation for infinity or NaN
+		if (!std::isfinite(value)) {
+			memcpy(dst, "null", 4u);
+			return 4u;
+		}
+
+#if defined(__cpp_lib_to_chars)
+		// Shortest representation that reads back to the same value
+		return static_cast<size_t>(std::to_chars(dst, dst + 32, value).ptr - dst);
+#else
+		// Search for the fewest significant digits that read back to the same value, any more digits also read back
+		char text[32u];
+		int low = 1;
+		int high = std::numeric_limits<T>::max_digits10;
+		while (low < high) {
+			const int digits = (low + high) / 2;
+			const int size = snprintf(text, sizeof(text), "%.*g", digits, static_cast<double>(value));
+			if (size > 0 && size < static_cast<int>(sizeof(text)) && ReadsBack(text, value)) {
+				high = digits;
+			} else {
+				low = digits + 1;
+			}
+		}
+		const int text_size = snprintf(text, sizeof(text), "%.*g", low, static_cast<double>(value));
+		if (text_size <= 0 || text_size >= static_cast<int>(sizeof(text))) throw std::runtime_error("JsonSerialiser::FormatFloat : Could not format value");
+
+		// snprintf and strtod both use the decimal point of the current locale, JSON always uses '.'
+		const char* const point = localeconv()->decimal_point;
+		const size_t point_size = strlen(point);
+		size_t size = 0u;
+		for (const char* c = text; *c != '\0';) {
+			if (point_size > 0u && strncmp(c, point, point_size) == 0) {
+				dst[size++] = '.';
+				c += point_size;
+			} else {
+				dst[size++] = *c++;
+			}
+		}
+		return size;
+#endif
+	}
+
+	static inline size_t FormatValue(char* dst, const float value) { return FormatFloat(dst, value); }
+	static inline size_t FormatValue(char* dst, const double value) { return FormatFloat(dst, value); }
+
+	// JsonSerialiser
+
+	JsonSerialiser::JsonSerialiser(BytePipe::OutputPipe& pipe, Allocator& allocator) :
+		_pipe(&pipe),
+		_allocator(allocator),
+		_states(StlAllocator<State>(allocator)),
+		_name_set(false),
+		_buffer(nullptr),
+		_buffer_size(0u),
+		_buffer_capacity(0u)
+	{}
+
+	JsonSerialiser::~JsonSerialiser() {
+		if (_buffer != nullptr) _allocator.Deallocate(_buffer, _buffer_capacity);
+	}
+
+	void JsonSerialiser::_GrowBuffer(const size_t required) {
+		size_t capacity = _buffer_capacity < 256u ? 256u : _buffer_capacity * 2u;
+		if (capacity < required) capacity = required;
+
+		if (_buffer != nullptr && _allocator.TryExtend(_buffer, _buffer_capacity, capacity)) {
+			_buffer_capacity = capacity;
+			return;
+		}
+
+		char* const buffer = static_cast<char*>(_allocator.Allocate(capacity));
+		if (_buffer != nullptr) {
+			memcpy(buffer, _buffer, _buffer_size);
+			_allocator.Deallocate(_buffer, _buffer_capacity);
+		}
+		_buffer = buffer;
+		_buffer_capacity = capacity;
+	}
+
+	void JsonSerialiser::_BeginValue(const size_t count) {
+		if (_states.empty()) {
+			if (count != 1u) throw std::runtime_error("JsonSerialiser::_BeginValue : Current value is not an array or object");
+			return;
+		}
+
+		State& state = _states.back();
+		if (state.type == TYPE_OBJECT) {
+			if (count != 1u) throw std::runtime_error("JsonSerialiser::_BeginValue : Undefined member names");
+			if (!_name_set) throw std::runtime_error("JsonSerialiser::_BeginValue : Undefined member name");
+			if (!state.empty) *_AllocateBytes(1u) = ',';
+			_WriteString(_name_buffer.c_str(), _name_buffer.size());
+			*_AllocateBytes(1u) = ':';
+			_name_set = false;
+			state.empty = false;
+		} else if (count > 0u) {
+			if (!state.empty) *_AllocateBytes(1u) = ',';
+			state.empty = false;
+		}
+	}
+
+	void JsonSerialiser::_EndValue() {
+		if (_states.empty()) {
+			// Each value outside of a container is on its own line
+			*_AllocateBytes(1u) = '\n';
+			_WriteOutput();
+		} else if (_buffer_size >= FLUSH_SIZE) {
+			_WriteOutput();
+		}
+	}
+
+	void JsonSerialiser::_WriteString(const char* value, const size_t length) {
+		*_AllocateBytes(1u) = '"';
+
+		size_t begin = 0u;
+		while (begin < length) {
+			// Each character expands to at most 6, so escape in blocks to bound the space reserved for long strings
+			const size_t end = length - begin > STRING_BLOCK_SIZE ? begin + STRING_BLOCK_SIZE : length;
+			char* const dst = _AllocateBytes((end - begin) * 6u);
+			char* pos = dst;
+			while (begin < end) {
+				// Copy the characters that do not need escaping in one block
+				const size_t escape = FindEscape(value, begin, end);
+				memcpy(pos, value + begin, escape - begin);
+				pos += escape - begin;
+				begin = escape;
+				if (begin == end) break;
+
+				const char c = value[begin++];
+				*pos++ = '\\';
+				switch (c) {
+				case '"':
+				case '\\':
+					*pos++ = c;
+					break;
+				case '\b':
+					*pos++ = 'b';
+					break;
+				case '\f':
+					*pos++ = 'f';
+					break;
+				case '\n':
+					*pos++ = 'n';
+					break;
+				case '\r':
+					*pos++ = 'r';
+					break;
+				case '\t':
+					*pos++ = 't';
+					break;
+				default:
+					pos[0u] = 'u';
+					pos[1u] = '0';
+					pos[2u] = '0';
+					pos[3u] = HEX_DIGITS[static_cast<uint8_t>(c) >> 4u];
+					pos[4u] = HEX_DIGITS[static_cast<uint8_t>(c) & 15u];
+					pos += 5u;
+					break;
+				}
+			}
+
+			// Return the space that was not used, long strings are written to the pipe as they are escaped
+			_buffer_size = static_cast<size_t>(pos - _buffer);
+			if (_buffer_size >= FLUSH_SIZE) _WriteOutput();
+		}
+
+		*_AllocateBytes(1u) = '"';
+	}
+
+	void JsonSerialiser::_WriteOutput() {
+		const char* data = _buffer;
+		size_t remaining = _buffer_size;
+		while (remaining > 0u) {
+			const uint32_t bytes = remaining > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(remaining);
+			_pipe->WriteBytes(data, bytes);
+			data += bytes;
+			remaining -= bytes;
+		}
+		_buffer_size = 0u;
+	}
+
+	template<class T>
+	void JsonSerialiser::_WriteValue(const T value) {
+		_BeginValue(1u);
+		char* const dst = _AllocateBytes(MAX_NUMBER_SIZE);
+		_buffer_size -= MAX_NUMBER_SIZE - FormatValue(dst, value);
+		_EndValue();
+	}
+
+	template<class T>
+	void JsonSerialiser::_WriteValues(const T* values, const size_t count) {
+		_BeginValue(count);
+
+		for (size_t i = 0u; i < count; i += VALUE_BLOCK_SIZE) {
+			// Reserve space for a block of values and their separators, then format them without further checks
+			const size_t block = count - i < VALUE_BLOCK_SIZE ? count - i : VALUE_BLOCK_SIZE;
+			char* pos = _AllocateBytes(block * (MAX_NUMBER_SIZE + 1u));
+			if (i > 0u) *pos++ = ',';
+			pos += FormatValue(pos, values[i]);
+			for (size_t j = 1u; j < block; ++j) {
+				*pos++ = ',';
+				pos += FormatValue(pos, values[i + j]);
+			}
+			_buffer_size = static_cast<size_t>(pos - _buffer);
+			if (_buffer_size >= FLUSH_SIZE) _WriteOutput();
+		}
+
+		if (count > 0u) _EndValue();
+	}
+
+	void JsonSerialiser::Flush() {
+		_pipe->Flush();
+	}
+
+	void JsonSerialiser::SetNextValueU8(const uint8_t value) {
+		_WriteValue(value);
+	}
+
+	void JsonSerialiser::SetNextValueU16(const uint16_t value) {
+		_WriteValue(value);
+	}
+
+	void JsonSerialiser::SetNextValueU32(const uint32_t value) {
+		_WriteValue(value);
+	}
+
+	void JsonSerialiser::SetNextValueU64(const uint64_t value) {
+		_WriteValue(value);
+	}
+
+	void JsonSerialiser::SetNextValueS8(const int8_t value) {
+		_WriteValue(value);
+	}
+
+	void JsonSerialiser::SetNextValueS16(const int16_t value) {
+		_WriteValue(value);
+	}
+
+	void JsonSerialiser::SetNextValueS32(const int32_t value) {
+		_WriteValue(value);
+	}
+
+	void JsonSerialiser::SetNextValueS64(const int64_t value) {
+		_WriteValue(value);
+	}
+
+	void JsonSerialiser::SetNextValueF32(const float value) {
+		_WriteValue(value);
+	}
+
+	void JsonSerialiser::SetNextValueF64(const double value) {
+		_WriteValue(value);
+	}
+
+	void JsonSerialiser::SetNextValueString(const char* value) {
+		_BeginValue(1u);
+		_WriteString(value, strlen(value));
+		_EndValue();
+	}
+
+	void JsonSerialiser::StartArray() {
+		_BeginValue(1u);
+		*_AllocateBytes(1u) = '[';
+
+		State state;
+		state.type = TYPE_ARRAY;
+		state.empty = true;
+		_states.push_back(state);
+	}
+
+	void JsonSerialiser::EndArray() {
+		if (_states.empty() || _states.back().type != TYPE_ARRAY) throw std::runtime_error("JsonSerialiser::EndArray : Current value is not an array");
+
+		_states.pop_back();
+		*_AllocateBytes(1u) = ']';
+		_EndValue();
+	}
+
+	void JsonSerialiser::StartObject() {
+		_BeginValue(1u);
+		*_AllocateBytes(1u) = '{';
+
+		State state;
+		state.type = TYPE_OBJECT;
+		state.empty = true;
+		_states.push_back(state);
+	}
+
+	void JsonSerialiser::EndObject() {
+		if (_states.empty() || _states.back().type != TYPE_OBJECT) throw std::runtime_error("JsonSerialiser::EndObject : Current value is not an object");
+
+		// A name set for a member that was never written belongs to the closed object
+		_states.pop_back();
+		_name_set = false;
+		*_AllocateBytes(1u) = '}';
+		_EndValue();
+	}
+
+	void JsonSerialiser::SetNextMemberName(const char* name) {
+		if (_states.empty() || _states.back().type != TYPE_OBJECT) throw std::runtime_error("JsonSerialiser::SetNextMemberName : Current value is not an object");
+		_name_buffer = name;
+		_name_set = true;
+	}
+
+	void JsonSerialiser::SetNextValueU8(const uint8_t* value, const size_t count) {
+		_WriteValues(value, count);
+	}
+
+	void JsonSerialiser::SetNextValueU16(const uint16_t* value, const size_t count) {
+		_WriteValues(value, count);
+	}
+
+	void JsonSerialiser::SetNextValueU32(const uint32_t* value, const size_t count) {
+		_WriteValues(value, count);
+	}
+
+	void JsonSerialiser::SetNextValueU64(const uint64_t* value, const size_t count) {
+		_WriteValues(value, count);
+	}
+
+	void JsonSerialiser::SetNextValueS8(const int8_t* value, const size_t count) {
+		_WriteValues(value, count);
+	}
+
+	void JsonSerialiser::SetNextValueS16(const int16_t* value, const size_t count) {
+		_WriteValues(value, count);
+	}
+
+	void JsonSerialiser::SetNextValueS32(const int32_t* value, const size_t count) {
+		_WriteValues(value, count);
+	}
+
+	void JsonSerialiser::SetNextValueS64(const int64_t* value, const size_t count) {
+		_WriteValues(value, count);
+	}
+
+	void JsonSerialiser::SetNextValueF32(const float* value, const size_t count) {
+		_WriteValues(value, count);
+	}
+
+	void JsonSerialiser::SetNextValueF64(const double* value, const size_t count) {
+		_WriteValues(value, count);
+	}
+}
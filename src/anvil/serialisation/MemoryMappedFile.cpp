@@ -0,0 +1,111 @@
+// MIT License
+// 
+// Copyright(c) 2021 Adam Smith
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <stdexcept>
+#include "anvil/serialisation/MemoryMappedFile.hpp"
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace anvil {
+
+	// MemoryMappedFile
+
+#ifdef _WIN32
+	MemoryMappedFile::MemoryMappedFile(const char* path) :
+		_data(nullptr),
+		_size(0u),
+		_file(INVALID_HANDLE_VALUE),
+		_mapping(NULL)
+	{
+		_file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (_file == INVALID_HANDLE_VALUE) throw std::runtime_error("MemoryMappedFile::MemoryMappedFile : Failed to open file");
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(_file, &size)) {
+			CloseHandle(_file);
+			throw std::runtime_error("MemoryMappedFile::MemoryMappedFile : Failed to get file size");
+		}
+		_size = static_cast<size_t>(size.QuadPart);
+
+		// Windows cannot map an empty file
+		if (_size == 0u) return;
+
+		_mapping = CreateFileMappingA(_file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (_mapping == NULL) {
+			CloseHandle(_file);
+			throw std::runtime_error("MemoryMappedFile::MemoryMappedFile : Failed to create file mapping");
+		}
+
+		_data = MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0);
+		if (_data == nullptr) {
+			CloseHandle(_mapping);
+			CloseHandle(_file);
+			throw std::runtime_error("MemoryMappedFile::MemoryMappedFile : Failed to map file");
+		}
+	}
+
+	MemoryMappedFile::~MemoryMappedFile() {
+		if (_data) UnmapViewOfFile(_data);
+		if (_mapping) CloseHandle(_mapping);
+		CloseHandle(_file);
+	}
+#else
+	MemoryMappedFile::MemoryMappedFile(const char* path) :
+		_data(nullptr),
+		_size(0u),
+		_file(-1)
+	{
+		_file = open(path, O_RDONLY);
+		if (_file == -1) throw std::runtime_error("MemoryMappedFile::MemoryMappedFile : Failed to open file");
+
+		struct stat info;
+		if (fstat(_file, &info) != 0) {
+			close(_file);
+			throw std::runtime_error("MemoryMappedFile::MemoryMappedFile : Failed to get file size");
+		}
+		_size = static_cast<size_t>(info.st_size);
+
+		// An empty file cannot be mapped
+		if (_size == 0u) return;
+
+		void* const data = mmap(nullptr, _size, PROT_READ, MAP_SHARED, _file, 0);
+		if (data == MAP_FAILED) {
+			close(_file);
+			throw std::runtime_error("MemoryMappedFile::MemoryMappedFile : Failed to map file");
+		}
+		_data = data;
+	}
+
+	MemoryMappedFile::~MemoryMappedFile() {
+		if (_data) munmap(const_cast<void*>(_data), _size);
+		close(_file);
+	}
+#endif
+}
@@ -0,0 +1,122 @@
+// MIT License
+// 
+// Copyright(c) 2021 Adam Smith
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include "anvil/serialisation/ParallelReader.hpp"
+
+namespace anvil { namespace ParallelReader {
+
+	enum : size_t {
+		CHUNKS_PER_THREAD = 4u	//!< Number of chunks each thread gets, threads that finish early take the remaining chunks
+	};
+
+	class MemoryInputPipe final : public BytePipe::InputPipe {
+	private:
+		const uint8_t* _data;
+		const uint8_t* _end;
+	public:
+		MemoryInputPipe(const void* begin, const void* end) :
+			_data(static_cast<const uint8_t*>(begin)),
+			_end(static_cast<const uint8_t*>(end))
+		{}
+
+		uint32_t ReadBytes(void* dst, const uint32_t bytes) final {
+			const size_t available = static_cast<size_t>(_end - _data);
+			const uint32_t count = available < bytes ? static_cast<uint32_t>(available) : bytes;
+			memcpy(dst, _data, count);
+			_data += count;
+			return count;
+		}
+	};
+
+	static void ForEachChunk(const size_t count, size_t threads, const std::function<void(const size_t, const size_t)>& read) {
+		if (count == 0u) return;
+
+		if (threads == 0u) threads = std::thread::hardware_concurrency();
+		if (threads == 0u) threads = 1u;
+
+		size_t chunk_count = threads * CHUNKS_PER_THREAD;
+		if (chunk_count > count) chunk_count = count;
+		if (threads > chunk_count) threads = chunk_count;
+
+		std::atomic<size_t> next_chunk(0u);
+		std::exception_ptr error;
+		std::mutex error_lock;
+
+		const auto worker = [&]() {
+			for (size_t chunk = next_chunk++; chunk < chunk_count; chunk = next_chunk++) {
+				try {
+					read((count * chunk) / chunk_count, (count * (chunk + 1u)) / chunk_count);
+				} catch (...) {
+					std::lock_guard<std::mutex> lock(error_lock);
+					if (!error) error = std::current_exception();
+					next_chunk = chunk_count;
+				}
+			}
+		};
+
+		std::vector<std::thread> workers;
+		workers.reserve(threads - 1u);
+		for (size_t i = 1u; i < threads; ++i) workers.emplace_back(worker);
+		worker();
+		for (std::thread& thread : workers) thread.join();
+
+		if (error) std::rethrow_exception(error);
+	}
+
+	void ForEachElement(const BytePipeView& array, const std::function<void(const BytePipeView&, const uint32_t)>& read, size_t threads) {
+		std::vector<BytePipeView> elements;
+		array.GetElements(elements);
+
+		ForEachChunk(elements.size(), threads, [&elements, &read](const size_t begin, const size_t end) {
+			for (size_t i = begin; i < end; ++i) read(elements[i], static_cast<uint32_t>(i));
+		});
+	}
+
+	void ReadElements(const BytePipeView& array, const std::function<void(BytePipeDeserialiser&, const uint32_t)>& read, size_t threads) {
+		// Empty arrays do not record a sub-type
+		if (array.GetCount() == 0u) return;
+
+		const Serialiser::Type type = array.GetArraySubType();
+		if (type != Serialiser::TYPE_ARRAY && type != Serialiser::TYPE_OBJECT) throw std::runtime_error("ParallelReader::ReadElements : Array values must be arrays or objects");
+
+		// Each chunk has its own reader, which would resolve names interned by an earlier chunk to the wrong strings.
+		// Any element can intern names, not only the first
+		if (array.HasInternedNames()) throw std::runtime_error("ParallelReader::ReadElements : Arrays with interned member names cannot be read in parallel");
+
+		std::vector<BytePipeView> elements;
+		array.GetElements(elements);
+
+		// Each chunk is read from the bytes between its first element and the end of its last
+		ForEachChunk(elements.size(), threads, [&elements, &read](const size_t begin, const size_t end) {
+			MemoryInputPipe pipe(elements[begin].GetBegin(), elements[end - 1u].GetEnd());
+			BytePipeDeserialiser reader(pipe);
+			for (size_t i = begin; i < end; ++i) read(reader, static_cast<uint32_t>(i));
+		});
+	}
+
+}}
@@ -0,0 +1,416 @@
+// MIT License
+// 
+// Copyright(c) 2021 Adam Smith
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include "anvil/serialisation/RecordFile.hpp"
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace anvil {
+
+	using namespace RecordFileFormat;
+
+	// The file is little-endian like the records it holds, these convert a structure in either direction
+
+	static inline int64_t ToLittleEndian(const int64_t value) {
+		return static_cast<int64_t>(ByteOrder::ToLittleEndian(static_cast<uint64_t>(value)));
+	}
+
+	static inline void ConvertByteOrder(FileHeader& header) {
+		header.magic = ByteOrder::ToLittleEndian(header.magic);
+		header.version = ByteOrder::ToLittleEndian(header.version);
+		header.index_interval = ByteOrder::ToLittleEndian(header.index_interval);
+		header.reserved = ByteOrder::ToLittleEndian(header.reserved);
+	}
+
+	static inline void ConvertByteOrder(FrameHeader& header) {
+		header.magic = ByteOrder::ToLittleEndian(header.magic);
+		header.bytes = ByteOrder::ToLittleEndian(header.bytes);
+		header.timestamp = ToLittleEndian(header.timestamp);
+	}
+
+	static inline void ConvertByteOrder(IndexEntry& entry) {
+		entry.record = ByteOrder::ToLittleEndian(entry.record);
+		entry.offset = ByteOrder::ToLittleEndian(entry.offset);
+		entry.timestamp = ToLittleEndian(entry.timestamp);
+	}
+
+	static inline void ConvertByteOrder(Trailer& trailer) {
+		trailer.index_offset = ByteOrder::ToLittleEndian(trailer.index_offset);
+		trailer.record_count = ByteOrder::ToLittleEndian(trailer.record_count);
+		trailer.entry_count = ByteOrder::ToLittleEndian(trailer.entry_count);
+		trailer.magic = ByteOrder::ToLittleEndian(trailer.magic);
+	}
+
+	// RecordFileWriter::Record
+
+	RecordFileWriter::Record::Record() :
+		_data(sizeof(FrameHeader), 0u)
+	{}
+
+	void RecordFileWriter::Record::Clear() {
+		_data.resize(sizeof(FrameHeader));
+	}
+
+	uint32_t RecordFileWriter::Record::WriteBytes(const void* src, const uint32_t bytes) {
+		const uint8_t* const src_bytes = static_cast<const uint8_t*>(src);
+		_data.insert(_data.end(), src_bytes, src_bytes + bytes);
+		return bytes;
+	}
+
+	void RecordFileWriter::Record::Flush() {
+		// The bytes are kept until the record is appended
+	}
+
+	// RecordFileWriter
+
+	RecordFileWriter::RecordFileWriter(const char* path, const bool append, const uint32_t index_interval) :
+		_end(sizeof(FileHeader)),
+		_record_count(0u),
+		_index_interval(index_interval),
+#ifdef _WIN32
+		_file(INVALID_HANDLE_VALUE),
+#else
+		_file(-1),
+#endif
+		_open(false)
+	{
+		if (index_interval == 0u) throw std::runtime_error("RecordFileWriter::RecordFileWriter : Index interval cannot be 0");
+
+		// Continue after the last complete frame of an existing file, its footer is replaced when this writer closes
+		bool existing = false;
+		if (append) {
+			FILE* const file = fopen(path, "rb");
+			if (file != nullptr) {
+				existing = fgetc(file) != EOF;
+				fclose(file);
+			}
+
+			if (existing) {
+				const RecordFileReader reader(path);
+				_index = reader._index;
+				_end = reader._frames_end;
+				_record_count = reader._record_count;
+				_index_interval = reader._index_interval;
+			}
+		}
+
+#ifdef _WIN32
+		_file = CreateFileA(path, GENERIC_WRITE, FILE_SHARE_READ, NULL, append ? OPEN_ALWAYS : CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (_file == INVALID_HANDLE_VALUE) throw std::runtime_error("RecordFileWriter::RecordFileWriter : Failed to open file");
+#else
+		_file = open(path, O_WRONLY | O_CREAT | (append ? 0 : O_TRUNC), 0644);
+		if (_file == -1) throw std::runtime_error("RecordFileWriter::RecordFileWriter : Failed to open file");
+#endif
+		_open = true;
+
+		try {
+			if (existing) {
+				_Truncate(_end);
+			} else {
+				FileHeader header;
+				header.magic = FILE_MAGIC;
+				header.version = VERSION;
+				header.index_interval = _index_interval;
+				header.reserved = 0u;
+				ConvertByteOrder(header);
+				_Truncate(0u);
+				_WriteAt(&header, sizeof(header), 0u);
+			}
+		} catch (...) {
+			_open = false;
+#ifdef _WIN32
+			CloseHandle(_file);
+#else
+			close(_file);
+#endif
+			throw;
+		}
+	}
+
+	RecordFileWriter::~RecordFileWriter() {
+		try {
+			Close();
+		} catch (...) {
+			// Destructors must not throw, call Close first to see errors
+		}
+	}
+
+	void RecordFileWriter::_WriteAt(const void* data, size_t bytes, uint64_t offset) {
+		const uint8_t* src = static_cast<const uint8_t*>(data);
+		while (bytes > 0u) {
+#ifdef _WIN32
+			OVERLAPPED overlapped;
+			memset(&overlapped, 0, sizeof(overlapped));
+			overlapped.Offset = static_cast<DWORD>(offset);
+			overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32u);
+			DWORD written = 0u;
+			if (!WriteFile(_file, src, bytes > 0x40000000u ? 0x40000000u : static_cast<DWORD>(bytes), &written, &overlapped)) throw std::runtime_error("RecordFileWriter::_WriteAt : Failed to write to file");
+#else
+			const ssize_t written = pwrite(_file, src, bytes, static_cast<off_t>(offset));
+			if (written < 0) {
+				if (errno == EINTR) continue;
+				throw std::runtime_error("RecordFileWriter::_WriteAt : Failed to write to file");
+			}
+#endif
+			// Writes can be partial
+			src += written;
+			bytes -= static_cast<size_t>(written);
+			offset += static_cast<uint64_t>(written);
+		}
+	}
+
+	void RecordFileWriter::_Truncate(const uint64_t size) {
+#ifdef _WIN32
+		LARGE_INTEGER position;
+		position.QuadPart = static_cast<LONGLONG>(size);
+		if (!SetFilePointerEx(_file, position, NULL, FILE_BEGIN) || !SetEndOfFile(_file)) throw std::runtime_error("RecordFileWriter::_Truncate : Failed to resize file");
+#else
+		if (ftruncate(_file, static_cast<off_t>(size)) != 0) throw std::runtime_error("RecordFileWriter::_Truncate : Failed to resize file");
+#endif
+	}
+
+	uint64_t RecordFileWriter::Append(Record& record, const int64_t timestamp) {
+		const size_t bytes = record.GetSize();
+		if (bytes > UINT32_MAX) throw std::runtime_error("RecordFileWriter::Append : Record is too large");
+		const uint64_t frame_size = GetFrameSize(bytes);
+
+		// Reserve the frame, it is written without holding the lock
+		uint64_t number;
+		uint64_t offset;
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			if (!_open) throw std::runtime_error("RecordFileWriter::Append : File is closed");
+
+			number = _record_count++;
+			offset = _end;
+			_end += frame_size;
+			if (number % _index_interval == 0u) _index.push_back(IndexEntry{ number, offset, timestamp });
+		}
+
+		FrameHeader header;
+		header.magic = FRAME_MAGIC;
+		header.bytes = static_cast<uint32_t>(bytes);
+		header.timestamp = timestamp;
+		ConvertByteOrder(header);
+		memcpy(record._data.data(), &header, sizeof(header));
+		record._data.resize(static_cast<size_t>(frame_size), 0u);
+
+		_WriteAt(record._data.data(), static_cast<size_t>(frame_size), offset);
+		record.Clear();
+		return number;
+	}
+
+	uint64_t RecordFileWriter::GetRecordCount() {
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _record_count;
+	}
+
+	void RecordFileWriter::Flush() {
+		std::lock_guard<std::mutex> lock(_mutex);
+		if (!_open) throw std::runtime_error("RecordFileWriter::Flush : File is closed");
+#ifdef _WIN32
+		if (!FlushFileBuffers(_file)) throw std::runtime_error("RecordFileWriter::Flush : Failed to flush file");
+#else
+		if (fsync(_file) != 0) throw std::runtime_error("RecordFileWriter::Flush : Failed to flush file");
+#endif
+	}
+
+	void RecordFileWriter::Close() {
+		std::lock_guard<std::mutex> lock(_mutex);
+		if (!_open) return;
+		_open = false;
+
+		// The footer goes after the last frame, so readers find it from the end of the file
+		Trailer trailer;
+		trailer.index_offset = _end;
+		trailer.record_count = _record_count;
+		trailer.entry_count = static_cast<uint32_t>(_index.size());
+		trailer.magic = TRAILER_MAGIC;
+		ConvertByteOrder(trailer);
+
+		// The index is not used once the file is closed, so it is converted in place
+		for (IndexEntry& entry : _index) ConvertByteOrder(entry);
+
+		try {
+			_WriteAt(_index.data(), sizeof(IndexEntry) * _index.size(), _end);
+			_WriteAt(&trailer, sizeof(trailer), _end + sizeof(IndexEntry) * _index.size());
+		} catch (...) {
+#ifdef _WIN32
+			CloseHandle(_file);
+#else
+			close(_file);
+#endif
+			throw;
+		}
+
+#ifdef _WIN32
+		CloseHandle(_file);
+#else
+		if (close(_file) != 0) throw std::runtime_error("RecordFileWriter::Close : Failed to close file");
+#endif
+	}
+
+	// RecordFileReader
+
+	RecordFileReader::RecordFileReader(const char* path) :
+		_file(path),
+		_data(static_cast<const uint8_t*>(_file.GetData())),
+		_frames_end(sizeof(FileHeader)),
+		_record_count(0u),
+		_index_interval(DEFAULT_INDEX_INTERVAL),
+		_complete(false)
+	{
+		const size_t size = _file.GetSize();
+
+		FileHeader header;
+		if (size < sizeof(header)) throw std::runtime_error("RecordFileReader::RecordFileReader : File is not a record file");
+		memcpy(&header, _data, sizeof(header));
+		ConvertByteOrder(header);
+		if (header.magic != FILE_MAGIC || header.index_interval == 0u) throw std::runtime_error("RecordFileReader::RecordFileReader : File is not a record file");
+		if (header.version != VERSION) throw std::runtime_error("RecordFileReader::RecordFileReader : Unsupported version");
+		_index_interval = header.index_interval;
+
+		// Use the footer if the writer was closed
+		if (size >= sizeof(FileHeader) + sizeof(Trailer)) {
+			Trailer trailer;
+			memcpy(&trailer, _data + size - sizeof(trailer), sizeof(trailer));
+			ConvertByteOrder(trailer);
+			const uint64_t index_end = size - sizeof(trailer);
+			if (
+				trailer.magic == TRAILER_MAGIC &&
+				trailer.index_offset >= sizeof(FileHeader) &&
+				trailer.index_offset <= index_end &&
+				index_end - trailer.index_offset == sizeof(IndexEntry) * static_cast<uint64_t>(trailer.entry_count)
+			) {
+				_index.resize(trailer.entry_count);
+				if (trailer.entry_count > 0u) memcpy(_index.data(), _data + trailer.index_offset, sizeof(IndexEntry) * trailer.entry_count);
+				for (IndexEntry& entry : _index) ConvertByteOrder(entry);
+				_frames_end = trailer.index_offset;
+				_record_count = trailer.record_count;
+				_complete = true;
+				return;
+			}
+		}
+
+		_BuildIndex();
+	}
+
+	void RecordFileReader::_BuildIndex() {
+		// Walk the frames until one is missing or cut short
+		const uint64_t size = _file.GetSize();
+		uint64_t offset = sizeof(FileHeader);
+		FrameHeader header;
+		while (size - offset >= sizeof(FrameHeader)) {
+			memcpy(&header, _data + offset, sizeof(header));
+			ConvertByteOrder(header);
+			if (header.magic != FRAME_MAGIC) break;
+
+			const uint64_t frame_size = GetFrameSize(header.bytes);
+			if (frame_size > size - offset) break;
+
+			if (_record_count % _index_interval == 0u) _index.push_back(IndexEntry{ _record_count, offset, header.timestamp });
+			++_record_count;
+			offset += frame_size;
+		}
+		_frames_end = offset;
+	}
+
+	void RecordFileReader::_ReadFrame(const uint64_t offset, FrameHeader& header) const {
+		if (offset < sizeof(FileHeader) || offset >= _frames_end || _frames_end - offset < sizeof(FrameHeader)) throw std::runtime_error("RecordFileReader::_ReadFrame : Frame is outside of the file");
+		memcpy(&header, _data + offset, sizeof(header));
+		ConvertByteOrder(header);
+		if (header.magic != FRAME_MAGIC || GetFrameSize(header.bytes) > _frames_end - offset) throw std::runtime_error("RecordFileReader::_ReadFrame : Frame is corrupt");
+	}
+
+	uint64_t RecordFileReader::_FindFrame(const uint64_t record) const {
+		if (record >= _record_count) throw std::runtime_error("RecordFileReader::_FindFrame : Record is out of bounds");
+
+		// Records are numbered in frame order and every index_interval'th one has an entry
+		const uint64_t entry = record / _index_interval;
+		if (entry >= _index.size() || _index[entry].record != entry * _index_interval) throw std::runtime_error("RecordFileReader::_FindFrame : Index is corrupt");
+
+		uint64_t offset = _index[entry].offset;
+		FrameHeader header;
+		for (uint64_t i = _index[entry].record; i < record; ++i) {
+			_ReadFrame(offset, header);
+			offset += GetFrameSize(header.bytes);
+		}
+		return offset;
+	}
+
+	const void* RecordFileReader::GetRecordData(const uint64_t record, size_t& bytes) const {
+		const uint64_t offset = _FindFrame(record);
+		FrameHeader header;
+		_ReadFrame(offset, header);
+		bytes = header.bytes;
+		return _data + offset + sizeof(FrameHeader);
+	}
+
+	int64_t RecordFileReader::GetTimestamp(const uint64_t record) const {
+		FrameHeader header;
+		_ReadFrame(_FindFrame(record), header);
+		return header.timestamp;
+	}
+
+	BytePipeView RecordFileReader::GetRecord(const uint64_t record) const {
+		size_t bytes;
+		const void* const data = GetRecordData(record, bytes);
+		return BytePipeView(data, bytes);
+	}
+
+	uint64_t RecordFileReader::FindTimestamp(const int64_t timestamp) const {
+		// Find the first index entry that is not earlier, the record is between it and the entry before
+		size_t lower = 0u;
+		size_t upper = _index.size();
+		while (lower < upper) {
+			const size_t middle = lower + (upper - lower) / 2u;
+			if (_index[middle].timestamp < timestamp) {
+				lower = middle + 1u;
+			} else {
+				upper = middle;
+			}
+		}
+		if (lower == 0u) return 0u;
+
+		const IndexEntry& entry = _index[lower - 1u];
+		const uint64_t last = lower < _index.size() ? _index[lower].record : _record_count;
+		uint64_t offset = entry.offset;
+		FrameHeader header;
+		for (uint64_t record = entry.record; record < last; ++record) {
+			_ReadFrame(offset, header);
+			if (header.timestamp >= timestamp) return record;
+			offset += GetFrameSize(header.bytes);
+		}
+		return last;
+	}
+}
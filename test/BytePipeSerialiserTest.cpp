@@ -0,0 +1,2133 @@
+// MIT License
+// 
+// Copyright(c) 2021 Adam Smith
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <clocale>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "anvil/serialisation/AsyncPipe.hpp"
+#include "anvil/serialisation/BytePipeDeserialiser.hpp"
+#include "anvil/serialisation/BytePipeSerialiser.hpp"
+#include "anvil/serialisation/BytePipeTranscoder.hpp"
+#include "anvil/serialisation/BytePipeView.hpp"
+#include "anvil/serialisation/CompressedPipe.hpp"
+#include "anvil/serialisation/JsonDeserialiser.hpp"
+#include "anvil/serialisation/JsonSerialiser.hpp"
+#include "anvil/serialisation/ParallelReader.hpp"
+#include "anvil/serialisation/RecordFile.hpp"
+
+// Build with the sources in src/anvil/serialisation and the anvil byte-pipe headers, using C++14 or later.
+// Usage : BytePipeSerialiserTest [filter]
+// Runs every test whose name contains the filter, each value is written and then read back through
+// BytePipeDeserialiser and BytePipeView. Returns the number of tests that failed.
+
+#define ANVIL_TEST_CHECK(CONDITION) if (!(CONDITION)) throw std::runtime_error(std::string("Line ") + std::to_string(__LINE__) + " : " #CONDITION)
+
+// Every allocation from the global heap is counted, so tests can check that serialisers only use their allocator
+static std::atomic<size_t> g_heap_allocations(0u);
+
+void* operator new(size_t bytes) {
+	++g_heap_allocations;
+	void* const ptr = std::malloc(bytes > 0u ? bytes : 1u);
+	if (ptr == nullptr) throw std::bad_alloc();
+	return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+	std::free(ptr);
+}
+
+namespace {
+	using namespace anvil;
+
+	struct Point {
+		int32_t x;
+		int32_t y;
+		std::string label;
+		std::vector<double> weights;
+	};
+}
+
+ANVIL_SCHEMA(Point, ANVIL_FIELD(Point, x), ANVIL_FIELD(Point, y), ANVIL_FIELD(Point, label), ANVIL_FIELD(Point, weights))
+
+namespace {
+
+	// Pipes
+
+	class MemoryOutputPipe final : public BytePipe::OutputPipe {
+	public:
+		std::vector<uint8_t> bytes;
+
+		virtual ~MemoryOutputPipe() {}
+
+		uint32_t WriteBytes(const void* src, const uint32_t count) final {
+			const uint8_t* const src_bytes = static_cast<const uint8_t*>(src);
+			bytes.insert(bytes.end(), src_bytes, src_bytes + count);
+			return count;
+		}
+
+		void Flush() final {
+
+		}
+	};
+
+	// Returns a few bytes at a time so that values are split across reads
+	class MemoryInputPipe final : public BytePipe::InputPipe {
+	private:
+		const std::vector<uint8_t>& _bytes;
+		size_t _position;
+	public:
+		MemoryInputPipe(const std::vector<uint8_t>& bytes) :
+			_bytes(bytes),
+			_position(0u)
+		{}
+
+		virtual ~MemoryInputPipe() {}
+
+		uint32_t ReadBytes(void* dst, const uint32_t count) final {
+			size_t available = _bytes.size() - _position;
+			if (available > 7u) available = 7u;
+			const uint32_t read = count < available ? count : static_cast<uint32_t>(available);
+			memcpy(dst, _bytes.data() + _position, read);
+			_position += read;
+			return read;
+		}
+	};
+
+	// Test values
+
+	enum : uint32_t {
+		ARRAY_LENGTH = 1000u,
+		OBJECT_COUNT = 5u
+	};
+
+	const uint32_t g_modes[] = {
+		BytePipeFormat::MODE_DEFAULT,
+		BytePipeFormat::MODE_INDEXED,
+		BytePipeFormat::MODE_COMPACT,
+		BytePipeFormat::MODE_INDEXED | BytePipeFormat::MODE_COMPACT,
+		BytePipeFormat::MODE_INTERN_NAMES,
+		BytePipeFormat::MODE_COMPACT | BytePipeFormat::MODE_INTERN_NAMES,
+		BytePipeFormat::MODE_ALIGNED,
+		BytePipeFormat::MODE_ALIGNED | BytePipeFormat::MODE_INDEXED,
+		BytePipeFormat::MODE_ALIGNED | BytePipeFormat::MODE_COMPACT,
+		BytePipeFormat::MODE_ALIGNED | BytePipeFormat::MODE_COMPACT | BytePipeFormat::MODE_INTERN_NAMES
+	};
+
+	const uint8_t g_integer_codecs[] = {
+		BytePipeFormat::CODEC_NONE,
+		BytePipeFormat::CODEC_DELTA,
+		BytePipeFormat::CODEC_ZIGZAG,
+		BytePipeFormat::CODEC_BIT_PACK,
+		BytePipeFormat::CODEC_RUN_LENGTH,
+		BytePipeFormat::CODEC_DELTA | BytePipeFormat::CODEC_ZIGZAG,
+		BytePipeFormat::CODEC_DELTA | BytePipeFormat::CODEC_BIT_PACK,
+		BytePipeFormat::CODEC_DELTA | BytePipeFormat::CODEC_ZIGZAG | BytePipeFormat::CODEC_BIT_PACK,
+		BytePipeFormat::CODEC_DELTA | BytePipeFormat::CODEC_ZIGZAG | BytePipeFormat::CODEC_RUN_LENGTH
+	};
+
+	const uint8_t g_float_codecs[] = {
+		BytePipeFormat::CODEC_NONE,
+		BytePipeFormat::CODEC_XOR,
+		BytePipeFormat::CODEC_BYTE_SHUFFLE,
+		BytePipeFormat::CODEC_XOR | BytePipeFormat::CODEC_BYTE_SHUFFLE
+	};
+
+	// Slowly changing values with runs, so that the packing codecs make them smaller
+	template<class T>
+	std::vector<T> MakeValues() {
+		const int offset = std::is_signed<T>::value ? 50 : 0;
+		std::vector<T> values(ARRAY_LENGTH);
+		for (uint32_t i = 0u; i < ARRAY_LENGTH; ++i) values[i] = static_cast<T>(static_cast<int>((i / 16u) % 100u) - offset);
+		return values;
+	}
+
+	template<class T>
+	void CheckValues(const std::vector<T>& values) {
+		ANVIL_TEST_CHECK(values == MakeValues<T>());
+	}
+
+	Point MakePoint(const int32_t i) {
+		Point point;
+		point.x = i;
+		point.y = -i * 3;
+		point.label = std::string(static_cast<size_t>(i), 'p');
+		point.weights.assign(static_cast<size_t>(i) + 1u, 0.25 * i);
+		return point;
+	}
+
+	void CheckPoint(const Point& point, const int32_t i) {
+		const Point expected = MakePoint(i);
+		ANVIL_TEST_CHECK(point.x == expected.x && point.y == expected.y);
+		ANVIL_TEST_CHECK(point.label == expected.label);
+		ANVIL_TEST_CHECK(point.weights == expected.weights);
+	}
+
+	void WritePoint(BytePipeSerialiser& serialiser, const Point& point) {
+		serialiser.StartObject();
+		serialiser.SetNextMemberName("x");
+		serialiser.SetNextValueS32(point.x);
+		serialiser.SetNextMemberName("y");
+		serialiser.SetNextValueS32(point.y);
+		serialiser.SetNextMemberName("label");
+		serialiser.SetNextValueString(point.label.c_str());
+		serialiser.SetNextMemberName("weights");
+		serialiser.StartArray();
+		serialiser.SetNextValueF64(point.weights.data(), point.weights.size());
+		serialiser.EndArray();
+		serialiser.EndObject();
+	}
+
+	Point ReadPoint(BytePipeDeserialiser& deserialiser) {
+		Point point;
+		ANVIL_TEST_CHECK(deserialiser.StartObject() == 4u);
+		ANVIL_TEST_CHECK(deserialiser.GetNextMemberName() == "x");
+		point.x = deserialiser.ReadValueS32();
+		ANVIL_TEST_CHECK(deserialiser.GetNextMemberName() == "y");
+		point.y = deserialiser.ReadValueS32();
+		ANVIL_TEST_CHECK(deserialiser.GetNextMemberName() == "label");
+		point.label = deserialiser.ReadValueString();
+		ANVIL_TEST_CHECK(deserialiser.GetNextMemberName() == "weights");
+		point.weights.resize(deserialiser.StartArray());
+		deserialiser.ReadValueF64(point.weights.data(), point.weights.size());
+		deserialiser.EndArray();
+		deserialiser.EndObject();
+		return point;
+	}
+
+	// Writes one of every kind of value inside an object
+	void WriteDocument(BytePipeSerialiser& serialiser) {
+		serialiser.StartObject();
+		serialiser.SetNextMemberName("u8");
+		serialiser.SetNextValueU8(200u);
+		serialiser.SetNextMemberName("u16");
+		serialiser.SetNextValueU16(60000u);
+		serialiser.SetNextMemberName("u32");
+		serialiser.SetNextValueU32(4000000000u);
+		serialiser.SetNextMemberName("u64");
+		serialiser.SetNextValueU64(0x0123456789ABCDEFull);
+		serialiser.SetNextMemberName("s8");
+		serialiser.SetNextValueS8(-100);
+		serialiser.SetNextMemberName("s16");
+		serialiser.SetNextValueS16(-30000);
+		serialiser.SetNextMemberName("s32");
+		serialiser.SetNextValueS32(-2000000000);
+		serialiser.SetNextMemberName("s64");
+		serialiser.SetNextValueS64(-0x0123456789ABCDEFll);
+		serialiser.SetNextMemberName("f32");
+		serialiser.SetNextValueF32(1.5f);
+		serialiser.SetNextMemberName("f64");
+		serialiser.SetNextValueF64(-2.25);
+		serialiser.SetNextMemberName("string");
+		serialiser.SetNextValueString("hello world");
+		serialiser.SetNextMemberName("empty");
+		serialiser.SetNextValueString("");
+
+		const std::vector<uint16_t> u16s = MakeValues<uint16_t>();
+		serialiser.SetNextMemberName("u16s");
+		serialiser.StartArray();
+		serialiser.SetNextValueU16(u16s.data(), u16s.size());
+		serialiser.EndArray();
+
+		const std::vector<double> f64s = MakeValues<double>();
+		serialiser.SetNextMemberName("f64s");
+		serialiser.StartArray();
+		for (const double value : f64s) serialiser.SetNextValueF64(value);
+		serialiser.EndArray();
+
+		// Repeated member names are interned in MODE_INTERN_NAMES
+		serialiser.SetNextMemberName("points");
+		serialiser.StartArray();
+		for (int32_t i = 0; i < static_cast<int32_t>(OBJECT_COUNT); ++i) WritePoint(serialiser, MakePoint(i));
+		serialiser.EndArray();
+
+		serialiser.SetNextMemberName("strings");
+		serialiser.StartArray();
+		for (uint32_t i = 0u; i < OBJECT_COUNT; ++i) serialiser.SetNextValueString(std::string(i, 's').c_str());
+		serialiser.EndArray();
+
+		serialiser.SetNextMemberName("empty_array");
+		serialiser.StartArray();
+		serialiser.EndArray();
+		serialiser.EndObject();
+	}
+
+	void ReadDocument(BytePipeDeserialiser& deserialiser) {
+		ANVIL_TEST_CHECK(deserialiser.StartObject() == 17u);
+		ANVIL_TEST_CHECK(deserialiser.GetNextMemberName() == "u8");
+		ANVIL_TEST_CHECK(deserialiser.ReadValueU8() == 200u);
+		ANVIL_TEST_CHECK(deserialiser.GetNextMemberName() == "u16");
+		ANVIL_TEST_CHECK(deserialiser.ReadValueU16() == 60000u);
+		ANVIL_TEST_CHECK(deserialiser.GetNextMemberName() == "u32");
+		ANVIL_TEST_CHECK(deserialiser.ReadValueU32() == 4000000000u);
+		ANVIL_TEST_CHECK(deserialiser.GetNextMemberName() == "u64");
+		ANVIL_TEST_CHECK(deserialiser.ReadValueU64() == 0x0123456789ABCDEFull);
+		ANVIL_TEST_CHECK(deserialiser.GetNextMemberName() == "s8");
+		ANVIL_TEST_CHECK(deserialiser.ReadValueS8() == -100);
+		ANVIL_TEST_CHECK(deserialiser.GetNextMemberName() == "s16");
+		ANVIL_TEST_CHECK(deserialiser.ReadValueS16() == -30000);
+		ANVIL_TEST_CHECK(deserialiser.GetNextMemberName() == "s32");
+		ANVIL_TEST_CHECK(deserialiser.ReadValueS32() == -2000000000);
+		ANVIL_TEST_CHECK(deserialiser.GetNextMemberName() == "s64");
+		ANVIL_TEST_CHECK(deserialiser.ReadValueS64() == -0x0123456789ABCDEFll);
+		ANVIL_TEST_CHECK(deserialiser.GetNextMemberName() == "f32");
+		ANVIL_TEST_CHECK(deserialiser.ReadValueF32() == 1.5f);
+		ANVIL_TEST_CHECK(deserialiser.GetNextMemberName() == "f64");
+		ANVIL_TEST_CHECK(deserialiser.ReadValueF64() == -2.25);
+		ANVIL_TEST_CHECK(deserialiser.GetNextMemberName() == "string");
+		ANVIL_TEST_CHECK(deserialiser.ReadValueString() == "hello world");
+		ANVIL_TEST_CHECK(deserialiser.GetNextMemberName() == "empty");
+		ANVIL_TEST_CHECK(deserialiser.ReadValueString().empty());
+
+		ANVIL_TEST_CHECK(deserialiser.GetNextMemberName() == "u16s");
+		std::vector<uint16_t> u16s(deserialiser.StartArray());
+		deserialiser.ReadValueU16(u16s.data(), u16s.size());
+		deserialiser.EndArray();
+		CheckValues(u16s);
+
+		ANVIL_TEST_CHECK(deserialiser.GetNextMemberName() == "f64s");
+		std::vector<double> f64s(deserialiser.StartArray());
+		for (double& value : f64s) value = deserialiser.ReadValueF64();
+		deserialiser.EndArray();
+		CheckValues(f64s);
+
+		ANVIL_TEST_CHECK(deserialiser.GetNextMemberName() == "points");
+		ANVIL_TEST_CHECK(deserialiser.StartArray() == OBJECT_COUNT);
+		for (int32_t i = 0; i < static_cast<int32_t>(OBJECT_COUNT); ++i) CheckPoint(ReadPoint(deserialiser), i);
+		deserialiser.EndArray();
+
+		ANVIL_TEST_CHECK(deserialiser.GetNextMemberName() == "strings");
+		ANVIL_TEST_CHECK(deserialiser.StartArray() == OBJECT_COUNT);
+		for (uint32_t i = 0u; i < OBJECT_COUNT; ++i) ANVIL_TEST_CHECK(deserialiser.ReadValueString() == std::string(i, 's'));
+		deserialiser.EndArray();
+
+		ANVIL_TEST_CHECK(deserialiser.GetNextMemberName() == "empty_array");
+		ANVIL_TEST_CHECK(deserialiser.StartArray() == 0u);
+		deserialiser.EndArray();
+		deserialiser.EndObject();
+	}
+
+	// Interned names can only be resolved in stream order, so the view only looks up names written in full
+	void ViewDocument(const BytePipeView& view, const bool interned) {
+		ANVIL_TEST_CHECK(view.GetType() == Serialiser::TYPE_OBJECT);
+		ANVIL_TEST_CHECK(view.GetCount() == 17u);
+		ANVIL_TEST_CHECK(view.GetMember("u8").GetValueU8() == 200u);
+		ANVIL_TEST_CHECK(view.GetMember("u64").GetValueU64() == 0x0123456789ABCDEFull);
+		ANVIL_TEST_CHECK(view.GetMember("s16").GetValueS16() == -30000);
+		ANVIL_TEST_CHECK(view.GetMember("f32").GetValueF32() == 1.5f);
+		ANVIL_TEST_CHECK(view.GetMember("string").GetValueString() == "hello world");
+		ANVIL_TEST_CHECK(view.GetMember("missing").IsValid() == false);
+
+		const BytePipeView u16s = view.GetMember("u16s");
+		std::vector<uint16_t> values(u16s.GetCount());
+		u16s.CopyArray(values.data());
+		CheckValues(values);
+
+		const BytePipeView points = view.GetMember("points");
+		ANVIL_TEST_CHECK(points.GetCount() == OBJECT_COUNT);
+		for (uint32_t i = 0u; i < OBJECT_COUNT; ++i) {
+			const BytePipeView point = points.GetElement(i);
+			ANVIL_TEST_CHECK(point.GetCount() == 4u);
+			if (interned) continue;
+			ANVIL_TEST_CHECK(point.GetMember("y").GetValueS32() == -static_cast<int32_t>(i) * 3);
+			ANVIL_TEST_CHECK(point.GetMember("label").GetValueString() == std::string(i, 'p'));
+		}
+
+		ANVIL_TEST_CHECK(view.GetMember("strings").GetElement(3u).GetValueString() == "sss");
+		ANVIL_TEST_CHECK(view.GetMember("empty_array").GetCount() == 0u);
+	}
+
+	// Tests
+
+	void TestModes() {
+		for (const uint32_t mode : g_modes) {
+			MemoryOutputPipe pipe;
+			{
+				BytePipeSerialiser serialiser(pipe, mode);
+				WriteDocument(serialiser);
+				serialiser.SetNextValueU32(12345u);
+			}
+
+			MemoryInputPipe input(pipe.bytes);
+			BytePipeDeserialiser deserialiser(input, 64u);
+			ReadDocument(deserialiser);
+			ANVIL_TEST_CHECK(deserialiser.ReadValueU32() == 12345u);
+
+			const BytePipeView view(pipe.bytes.data(), pipe.bytes.size());
+			ViewDocument(view, (mode & BytePipeFormat::MODE_INTERN_NAMES) != 0u);
+			ANVIL_TEST_CHECK(BytePipeView(view.GetEnd(), pipe.bytes.data() + pipe.bytes.size() - static_cast<const uint8_t*>(view.GetEnd())).GetValueU32() == 12345u);
+		}
+	}
+
+	void TestSkip() {
+		for (const uint32_t mode : g_modes) {
+			MemoryOutputPipe pipe;
+			{
+				BytePipeSerialiser serialiser(pipe, mode);
+				WriteDocument(serialiser);
+				WriteDocument(serialiser);
+				serialiser.SetNextValueString("end");
+			}
+
+			// Interned names still have to be read when the value that defines them is skipped
+			MemoryInputPipe input(pipe.bytes);
+			BytePipeDeserialiser deserialiser(input, 64u);
+			deserialiser.SkipValue();
+			ReadDocument(deserialiser);
+			ANVIL_TEST_CHECK(deserialiser.ReadValueString() == "end");
+		}
+	}
+
+	void TestDocuments() {
+		for (const uint32_t mode : g_modes) {
+			MemoryOutputPipe pipe;
+			{
+				BytePipeSerialiser serialiser(pipe, mode);
+				for (int i = 0; i < 3; ++i) {
+					serialiser.BeginDocument();
+					WriteDocument(serialiser);
+					serialiser.EndDocument();
+				}
+			}
+
+			MemoryInputPipe input(pipe.bytes);
+			BytePipeDeserialiser deserialiser(input, 64u);
+			for (int i = 0; i < 3; ++i) {
+				deserialiser.BeginDocument();
+				ReadDocument(deserialiser);
+			}
+		}
+	}
+
+	inline void ReadValues(BytePipeDeserialiser& deserialiser, uint8_t* values, const size_t count) { deserialiser.ReadValueU8(values, count); }
+	inline void ReadValues(BytePipeDeserialiser& deserialiser, uint16_t* values, const size_t count) { deserialiser.ReadValueU16(values, count); }
+	inline void ReadValues(BytePipeDeserialiser& deserialiser, uint32_t* values, const size_t count) { deserialiser.ReadValueU32(values, count); }
+	inline void ReadValues(BytePipeDeserialiser& deserialiser, uint64_t* values, const size_t count) { deserialiser.ReadValueU64(values, count); }
+	inline void ReadValues(BytePipeDeserialiser& deserialiser, int8_t* values, const size_t count) { deserialiser.ReadValueS8(values, count); }
+	inline void ReadValues(BytePipeDeserialiser& deserialiser, int16_t* values, const size_t count) { deserialiser.ReadValueS16(values, count); }
+	inline void ReadValues(BytePipeDeserialiser& deserialiser, int32_t* values, const size_t count) { deserialiser.ReadValueS32(values, count); }
+	inline void ReadValues(BytePipeDeserialiser& deserialiser, int64_t* values, const size_t count) { deserialiser.ReadValueS64(values, count); }
+	inline void ReadValues(BytePipeDeserialiser& deserialiser, float* values, const size_t count) { deserialiser.ReadValueF32(values, count); }
+	inline void ReadValues(BytePipeDeserialiser& deserialiser, double* values, const size_t count) { deserialiser.ReadValueF64(values, count); }
+
+	template<class T>
+	void TestCodec(const uint32_t mode, const uint8_t codec) {
+		const std::vector<T> values = MakeValues<T>();
+		MemoryOutputPipe pipe;
+		{
+			BytePipeSerialiser serialiser(pipe, mode);
+			serialiser.StartArray(codec);
+			serialiser.SetNextValue(values.data(), static_cast<uint32_t>(values.size()));
+			serialiser.EndArray();
+		}
+
+		// The codec is only kept when it makes the values smaller, which delta and zigzag alone do not
+		const BytePipeView view(pipe.bytes.data(), pipe.bytes.size());
+		const bool packed = (codec & ~(BytePipeFormat::CODEC_DELTA | BytePipeFormat::CODEC_ZIGZAG)) != 0u;
+		ANVIL_TEST_CHECK(view.GetArrayCodec() == codec || (!packed && view.GetArrayCodec() == BytePipeFormat::CODEC_NONE));
+		if (packed) ANVIL_TEST_CHECK(pipe.bytes.size() < sizeof(T) * ARRAY_LENGTH);
+		ANVIL_TEST_CHECK(view.GetCount() == ARRAY_LENGTH);
+
+		std::vector<T> copy(ARRAY_LENGTH);
+		view.CopyArray(copy.data());
+		CheckValues(copy);
+
+		MemoryInputPipe input(pipe.bytes);
+		BytePipeDeserialiser deserialiser(input, 64u);
+		std::vector<T> read(deserialiser.StartArray());
+		for (size_t i = 0u; i < read.size(); i += 7u) ReadValues(deserialiser, read.data() + i, read.size() - i < 7u ? read.size() - i : 7u);
+		deserialiser.EndArray();
+		CheckValues(read);
+	}
+
+	void TestCodecs() {
+		for (const uint32_t mode : g_modes) {
+			for (const uint8_t codec : g_integer_codecs) {
+				TestCodec<uint8_t>(mode, codec);
+				TestCodec<uint16_t>(mode, codec);
+				TestCodec<uint32_t>(mode, codec);
+				TestCodec<uint64_t>(mode, codec);
+				TestCodec<int8_t>(mode, codec);
+				TestCodec<int16_t>(mode, codec);
+				TestCodec<int32_t>(mode, codec);
+				TestCodec<int64_t>(mode, codec);
+			}
+			for (const uint8_t codec : g_float_codecs) {
+				TestCodec<float>(mode, codec);
+				TestCodec<double>(mode, codec);
+			}
+		}
+	}
+
+	// Structs are written in the same layout as the equivalent object
+	void TestStructs() {
+		for (const uint32_t mode : g_modes) {
+			MemoryOutputPipe pipe;
+			{
+				BytePipeSerialiser serialiser(pipe, mode);
+				for (int32_t i = 0; i < static_cast<int32_t>(OBJECT_COUNT); ++i) serialiser.SetNextValueStruct(MakePoint(i));
+				for (int32_t i = 0; i < static_cast<int32_t>(OBJECT_COUNT); ++i) WritePoint(serialiser, MakePoint(i));
+			}
+
+			MemoryInputPipe input(pipe.bytes);
+			BytePipeDeserialiser deserialiser(input, 64u);
+			for (int32_t i = 0; i < static_cast<int32_t>(OBJECT_COUNT); ++i) CheckPoint(ReadPoint(deserialiser), i);
+			for (int32_t i = 0; i < static_cast<int32_t>(OBJECT_COUNT); ++i) {
+				Point point;
+				deserialiser.ReadValueStruct(point);
+				CheckPoint(point, i);
+			}
+		}
+	}
+
+	void TestColumns() {
+		for (const uint32_t mode : g_modes) {
+			std::vector<Point> rows;
+			for (int32_t i = 0; i < static_cast<int32_t>(OBJECT_COUNT); ++i) rows.push_back(MakePoint(i));
+
+			MemoryOutputPipe pipe;
+			{
+				BytePipeSerialiser serialiser(pipe, mode);
+				serialiser.SetNextValueStruct(rows[3]);
+				serialiser.SetNextValueColumns(rows, BytePipeFormat::CODEC_DELTA | BytePipeFormat::CODEC_ZIGZAG);
+			}
+
+			MemoryInputPipe input(pipe.bytes);
+			BytePipeDeserialiser deserialiser(input, 64u);
+			Point point;
+			deserialiser.ReadValueStruct(point);
+			CheckPoint(point, 3);
+
+			std::vector<Point> read;
+			deserialiser.ReadValueColumns(read);
+			ANVIL_TEST_CHECK(read.size() == OBJECT_COUNT);
+			for (int32_t i = 0; i < static_cast<int32_t>(OBJECT_COUNT); ++i) CheckPoint(read[i], i);
+		}
+	}
+
+	void TestParallelWrites() {
+		for (const uint32_t mode : g_modes) {
+			const std::vector<double> values = MakeValues<double>();
+			MemoryOutputPipe pipe;
+			{
+				BytePipeSerialiser serialiser(pipe, mode);
+				serialiser.StartArray();
+				serialiser.WriteParallel(values.size(), [&values](BytePipeSerialiser& child, const size_t i) {
+					child.SetNextValueF64(values[i]);
+				}, 4u);
+				serialiser.EndArray();
+			}
+
+			const BytePipeView view(pipe.bytes.data(), pipe.bytes.size());
+			std::vector<double> copy(view.GetCount());
+			view.CopyArray(copy.data());
+			CheckValues(copy);
+		}
+	}
+
+	void TestChunkedArrays() {
+		for (const uint32_t mode : g_modes) {
+			const std::vector<int32_t> values = MakeValues<int32_t>();
+			MemoryOutputPipe pipe;
+			{
+				BytePipeSerialiser serialiser(pipe, mode);
+				serialiser.StartChunkedArray(256u);
+				serialiser.SetNextValueS32(values.data(), values.size() / 2u);
+				for (size_t i = values.size() / 2u; i < values.size(); ++i) serialiser.SetNextValueS32(values[i]);
+				serialiser.EndArray();
+			}
+
+			const BytePipeView view(pipe.bytes.data(), pipe.bytes.size());
+			ANVIL_TEST_CHECK(view.GetCount() == ARRAY_LENGTH);
+			ANVIL_TEST_CHECK(view.GetElement(ARRAY_LENGTH - 1u).GetValueS32() == values.back());
+			std::vector<int32_t> copy(ARRAY_LENGTH);
+			view.CopyArray(copy.data());
+			CheckValues(copy);
+
+			MemoryInputPipe input(pipe.bytes);
+			BytePipeDeserialiser deserialiser(input, 64u);
+			deserialiser.StartArray();
+			std::vector<int32_t> read(ARRAY_LENGTH);
+			deserialiser.ReadValueS32(read.data(), read.size());
+			ANVIL_TEST_CHECK(deserialiser.GetRemainingCount() == 0u);
+			deserialiser.EndArray();
+			CheckValues(read);
+		}
+	}
+
+	void TestParallelChunkedArrays() {
+		for (const uint32_t mode : g_modes) {
+			const std::vector<double> values = MakeValues<double>();
+			MemoryOutputPipe pipe;
+			{
+				BytePipeSerialiser serialiser(pipe, mode);
+				serialiser.StartChunkedArray(256u);
+				serialiser.WriteParallel(values.size(), [&values](BytePipeSerialiser& child, const size_t i) {
+					child.SetNextValueF64(values[i]);
+				}, 2u);
+				serialiser.EndArray();
+			}
+
+			// Each child is larger than a segment, so it is written as a segment of its own
+			MemoryInputPipe input(pipe.bytes);
+			BytePipeDeserialiser deserialiser(input, 64u);
+			const uint32_t segment_length = deserialiser.StartArray();
+			ANVIL_TEST_CHECK(segment_length > 0u && segment_length < ARRAY_LENGTH);
+			std::vector<double> read(ARRAY_LENGTH);
+			deserialiser.ReadValueF64(read.data(), read.size());
+			deserialiser.EndArray();
+			CheckValues(read);
+		}
+	}
+
+	void TestTranscoder() {
+		for (const uint32_t mode : g_modes) {
+			MemoryOutputPipe src;
+			{
+				BytePipeSerialiser serialiser(src, mode & ~BytePipeFormat::MODE_INTERN_NAMES);
+				WriteDocument(serialiser);
+			}
+
+			// Values that keep their layout are copied as bytes
+			MemoryOutputPipe dst;
+			uint64_t copied_bytes = 0u;
+			{
+				BytePipeSerialiser serialiser(dst, mode);
+				BytePipeTranscoder transcoder(serialiser);
+				transcoder.Transcode(BytePipeView(src.bytes.data(), src.bytes.size()));
+				copied_bytes = transcoder.GetCopiedBytes();
+			}
+			ANVIL_TEST_CHECK(copied_bytes > 0u);
+
+			MemoryInputPipe input(dst.bytes);
+			BytePipeDeserialiser deserialiser(input, 64u);
+			ReadDocument(deserialiser);
+		}
+	}
+
+	// Objects in an array can refer to names interned by earlier elements, so the array cannot be copied as bytes
+	void TestInternedCopies() {
+		const uint32_t mode = BytePipeFormat::MODE_COMPACT | BytePipeFormat::MODE_INTERN_NAMES;
+		MemoryOutputPipe src;
+		{
+			BytePipeSerialiser serialiser(src, mode);
+			serialiser.StartArray();
+			for (uint32_t i = 1u; i <= 2u; ++i) {
+				serialiser.StartObject();
+				serialiser.SetNextMemberName("a");
+				serialiser.SetNextValueU32(i);
+				serialiser.EndObject();
+			}
+			serialiser.EndArray();
+		}
+		const BytePipeView view(src.bytes.data(), src.bytes.size());
+		ANVIL_TEST_CHECK(view.HasInternedNames());
+
+		// The destination has already given the first ID to another name
+		for (int transcode = 0; transcode < 2; ++transcode) {
+			MemoryOutputPipe dst;
+			BytePipeSerialiser serialiser(dst, mode);
+			serialiser.StartObject();
+			serialiser.SetNextMemberName("zz");
+			serialiser.SetNextValueU32(0u);
+			serialiser.EndObject();
+
+			bool threw = false;
+			try {
+				if (transcode) {
+					BytePipeTranscoder transcoder(serialiser);
+					transcoder.Transcode(view);
+				} else {
+					serialiser.SetNextValueRaw(view);
+				}
+			} catch (std::exception&) {
+				threw = true;
+			}
+			ANVIL_TEST_CHECK(threw);
+		}
+	}
+
+	void TestParallelReads() {
+		for (const uint32_t mode : g_modes) {
+			const char* const names[] = { "a", "b", "c", "a", "d", "a", "e", "a" };
+			MemoryOutputPipe pipe;
+			{
+				BytePipeSerialiser serialiser(pipe, mode);
+				serialiser.StartArray();
+				for (const char* name : names) {
+					serialiser.StartObject();
+					serialiser.SetNextMemberName(name);
+					serialiser.SetNextValueString(name);
+					serialiser.EndObject();
+				}
+				serialiser.EndArray();
+			}
+
+			std::vector<std::string> read_names(sizeof(names) / sizeof(names[0u]));
+			std::vector<std::string> read_values(read_names.size());
+			bool threw = false;
+			try {
+				ParallelReader::ReadElements(BytePipeView(pipe.bytes.data(), pipe.bytes.size()), [&read_names, &read_values](BytePipeDeserialiser& reader, const uint32_t index) {
+					reader.StartObject();
+					read_names[index] = reader.GetNextMemberName();
+					read_values[index] = reader.ReadValueString();
+					reader.EndObject();
+				}, 1u);
+			} catch (std::exception&) {
+				threw = true;
+			}
+
+			// Later elements refer to names interned by earlier ones, which separate readers cannot resolve
+			if (mode & BytePipeFormat::MODE_INTERN_NAMES) {
+				ANVIL_TEST_CHECK(threw);
+			} else {
+				ANVIL_TEST_CHECK(!threw);
+				for (size_t i = 0u; i < read_names.size(); ++i) ANVIL_TEST_CHECK(read_names[i] == names[i] && read_values[i] == names[i]);
+			}
+		}
+	}
+
+	// The first element has no objects, so only the later elements intern names. Each chunk of two elements
+	// starts with a new name, which a separate reader would give the ID that later refers to "beta"
+	void TestParallelReadsInternedLater() {
+		for (const uint32_t mode : g_modes) {
+			const char* const names[] = { "beta", "gamma", "delta", "epsilon", "beta", "zeta", "beta" };
+			MemoryOutputPipe pipe;
+			{
+				BytePipeSerialiser serialiser(pipe, mode);
+				serialiser.StartArray();
+				serialiser.StartArray();
+				serialiser.EndArray();
+				for (const char* name : names) {
+					serialiser.StartArray();
+					serialiser.StartObject();
+					serialiser.SetNextMemberName(name);
+					serialiser.SetNextValueString(name);
+					serialiser.EndObject();
+					serialiser.EndArray();
+				}
+				serialiser.EndArray();
+			}
+
+			std::vector<std::string> read_names(sizeof(names) / sizeof(names[0u]) + 1u);
+			bool threw = false;
+			try {
+				ParallelReader::ReadElements(BytePipeView(pipe.bytes.data(), pipe.bytes.size()), [&read_names](BytePipeDeserialiser& reader, const uint32_t index) {
+					const uint32_t count = reader.StartArray();
+					if (count > 0u) {
+						reader.StartObject();
+						read_names[index] = reader.GetNextMemberName();
+						reader.SkipValue();
+						reader.EndObject();
+					}
+					reader.EndArray();
+				}, 1u);
+			} catch (std::exception&) {
+				threw = true;
+			}
+
+			if (mode & BytePipeFormat::MODE_INTERN_NAMES) {
+				ANVIL_TEST_CHECK(threw);
+			} else {
+				ANVIL_TEST_CHECK(!threw);
+				ANVIL_TEST_CHECK(read_names[0u].empty());
+				for (size_t i = 1u; i < read_names.size(); ++i) ANVIL_TEST_CHECK(read_names[i] == names[i - 1u]);
+			}
+		}
+	}
+
+	// JSON
+
+	std::string ToJson(const std::vector<uint8_t>& bytes) {
+		return std::string(bytes.begin(), bytes.end());
+	}
+
+	// Reads JSON text into the binary format so that the types it picked can be checked
+	void JsonToBinary(const std::string& json, MemoryOutputPipe& pipe) {
+		BytePipeSerialiser serialiser(pipe);
+		JsonDeserialiser deserialiser(json.data(), json.size());
+		while (deserialiser.HasNextValue()) deserialiser.ReadValue(serialiser);
+	}
+
+	void TestJsonStrings() {
+		// Long enough that the escaped text is written to the pipe in several parts
+		std::string long_string;
+		for (size_t i = 0u; long_string.size() < 200000u; ++i) long_string += i % 7u == 0u ? "\"\\\n" : "text ";
+		const std::string strings[] = {
+			"",
+			"quote \" backslash \\ slash /",
+			"\b\f\n\r\t\x01\x1F",
+			"\xC3\xA9 \xF0\x9F\x98\x80",
+			long_string
+		};
+
+		MemoryOutputPipe json;
+		{
+			JsonSerialiser serialiser(json);
+			serialiser.StartArray();
+			for (const std::string& value : strings) serialiser.SetNextValueString(value.c_str());
+			serialiser.EndArray();
+		}
+		const std::string text = ToJson(json.bytes);
+		ANVIL_TEST_CHECK(text.find("quote \\\" backslash \\\\ slash /") != std::string::npos);
+		ANVIL_TEST_CHECK(text.find("\\u0001\\u001f") != std::string::npos);
+
+		MemoryOutputPipe binary;
+		JsonToBinary(text, binary);
+		MemoryInputPipe input(binary.bytes);
+		BytePipeDeserialiser deserialiser(input, 64u);
+		ANVIL_TEST_CHECK(deserialiser.StartArray() == sizeof(strings) / sizeof(strings[0u]));
+		for (const std::string& value : strings) ANVIL_TEST_CHECK(deserialiser.ReadValueString() == value);
+		deserialiser.EndArray();
+
+		// Characters outside of the basic plane are escaped as surrogate pairs
+		const std::string escaped = "[\"\\u00e9 \\ud83d\\ude00 \\u0041\"]";
+		MemoryOutputPipe unescaped;
+		JsonToBinary(escaped, unescaped);
+		ANVIL_TEST_CHECK(BytePipeView(unescaped.bytes.data(), unescaped.bytes.size()).GetElement(0u).GetValueString() == "\xC3\xA9 \xF0\x9F\x98\x80 A");
+	}
+
+	void CheckJsonNumbers() {
+		MemoryOutputPipe json;
+		{
+			JsonSerialiser serialiser(json);
+			serialiser.SetNextValueS64(INT64_MIN);
+			serialiser.SetNextValueS64(INT64_MAX);
+			serialiser.SetNextValueU64(UINT64_MAX);
+			serialiser.SetNextValueF64(0.1);
+			serialiser.SetNextValueF32(0.1f);
+			serialiser.SetNextValueF64(-1.5e300);
+			serialiser.SetNextValueF64(5e-324);
+			serialiser.SetNextValueF64(std::nan(""));
+			serialiser.SetNextValueF32(INFINITY);
+		}
+
+		// Floats are written with the fewest digits that read back to the same value, with '.' in any locale
+		const std::string text = ToJson(json.bytes);
+		ANVIL_TEST_CHECK(text == "-9223372036854775808\n9223372036854775807\n18446744073709551615\n0.1\n0.1\n-1.5e+300\n5e-324\nnull\nnull\n");
+
+		MemoryOutputPipe binary;
+		JsonToBinary(text, binary);
+		MemoryInputPipe input(binary.bytes);
+		BytePipeDeserialiser deserialiser(input, 64u);
+		ANVIL_TEST_CHECK(deserialiser.ReadValueS64() == INT64_MIN);
+		ANVIL_TEST_CHECK(deserialiser.ReadValueS64() == INT64_MAX);
+		ANVIL_TEST_CHECK(deserialiser.ReadValueU64() == UINT64_MAX);
+		ANVIL_TEST_CHECK(deserialiser.ReadValueF64() == 0.1);
+		ANVIL_TEST_CHECK(static_cast<float>(deserialiser.ReadValueF64()) == 0.1f);
+		ANVIL_TEST_CHECK(deserialiser.ReadValueF64() == -1.5e300);
+		ANVIL_TEST_CHECK(deserialiser.ReadValueF64() == 5e-324);
+		ANVIL_TEST_CHECK(std::isnan(deserialiser.ReadValueF64()));
+		ANVIL_TEST_CHECK(std::isnan(deserialiser.ReadValueF64()));
+	}
+
+	void TestJsonNumbers() {
+		CheckJsonNumbers();
+
+		// Repeat with a locale that uses a comma as the decimal point, if one is installed
+		const char* const locales[] = { "de_DE.UTF-8", "de_DE.utf8", "fr_FR.UTF-8", "fr_FR.utf8" };
+		for (const char* locale : locales) {
+			if (setlocale(LC_NUMERIC, locale) == nullptr) continue;
+			try {
+				CheckJsonNumbers();
+			} catch (...) {
+				setlocale(LC_NUMERIC, "C");
+				throw;
+			}
+			setlocale(LC_NUMERIC, "C");
+			break;
+		}
+	}
+
+	// Arrays of numbers are read with the one type that holds every value exactly
+	void TestJsonNumberArrays() {
+		MemoryOutputPipe binary;
+		JsonToBinary("[18446744073709551615,5] [-9223372036854775808,5] [1,0.5] [-1,18446744073709551615] [1,null]", binary);
+		const uint8_t* pos = binary.bytes.data();
+		const uint8_t* const end = pos + binary.bytes.size();
+
+		const BytePipeView u64s(pos, static_cast<size_t>(end - pos));
+		ANVIL_TEST_CHECK(u64s.GetArraySubType() == Serialiser::TYPE_UNSIGNED_64);
+		uint64_t u64_values[2u];
+		u64s.CopyArray(u64_values);
+		ANVIL_TEST_CHECK(u64_values[0u] == UINT64_MAX && u64_values[1u] == 5u);
+		pos = static_cast<const uint8_t*>(u64s.GetEnd());
+
+		const BytePipeView s64s(pos, static_cast<size_t>(end - pos));
+		ANVIL_TEST_CHECK(s64s.GetArraySubType() == Serialiser::TYPE_SIGNED_64);
+		int64_t s64_values[2u];
+		s64s.CopyArray(s64_values);
+		ANVIL_TEST_CHECK(s64_values[0u] == INT64_MIN && s64_values[1u] == 5);
+		pos = static_cast<const uint8_t*>(s64s.GetEnd());
+
+		for (int i = 0; i < 3; ++i) {
+			const BytePipeView f64s(pos, static_cast<size_t>(end - pos));
+			ANVIL_TEST_CHECK(f64s.GetArraySubType() == Serialiser::TYPE_FLOAT_64);
+			double f64_values[2u];
+			f64s.CopyArray(f64_values);
+			if (i == 0) ANVIL_TEST_CHECK(f64_values[0u] == 1.0 && f64_values[1u] == 0.5);
+			if (i == 1) ANVIL_TEST_CHECK(f64_values[0u] == -1.0 && f64_values[1u] == 18446744073709551615.0);
+			if (i == 2) ANVIL_TEST_CHECK(f64_values[0u] == 1.0 && std::isnan(f64_values[1u]));
+			pos = static_cast<const uint8_t*>(f64s.GetEnd());
+		}
+		ANVIL_TEST_CHECK(pos == end);
+	}
+
+	void TestJsonStructs() {
+		MemoryOutputPipe json;
+		{
+			JsonSerialiser serialiser(json);
+			for (int32_t i = 0; i < static_cast<int32_t>(OBJECT_COUNT); ++i) Reflection::Write(serialiser, MakePoint(i));
+		}
+
+		const std::string text = ToJson(json.bytes);
+		JsonDeserialiser deserialiser(text.data(), text.size());
+		for (int32_t i = 0; i < static_cast<int32_t>(OBJECT_COUNT); ++i) {
+			Point point;
+			deserialiser.ReadValueStruct(point);
+			CheckPoint(point, i);
+		}
+		ANVIL_TEST_CHECK(!deserialiser.HasNextValue());
+
+		// Members can be in any order, unknown ones are skipped and missing ones keep their value
+		const std::string reordered = "{\"weights\":[0.5,1],\"unknown\":{\"a\":[1,\"b\"]},\"label\":\"p\",\"x\":-7}";
+		JsonDeserialiser reordered_deserialiser(reordered.data(), reordered.size());
+		Point point;
+		point.y = 3;
+		reordered_deserialiser.ReadValueStruct(point);
+		ANVIL_TEST_CHECK(point.x == -7 && point.y == 3 && point.label == "p");
+		ANVIL_TEST_CHECK(point.weights == std::vector<double>({ 0.5, 1.0 }));
+
+		// Numbers must fit their field
+		const std::string out_of_range = "{\"x\":2147483648}";
+		JsonDeserialiser out_of_range_deserialiser(out_of_range.data(), out_of_range.size());
+		bool threw = false;
+		try {
+			out_of_range_deserialiser.ReadValueStruct(point);
+		} catch (std::exception&) {
+			threw = true;
+		}
+		ANVIL_TEST_CHECK(threw);
+	}
+
+	// Allocators
+
+	class CountingAllocator final : public Allocator {
+	public:
+		size_t allocations;
+		size_t live_bytes;
+
+		CountingAllocator() :
+			allocations(0u),
+			live_bytes(0u)
+		{}
+
+		void* Allocate(const size_t bytes) final {
+			++allocations;
+			live_bytes += bytes;
+			return Allocator::GetDefault().Allocate(bytes);
+		}
+
+		void Deallocate(void* ptr, const size_t bytes) final {
+			live_bytes -= bytes;
+			Allocator::GetDefault().Deallocate(ptr, bytes);
+		}
+	};
+
+	// Discards the bytes so that the pipe does not allocate
+	class NullOutputPipe final : public BytePipe::OutputPipe {
+	public:
+		uint64_t bytes;
+
+		NullOutputPipe() :
+			bytes(0u)
+		{}
+
+		virtual ~NullOutputPipe() {}
+
+		uint32_t WriteBytes(const void*, const uint32_t count) final {
+			bytes += count;
+			return count;
+		}
+
+		void Flush() final {
+
+		}
+	};
+
+	void TestArenaAllocator() {
+		ArenaAllocator arena(1024u);
+		ANVIL_TEST_CHECK(arena.GetCapacity() == 0u);
+
+		uint8_t* const first = static_cast<uint8_t*>(arena.Allocate(100u));
+		uint8_t* const second = static_cast<uint8_t*>(arena.Allocate(3u));
+		ANVIL_TEST_CHECK(arena.GetCapacity() == 1024u);
+		ANVIL_TEST_CHECK(reinterpret_cast<uintptr_t>(second) % alignof(std::max_align_t) == 0u);
+		ANVIL_TEST_CHECK(second > first);
+
+		// Only the most recent allocation can grow or be given back
+		ANVIL_TEST_CHECK(!arena.TryExtend(first, 100u, 200u));
+		ANVIL_TEST_CHECK(arena.TryExtend(second, 3u, 500u));
+		ANVIL_TEST_CHECK(!arena.TryExtend(second, 500u, 2000u));
+		arena.Deallocate(second, 500u);
+		ANVIL_TEST_CHECK(arena.Allocate(8u) == second);
+
+		// Allocations larger than a chunk get a chunk of their own
+		void* const large = arena.Allocate(5000u);
+		ANVIL_TEST_CHECK(large != nullptr);
+		const size_t capacity = arena.GetCapacity();
+		ANVIL_TEST_CHECK(capacity >= 1024u + 5000u);
+
+		// The chunks are kept and handed out again in the same order
+		arena.Reset();
+		ANVIL_TEST_CHECK(arena.Allocate(100u) == first);
+		ANVIL_TEST_CHECK(arena.Allocate(5000u) == large);
+		ANVIL_TEST_CHECK(arena.GetCapacity() == capacity);
+	}
+
+	void WriteRecord(BytePipeSerialiser& serialiser, const std::vector<double>& values, const uint32_t id) {
+		serialiser.BeginDocument();
+		serialiser.StartObject();
+		serialiser.SetNextMemberName("id");
+		serialiser.SetNextValueU32(id);
+		serialiser.SetNextMemberName("a member name that is too long for a short string");
+		serialiser.SetNextValueString("value");
+		serialiser.SetNextMemberName("values");
+		serialiser.StartArray();
+		serialiser.SetNextValueF64(values.data(), values.size());
+		serialiser.EndArray();
+		serialiser.SetNextMemberName("children");
+		serialiser.StartArray();
+		for (uint32_t i = 0u; i < OBJECT_COUNT; ++i) {
+			serialiser.StartObject();
+			serialiser.SetNextMemberName("index");
+			serialiser.SetNextValueU32(i);
+			serialiser.SetNextMemberName("name");
+			serialiser.SetNextValueString("child");
+			serialiser.EndObject();
+		}
+		serialiser.EndArray();
+		serialiser.EndObject();
+		serialiser.EndDocument();
+	}
+
+	// Once the buffers have grown to fit a record, writing more records allocates nothing
+	void TestSteadyStateAllocations() {
+		const std::vector<double> values = MakeValues<double>();
+		for (const uint32_t mode : g_modes) {
+			NullOutputPipe pipe;
+			CountingAllocator counter;
+			ArenaAllocator arena;
+			BytePipeSerialiser counted(pipe, mode, counter);
+			BytePipeSerialiser arena_serialiser(pipe, mode, arena);
+			for (uint32_t i = 0u; i < 2u; ++i) {
+				WriteRecord(counted, values, i);
+				WriteRecord(arena_serialiser, values, i);
+			}
+
+			const size_t allocations = counter.allocations;
+			const size_t capacity = arena.GetCapacity();
+			const size_t heap_allocations = g_heap_allocations;
+			for (uint32_t i = 0u; i < 100u; ++i) {
+				WriteRecord(counted, values, i);
+				WriteRecord(arena_serialiser, values, i);
+			}
+			ANVIL_TEST_CHECK(g_heap_allocations == heap_allocations);
+			ANVIL_TEST_CHECK(counter.allocations == allocations);
+			ANVIL_TEST_CHECK(arena.GetCapacity() == capacity);
+		}
+	}
+
+	// The children of a parallel write take their buffers from the parent's allocator
+	void TestParallelWriteAllocator() {
+		const std::vector<double> values = MakeValues<double>();
+		NullOutputPipe pipe;
+		CountingAllocator counter;
+		{
+			// Grow the parent's buffer first so that only the children allocate
+			BytePipeSerialiser serialiser(pipe, BytePipeFormat::MODE_DEFAULT, counter);
+			serialiser.StartObject();
+			serialiser.SetNextMemberName("padding");
+			serialiser.SetNextValueString(std::string(sizeof(double) * ARRAY_LENGTH * 4u, ' ').c_str());
+			serialiser.SetNextMemberName("values");
+			serialiser.StartArray();
+			const size_t allocations = counter.allocations;
+			serialiser.WriteParallel(values.size(), [&values](BytePipeSerialiser& child, const size_t i) {
+				child.SetNextValueF64(values[i]);
+			}, 4u);
+			ANVIL_TEST_CHECK(counter.allocations > allocations);
+			serialiser.EndArray();
+			serialiser.EndObject();
+		}
+		ANVIL_TEST_CHECK(counter.live_bytes == 0u);
+	}
+
+	// Array cursors
+
+	enum : uint32_t { CURSOR_LENGTH = 100000u };
+
+	std::vector<uint32_t> MakeCursorValues() {
+		std::vector<uint32_t> values(CURSOR_LENGTH);
+		for (uint32_t i = 0u; i < CURSOR_LENGTH; ++i) values[i] = i * 2654435761u;
+		return values;
+	}
+
+	// Single values and blocks larger than a reservation, so that the buffer grows while the cursor is open
+	void PushCursorValues(BytePipeSerialiser::ArrayCursor<uint32_t>& cursor, const std::vector<uint32_t>& values) {
+		size_t i = 0u;
+		while (i < values.size()) {
+			if (i % 3u == 0u) {
+				const size_t count = values.size() - i < 3000u ? values.size() - i : 3000u;
+				cursor.Push(values.data() + i, count);
+				i += count;
+			} else {
+				cursor.Push(values[i++]);
+			}
+		}
+	}
+
+	void TestArrayCursor() {
+		const std::vector<uint32_t> values = MakeCursorValues();
+		for (const uint32_t mode : g_modes) {
+			MemoryOutputPipe expected;
+			{
+				BytePipeSerialiser serialiser(expected, mode);
+				serialiser.StartObject();
+				serialiser.SetNextMemberName("values");
+				serialiser.StartArray();
+				serialiser.SetNextValueU32(values.data(), values.size());
+				serialiser.EndArray();
+				serialiser.SetNextMemberName("end");
+				serialiser.SetNextValueU32(12345u);
+				serialiser.EndObject();
+			}
+
+			// Values written before and after the cursor go into the same array
+			MemoryOutputPipe pipe;
+			{
+				BytePipeSerialiser serialiser(pipe, mode);
+				serialiser.StartObject();
+				serialiser.SetNextMemberName("values");
+				serialiser.StartArray();
+				serialiser.SetNextValueU32(values[0u]);
+				{
+					BytePipeSerialiser::ArrayCursor<uint32_t> cursor(serialiser);
+					PushCursorValues(cursor, std::vector<uint32_t>(values.begin() + 1, values.end() - 1));
+				}
+				serialiser.SetNextValueU32(values.back());
+				serialiser.EndArray();
+				serialiser.SetNextMemberName("end");
+				serialiser.SetNextValueU32(12345u);
+				serialiser.EndObject();
+			}
+			ANVIL_TEST_CHECK(pipe.bytes == expected.bytes);
+		}
+	}
+
+	void TestChunkedArrayCursor() {
+		const std::vector<uint32_t> values = MakeCursorValues();
+		for (const uint32_t mode : g_modes) {
+			MemoryOutputPipe pipe;
+			{
+				BytePipeSerialiser serialiser(pipe, mode);
+				serialiser.StartChunkedArray(10000u);
+				{
+					BytePipeSerialiser::ArrayCursor<uint32_t> cursor(serialiser);
+					PushCursorValues(cursor, values);
+
+					// Full segments are written while the cursor is still open
+					ANVIL_TEST_CHECK(pipe.bytes.size() > sizeof(uint32_t) * CURSOR_LENGTH / 2u);
+				}
+				serialiser.EndArray();
+			}
+
+			const BytePipeView view(pipe.bytes.data(), pipe.bytes.size());
+			ANVIL_TEST_CHECK(view.GetCount() == CURSOR_LENGTH);
+			ANVIL_TEST_CHECK(view.GetElement(CURSOR_LENGTH - 1u).GetValueU32() == values.back());
+			std::vector<uint32_t> copy(CURSOR_LENGTH);
+			view.CopyArray(copy.data());
+			ANVIL_TEST_CHECK(copy == values);
+
+			MemoryInputPipe input(pipe.bytes);
+			BytePipeDeserialiser deserialiser(input, 64u);
+			deserialiser.StartArray();
+			std::vector<uint32_t> read(CURSOR_LENGTH);
+			deserialiser.ReadValueU32(read.data(), read.size());
+			ANVIL_TEST_CHECK(deserialiser.GetRemainingCount() == 0u);
+			deserialiser.EndArray();
+			ANVIL_TEST_CHECK(read == values);
+		}
+	}
+
+	void TestEncodedArrayCursor() {
+		const std::vector<int32_t> values = MakeValues<int32_t>();
+		for (const uint32_t mode : g_modes) {
+			for (const uint8_t codec : g_integer_codecs) {
+				MemoryOutputPipe expected;
+				{
+					BytePipeSerialiser serialiser(expected, mode);
+					serialiser.StartArray(codec);
+					serialiser.SetNextValueS32(values.data(), values.size());
+					serialiser.EndArray();
+				}
+
+				MemoryOutputPipe pipe;
+				{
+					BytePipeSerialiser serialiser(pipe, mode);
+					serialiser.StartArray(codec);
+					BytePipeSerialiser::ArrayCursor<int32_t> cursor(serialiser);
+					for (const int32_t value : values) cursor.Push(value);
+					cursor.Close();
+					serialiser.EndArray();
+				}
+				ANVIL_TEST_CHECK(pipe.bytes == expected.bytes);
+
+				std::vector<int32_t> copy(ARRAY_LENGTH);
+				BytePipeView(pipe.bytes.data(), pipe.bytes.size()).CopyArray(copy.data());
+				CheckValues(copy);
+			}
+		}
+	}
+
+	template<class F>
+	bool Throws(const F& function) {
+		try {
+			function();
+		} catch (std::exception&) {
+			return true;
+		}
+		return false;
+	}
+
+	void TestArrayCursorErrors() {
+		MemoryOutputPipe pipe;
+		{
+			BytePipeSerialiser serialiser(pipe);
+			ANVIL_TEST_CHECK(Throws([&serialiser]() { BytePipeSerialiser::ArrayCursor<uint32_t> cursor(serialiser); }));
+			serialiser.StartObject();
+			ANVIL_TEST_CHECK(Throws([&serialiser]() { BytePipeSerialiser::ArrayCursor<uint32_t> cursor(serialiser); }));
+			serialiser.SetNextMemberName("values");
+			serialiser.StartArray();
+			serialiser.SetNextValueU32(1u);
+			ANVIL_TEST_CHECK(Throws([&serialiser]() { BytePipeSerialiser::ArrayCursor<float> cursor(serialiser); }));
+
+			// Nothing else can be written until the cursor is closed, the values pushed so far are kept
+			{
+				BytePipeSerialiser::ArrayCursor<uint32_t> cursor(serialiser);
+				cursor.Push(2u);
+				ANVIL_TEST_CHECK(Throws([&serialiser]() { BytePipeSerialiser::ArrayCursor<uint32_t> cursor(serialiser); }));
+				ANVIL_TEST_CHECK(Throws([&serialiser]() { serialiser.SetNextValueU32(3u); }));
+				ANVIL_TEST_CHECK(Throws([&serialiser]() { serialiser.StartArray(); }));
+				ANVIL_TEST_CHECK(Throws([&serialiser]() { serialiser.EndArray(); }));
+				ANVIL_TEST_CHECK(Throws([&serialiser]() { serialiser.Reset(); }));
+				cursor.Push(3u);
+			}
+			serialiser.SetNextValueU32(4u);
+			serialiser.EndArray();
+			serialiser.EndObject();
+		}
+
+		const BytePipeView values = BytePipeView(pipe.bytes.data(), pipe.bytes.size()).GetMember("values");
+		ANVIL_TEST_CHECK(values.GetCount() == 4u);
+		for (uint32_t i = 0u; i < 4u; ++i) ANVIL_TEST_CHECK(values.GetElement(i).GetValueU32() == i + 1u);
+	}
+
+	// Referenced arrays
+
+	// Records each call so that the test can see which fragments came from the caller's memory
+	class GatherMemoryPipe final : public GatherOutputPipe {
+	public:
+		std::vector<uint8_t> bytes;
+		std::vector<const void*> fragments;
+		size_t gathers;
+
+		GatherMemoryPipe() :
+			gathers(0u)
+		{}
+
+		virtual ~GatherMemoryPipe() {}
+
+		void WriteGather(const Fragment* src, const size_t count) final {
+			++gathers;
+			for (size_t i = 0u; i < count; ++i) {
+				fragments.push_back(src[i].data);
+				WriteBytes(src[i].data, static_cast<uint32_t>(src[i].bytes));
+			}
+		}
+
+		uint32_t WriteBytes(const void* src, const uint32_t count) final {
+			const uint8_t* const src_bytes = static_cast<const uint8_t*>(src);
+			bytes.insert(bytes.end(), src_bytes, src_bytes + count);
+			return count;
+		}
+
+		void Flush() final {
+
+		}
+	};
+
+	struct ReferencedValues {
+		std::vector<uint8_t> small;
+		std::vector<std::vector<double>> weights;
+		std::vector<uint32_t> nested;
+		std::vector<uint32_t> encoded;
+		std::vector<uint8_t> raw;
+
+		ReferencedValues(const uint32_t mode) :
+			small(8u, 7u),
+			nested(MakeValues<uint32_t>()),
+			encoded(MakeValues<uint32_t>())
+		{
+			for (uint32_t i = 0u; i < OBJECT_COUNT; ++i) weights.push_back(std::vector<double>(i + 5u, 0.5 * i));
+
+			MemoryOutputPipe pipe;
+			{
+				BytePipeSerialiser serialiser(pipe, mode & ~BytePipeFormat::MODE_INTERN_NAMES);
+				const std::vector<uint16_t> u16s = MakeValues<uint16_t>();
+				serialiser.StartArray();
+				serialiser.SetNextValueU16(u16s.data(), 100u);
+				serialiser.EndArray();
+			}
+			raw = pipe.bytes;
+		}
+	};
+
+	// Every referenced array must stay alive until the document ends, small containers hold arrays over the threshold.
+	// The member names differ from WriteDocument so that its view can look them up when they are written after this.
+	void WriteReferencedDocument(BytePipeSerialiser& serialiser, const ReferencedValues& values) {
+		serialiser.StartObject();
+		serialiser.SetNextMemberName("small");
+		serialiser.StartArray();
+		serialiser.SetNextValueU8(values.small.data(), values.small.size());
+		serialiser.EndArray();
+
+		serialiser.SetNextMemberName("objects");
+		serialiser.StartArray();
+		for (uint32_t i = 0u; i < OBJECT_COUNT; ++i) {
+			serialiser.StartObject();
+			serialiser.SetNextMemberName("x");
+			serialiser.SetNextValueU32(i);
+			serialiser.SetNextMemberName("weights");
+			serialiser.StartArray();
+			serialiser.SetNextValueF64(values.weights[i].data(), values.weights[i].size());
+			serialiser.EndArray();
+			serialiser.EndObject();
+		}
+		serialiser.EndArray();
+
+		serialiser.SetNextMemberName("nested");
+		serialiser.StartArray();
+		for (uint32_t i = 0u; i < 3u; ++i) {
+			serialiser.StartArray();
+			serialiser.SetNextValueU32(values.nested.data() + i * 10u, 5u);
+			serialiser.EndArray();
+		}
+		serialiser.StartArray();
+		serialiser.SetNextValueU32(values.nested.data(), values.nested.size());
+		serialiser.EndArray();
+		serialiser.EndArray();
+
+		serialiser.SetNextMemberName("encoded");
+		serialiser.StartArray(BytePipeFormat::CODEC_BIT_PACK);
+		serialiser.SetNextValueU32(values.encoded.data(), values.encoded.size());
+		serialiser.EndArray();
+
+		serialiser.SetNextMemberName("raw");
+		serialiser.SetNextValueRaw(BytePipeView(values.raw.data(), values.raw.size()));
+
+		serialiser.SetNextMemberName("end");
+		serialiser.SetNextValueU32(12345u);
+		serialiser.EndObject();
+	}
+
+	std::string BinaryToJson(const std::vector<uint8_t>& bytes) {
+		MemoryInputPipe input(bytes);
+		BytePipeDeserialiser deserialiser(input, 64u);
+		MemoryOutputPipe json;
+		{
+			JsonSerialiser serialiser(json);
+			deserialiser.ReadValue(serialiser);
+			deserialiser.ReadValue(serialiser);
+		}
+		return ToJson(json.bytes);
+	}
+
+	void TestReferencedArrays() {
+		for (const uint32_t mode : g_modes) {
+			const ReferencedValues values(mode);
+
+			MemoryOutputPipe copied;
+			{
+				BytePipeSerialiser serialiser(copied, mode);
+				WriteReferencedDocument(serialiser, values);
+				WriteDocument(serialiser);
+			}
+			const std::string expected = BinaryToJson(copied.bytes);
+
+			// Big-endian hosts copy arrays wider than a byte so that they can be swapped, raw values are still referenced
+			const bool swapped = ANVIL_SERIALISATION_BIG_ENDIAN != 0;
+
+			// The weights in WriteDocument are temporaries, so they must stay under the threshold
+			for (const size_t threshold : { static_cast<size_t>(41u), static_cast<size_t>(1024u) }) {
+				GatherMemoryPipe gather;
+				MemoryOutputPipe plain;
+				for (int pipe = 0; pipe < 2; ++pipe) {
+					std::vector<uint8_t>& bytes = pipe == 0 ? gather.bytes : plain.bytes;
+					{
+						BytePipeSerialiser serialiser(pipe == 0 ? static_cast<BytePipe::OutputPipe&>(gather) : static_cast<BytePipe::OutputPipe&>(plain), mode);
+						serialiser.SetReferenceThreshold(threshold);
+						WriteReferencedDocument(serialiser, values);
+						WriteDocument(serialiser);
+					}
+
+					ANVIL_TEST_CHECK(BinaryToJson(bytes) == expected);
+
+					// Small compact containers that hold a reference are not shrunk, otherwise the bytes are the same as copying
+					if ((mode & (BytePipeFormat::MODE_COMPACT | BytePipeFormat::MODE_ALIGNED)) == BytePipeFormat::MODE_COMPACT) {
+						if (!swapped) ANVIL_TEST_CHECK(bytes.size() > copied.bytes.size());
+					} else {
+						ANVIL_TEST_CHECK(bytes == copied.bytes);
+					}
+
+					// Names in the second document were interned by the first, and interned names cannot be looked up by a view
+					const BytePipeView view(bytes.data(), bytes.size());
+					const bool interned = (mode & BytePipeFormat::MODE_INTERN_NAMES) != 0u;
+					if (!interned) {
+						ANVIL_TEST_CHECK(view.GetMember("objects").GetElement(4u).GetMember("weights").GetElement(5u).GetValueF64() == 2.0);
+						ANVIL_TEST_CHECK(view.GetMember("nested").GetElement(3u).GetElement(999u).GetValueU32() == values.nested[999u]);
+						ANVIL_TEST_CHECK(view.GetMember("raw").GetElement(99u).GetValueU16() == MakeValues<uint16_t>()[99u]);
+						ANVIL_TEST_CHECK(view.GetMember("end").GetValueU32() == 12345u);
+					}
+					ViewDocument(BytePipeView(view.GetEnd(), bytes.data() + bytes.size() - static_cast<const uint8_t*>(view.GetEnd())), interned);
+
+					MemoryInputPipe input(bytes);
+					BytePipeDeserialiser deserialiser(input, 64u);
+					deserialiser.SkipValue();
+					ReadDocument(deserialiser);
+				}
+
+				// Gather pipes are given the arrays where the caller left them, encoded arrays are always copied
+				ANVIL_TEST_CHECK(gather.gathers == (swapped ? (threshold <= values.raw.size() ? 1u : 0u) : 2u));
+				const auto Gathered = [&gather](const void* data)->bool {
+					return std::find(gather.fragments.begin(), gather.fragments.end(), data) != gather.fragments.end();
+				};
+				ANVIL_TEST_CHECK(Gathered(values.nested.data()) == !swapped);
+				ANVIL_TEST_CHECK(Gathered(values.raw.data()) == (threshold <= values.raw.size()));
+				ANVIL_TEST_CHECK(Gathered(values.weights[4u].data()) == (!swapped && threshold == 41u));
+				ANVIL_TEST_CHECK(!Gathered(values.small.data()));
+				ANVIL_TEST_CHECK(!Gathered(values.encoded.data()));
+			}
+		}
+	}
+
+	// Compression
+
+	// Half of the bytes repeat so that LZ finds matches, the rest are noise that is stored uncompressed
+	std::vector<uint8_t> MakeCompressionInput(const size_t count) {
+		std::vector<uint8_t> bytes(count);
+		uint32_t state = 12345u;
+		for (size_t i = 0u; i < count; ++i) {
+			state = state * 1103515245u + 12345u;
+			bytes[i] = (i / 3000u) % 2u == 0u ? static_cast<uint8_t>(i % 17u) : static_cast<uint8_t>(state >> 24u);
+		}
+		return bytes;
+	}
+
+	std::vector<uint8_t> Decompress(const std::vector<uint8_t>& compressed) {
+		MemoryInputPipe upstream(compressed);
+		CompressedInputPipe input(upstream);
+		std::vector<uint8_t> bytes;
+		uint8_t block[1000u];
+		uint32_t read;
+		while ((read = input.ReadBytes(block, sizeof(block))) > 0u) bytes.insert(bytes.end(), block, block + read);
+		return bytes;
+	}
+
+	bool DecompressThrows(const std::vector<uint8_t>& compressed, const char* message) {
+		try {
+			Decompress(compressed);
+		} catch (std::exception& e) {
+			return strstr(e.what(), message) != nullptr;
+		}
+		return false;
+	}
+
+	void TestCompressedPipe() {
+		enum : uint32_t { BLOCK_SIZE = 1000u };
+		const std::vector<uint8_t> input = MakeCompressionInput(25000u);
+
+		std::vector<uint8_t> expected;
+		for (const uint32_t threads : { 0u, 1u, 4u }) {
+			MemoryOutputPipe pipe;
+			{
+				CompressedOutputPipe output(pipe, BLOCK_SIZE, threads);
+
+				// Odd write sizes cross the block boundaries, flushing part way through writes a short block
+				size_t offset = 0u;
+				for (uint32_t i = 0u; offset < input.size(); ++i) {
+					uint32_t count = 1u + (i * 977u) % 2500u;
+					if (count > input.size() - offset) count = static_cast<uint32_t>(input.size() - offset);
+					ANVIL_TEST_CHECK(output.WriteBytes(input.data() + offset, count) == count);
+					offset += count;
+					if (i == 7u) output.Flush();
+				}
+				output.Flush();
+			}
+
+			// Frames are written in stream order whichever thread compressed them
+			if (threads == 0u) expected = pipe.bytes;
+			else ANVIL_TEST_CHECK(pipe.bytes == expected);
+			ANVIL_TEST_CHECK(pipe.bytes.size() < input.size());
+			ANVIL_TEST_CHECK(Decompress(pipe.bytes) == input);
+
+			size_t frames = 0u;
+			bool compressed = false;
+			for (size_t position = 0u; position < pipe.bytes.size(); ++frames) {
+				BlockCompression::Codec codec;
+				uint32_t raw_size, stored_size, checksum;
+				BlockCompression::ReadFrameHeader(pipe.bytes.data() + position, codec, raw_size, stored_size, checksum);
+				ANVIL_TEST_CHECK(raw_size <= BLOCK_SIZE);
+				if (codec == BlockCompression::COMPRESSION_LZ) compressed = true;
+				position += BlockCompression::FRAME_HEADER_SIZE + stored_size;
+				ANVIL_TEST_CHECK(position <= pipe.bytes.size());
+			}
+			ANVIL_TEST_CHECK(frames == input.size() / BLOCK_SIZE + 1u);
+			ANVIL_TEST_CHECK(compressed);
+		}
+
+		// A serialised document read back through the compressed stream
+		for (const uint32_t mode : g_modes) {
+			MemoryOutputPipe pipe;
+			{
+				CompressedOutputPipe output(pipe, 100u, 2u);
+				BytePipeSerialiser serialiser(output, mode);
+				WriteDocument(serialiser);
+				output.Flush();
+			}
+
+			MemoryInputPipe upstream(pipe.bytes);
+			CompressedInputPipe input(upstream);
+			BytePipeDeserialiser deserialiser(input, 64u);
+			ReadDocument(deserialiser);
+		}
+	}
+
+	void TestCompressionErrors() {
+		const std::vector<uint8_t> input = MakeCompressionInput(6000u);
+
+		std::vector<uint8_t> frames;
+		BlockCompression::WriteFrame(input.data(), 3000u, BlockCompression::COMPRESSION_LZ, frames);
+		const size_t second_frame = frames.size();
+		BlockCompression::WriteFrame(input.data() + 3000u, 3000u, BlockCompression::COMPRESSION_LZ, frames);
+		ANVIL_TEST_CHECK(frames[0u] == BlockCompression::COMPRESSION_LZ);
+		ANVIL_TEST_CHECK(frames[second_frame] == BlockCompression::COMPRESSION_NONE);
+		ANVIL_TEST_CHECK(Decompress(frames) == input);
+
+		// A corrupted stored block or checksum is caught after decompressing
+		std::vector<uint8_t> corrupted = frames;
+		corrupted[second_frame + BlockCompression::FRAME_HEADER_SIZE + 100u] ^= 1u;
+		ANVIL_TEST_CHECK(DecompressThrows(corrupted, "Checksum does not match"));
+
+		corrupted = frames;
+		corrupted[9u] ^= 1u;
+		ANVIL_TEST_CHECK(DecompressThrows(corrupted, "Checksum does not match"));
+
+		// The stream can end between frames but not inside one
+		ANVIL_TEST_CHECK(Decompress(std::vector<uint8_t>(frames.begin(), frames.begin() + second_frame)) == std::vector<uint8_t>(input.begin(), input.begin() + 3000u));
+		ANVIL_TEST_CHECK(DecompressThrows(std::vector<uint8_t>(frames.begin(), frames.end() - 1), "Frame is truncated"));
+		ANVIL_TEST_CHECK(DecompressThrows(std::vector<uint8_t>(frames.begin(), frames.begin() + second_frame + 5u), "Frame is truncated"));
+		ANVIL_TEST_CHECK(DecompressThrows(std::vector<uint8_t>(frames.begin(), frames.begin() + second_frame - 1u), "Frame is truncated"));
+
+		// A frame whose header claims more than the LZ payload holds
+		corrupted = std::vector<uint8_t>(frames.begin(), frames.begin() + second_frame);
+		corrupted[1u] = static_cast<uint8_t>(corrupted[1u] + 1u);
+		bool threw = false;
+		try {
+			Decompress(corrupted);
+		} catch (std::exception&) {
+			threw = true;
+		}
+		ANVIL_TEST_CHECK(threw);
+	}
+
+	// Async pipe
+
+	// Written to by the I/O thread, it can hold each write until it is opened or throw once enough bytes are written
+	class ControlledOutputPipe final : public BytePipe::OutputPipe {
+	public:
+		std::vector<uint8_t> bytes;
+		std::atomic<uint32_t> flushes;
+		std::atomic<bool> open;
+		size_t flushed_size;
+		size_t fail_size;
+
+		ControlledOutputPipe() :
+			flushes(0u),
+			open(true),
+			flushed_size(0u),
+			fail_size(SIZE_MAX)
+		{}
+
+		virtual ~ControlledOutputPipe() {}
+
+		uint32_t WriteBytes(const void* src, const uint32_t count) final {
+			while (!open.load()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			if (bytes.size() + count > fail_size) throw std::runtime_error("ControlledOutputPipe::WriteBytes : Write failed");
+			const uint8_t* const src_bytes = static_cast<const uint8_t*>(src);
+			bytes.insert(bytes.end(), src_bytes, src_bytes + count);
+			return count;
+		}
+
+		void Flush() final {
+			flushed_size = bytes.size();
+			++flushes;
+		}
+	};
+
+	void TestAsyncPipe() {
+		const std::vector<uint8_t> input = MakeCompressionInput(5000u);
+
+		ControlledOutputPipe downstream;
+		{
+			AsyncOutputPipe output(downstream, 64u, 3u);
+			size_t offset = 0u;
+			for (uint32_t i = 0u; offset < input.size(); ++i) {
+				uint32_t count = i % 5u == 4u ? 200u : 2u * i + 1u;
+				if (count > input.size() - offset) count = static_cast<uint32_t>(input.size() - offset);
+				ANVIL_TEST_CHECK(output.WriteBytes(input.data() + offset, count) == count);
+				offset += count;
+
+				// Flush returns once everything written so far has reached the downstream pipe and it was flushed
+				if (i == 13u) {
+					output.Flush();
+					ANVIL_TEST_CHECK(downstream.flushes == 1u);
+					ANVIL_TEST_CHECK(downstream.flushed_size == offset);
+					ANVIL_TEST_CHECK(downstream.bytes == std::vector<uint8_t>(input.begin(), input.begin() + offset));
+					ANVIL_TEST_CHECK(output.GetQueueDepth() == 0u);
+				}
+			}
+			output.Flush();
+			ANVIL_TEST_CHECK(downstream.flushes == 2u);
+			ANVIL_TEST_CHECK(downstream.bytes == input);
+			ANVIL_TEST_CHECK(output.GetMaxQueueDepth() <= 3u);
+		}
+
+		// The destructor flushes whatever is left
+		downstream.bytes.clear();
+		{
+			AsyncOutputPipe output(downstream, 64u, 2u);
+			output.WriteBytes(input.data(), 100u);
+		}
+		ANVIL_TEST_CHECK(downstream.bytes == std::vector<uint8_t>(input.begin(), input.begin() + 100u));
+	}
+
+	void TestAsyncPipeErrors() {
+		const std::vector<uint8_t> input = MakeCompressionInput(1000u);
+
+		// The error is thrown by the next WriteBytes once the I/O thread has seen it
+		{
+			ControlledOutputPipe downstream;
+			downstream.fail_size = 100u;
+			AsyncOutputPipe output(downstream, 64u, 4u);
+			output.WriteBytes(input.data(), 128u);
+			while (output.GetQueueDepth() > 0u) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+			bool threw = false;
+			try {
+				output.WriteBytes(input.data(), 1u);
+			} catch (std::exception& e) {
+				threw = strstr(e.what(), "Write failed") != nullptr;
+			}
+			ANVIL_TEST_CHECK(threw);
+			ANVIL_TEST_CHECK(downstream.bytes.size() == 64u);
+		}
+
+		// Flush waits for the failing buffer and throws, later buffers are not written
+		{
+			ControlledOutputPipe downstream;
+			downstream.fail_size = 100u;
+			AsyncOutputPipe output(downstream, 64u, 4u);
+			output.WriteBytes(input.data(), 150u);
+
+			bool threw = false;
+			try {
+				output.Flush();
+			} catch (std::exception& e) {
+				threw = strstr(e.what(), "Write failed") != nullptr;
+			}
+			ANVIL_TEST_CHECK(threw);
+			ANVIL_TEST_CHECK(downstream.bytes.size() == 64u);
+			ANVIL_TEST_CHECK(downstream.flushes == 0u);
+
+			threw = false;
+			try {
+				output.Flush();
+			} catch (std::exception&) {
+				threw = true;
+			}
+			ANVIL_TEST_CHECK(threw);
+		}
+	}
+
+	void TestAsyncPipeCounters() {
+		const std::vector<uint8_t> input = MakeCompressionInput(256u);
+
+		ControlledOutputPipe downstream;
+		downstream.open = false;
+		AsyncOutputPipe output(downstream, 64u, 2u);
+		ANVIL_TEST_CHECK(output.GetQueueDepth() == 0u);
+
+		// The first buffer is held by the downstream pipe, the writer can fill the second without waiting
+		output.WriteBytes(input.data(), 64u);
+		ANVIL_TEST_CHECK(output.GetQueueDepth() == 1u);
+		ANVIL_TEST_CHECK(output.GetStallCount() == 0u);
+
+		// Handing over the second buffer leaves none free, so the writer waits until the first is written
+		std::thread opener([&downstream]() {
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			downstream.open = true;
+		});
+		output.WriteBytes(input.data() + 64u, 64u);
+		opener.join();
+		ANVIL_TEST_CHECK(output.GetMaxQueueDepth() == 2u);
+		ANVIL_TEST_CHECK(output.GetStallCount() == 1u);
+		ANVIL_TEST_CHECK(output.GetStallTime() >= 10000000u);
+
+		output.WriteBytes(input.data() + 128u, 128u);
+		output.Flush();
+		ANVIL_TEST_CHECK(output.GetQueueDepth() == 0u);
+		ANVIL_TEST_CHECK(output.GetMaxQueueDepth() == 2u);
+		ANVIL_TEST_CHECK(downstream.bytes == input);
+	}
+
+	// Record files
+
+	const char* const g_record_path = "BytePipeSerialiserTest.records";
+	const char* const g_record_copy_path = "BytePipeSerialiserTest.copy.records";
+
+	std::vector<uint8_t> ReadFile(const char* path) {
+		std::vector<uint8_t> bytes;
+		FILE* const file = fopen(path, "rb");
+		if (file == nullptr) throw std::runtime_error("ReadFile : Failed to open file");
+		uint8_t block[4096u];
+		size_t read;
+		while ((read = fread(block, 1u, sizeof(block), file)) > 0u) bytes.insert(bytes.end(), block, block + read);
+		fclose(file);
+		return bytes;
+	}
+
+	void WriteFile(const char* path, const uint8_t* bytes, const size_t count) {
+		FILE* const file = fopen(path, "wb");
+		if (file == nullptr) throw std::runtime_error("WriteFile : Failed to open file");
+		const size_t written = fwrite(bytes, 1u, count, file);
+		fclose(file);
+		if (written != count) throw std::runtime_error("WriteFile : Failed to write file");
+	}
+
+	// Each record holds its value and a string whose length depends on it, so that the frames have different sizes
+	void AppendRecord(RecordFileWriter& writer, RecordFileWriter::Record& record, const uint64_t value, const int64_t timestamp) {
+		{
+			BytePipeSerialiser serialiser(record);
+			serialiser.StartObject();
+			serialiser.SetNextMemberName("value");
+			serialiser.SetNextValueU64(value);
+			serialiser.SetNextMemberName("padding");
+			serialiser.SetNextValueString(std::string(static_cast<size_t>(value % 37u), 'r').c_str());
+			serialiser.EndObject();
+		}
+		writer.Append(record, timestamp);
+	}
+
+	void CheckRecord(const RecordFileReader& reader, const uint64_t record, const uint64_t value) {
+		const BytePipeView view = reader.GetRecord(record);
+		ANVIL_TEST_CHECK(view.GetMember("value").GetValueU64() == value);
+		ANVIL_TEST_CHECK(view.GetMember("padding").GetValueString() == std::string(static_cast<size_t>(value % 37u), 'r'));
+
+		size_t bytes;
+		const void* const data = reader.GetRecordData(record, bytes);
+		ANVIL_TEST_CHECK(reinterpret_cast<uintptr_t>(data) % RecordFileFormat::FRAME_ALIGNMENT == 0u);
+	}
+
+	void TestMemoryMappedFile() {
+		const uint8_t bytes[] = { 1u, 2u, 3u, 4u, 5u };
+		WriteFile(g_record_path, bytes, sizeof(bytes));
+		{
+			const MemoryMappedFile file(g_record_path);
+			ANVIL_TEST_CHECK(file.GetSize() == sizeof(bytes));
+			ANVIL_TEST_CHECK(memcmp(file.GetData(), bytes, sizeof(bytes)) == 0);
+		}
+
+		WriteFile(g_record_path, bytes, 0u);
+		{
+			const MemoryMappedFile file(g_record_path);
+			ANVIL_TEST_CHECK(file.GetSize() == 0u);
+		}
+		std::remove(g_record_path);
+
+		bool threw = false;
+		try {
+			const MemoryMappedFile file(g_record_path);
+		} catch (std::exception&) {
+			threw = true;
+		}
+		ANVIL_TEST_CHECK(threw);
+	}
+
+	void TestRecordFileConcurrentAppends() {
+		enum : uint64_t {
+			THREADS = 4u,
+			RECORDS_PER_THREAD = 250u
+		};
+
+		{
+			RecordFileWriter writer(g_record_path, false, 16u);
+			std::vector<std::thread> threads;
+			for (uint64_t t = 0u; t < THREADS; ++t) {
+				threads.emplace_back([&writer, t]() {
+					RecordFileWriter::Record record;
+					for (uint64_t i = 0u; i < RECORDS_PER_THREAD; ++i) AppendRecord(writer, record, t * RECORDS_PER_THREAD + i, 0);
+				});
+			}
+			for (std::thread& thread : threads) thread.join();
+			ANVIL_TEST_CHECK(writer.GetRecordCount() == THREADS * RECORDS_PER_THREAD);
+			writer.Close();
+		}
+
+		// Records are numbered in the order they were reserved, so each value is found once at some position
+		const RecordFileReader reader(g_record_path);
+		ANVIL_TEST_CHECK(reader.IsComplete());
+		ANVIL_TEST_CHECK(reader.GetRecordCount() == THREADS * RECORDS_PER_THREAD);
+		std::vector<bool> found(THREADS * RECORDS_PER_THREAD, false);
+		for (uint64_t i = reader.GetRecordCount(); i > 0u; --i) {
+			const uint64_t value = reader.GetRecord(i - 1u).GetMember("value").GetValueU64();
+			ANVIL_TEST_CHECK(value < found.size() && !found[value]);
+			found[value] = true;
+			CheckRecord(reader, i - 1u, value);
+		}
+	}
+
+	void TestRecordFileTimestamps() {
+		enum : uint64_t { RECORD_COUNT = 100u };
+		{
+			RecordFileWriter writer(g_record_path, false, 8u);
+			RecordFileWriter::Record record;
+			for (uint64_t i = 0u; i < RECORD_COUNT; ++i) AppendRecord(writer, record, i, 100 + static_cast<int64_t>(i / 2u) * 10);
+		}
+
+		const RecordFileReader reader(g_record_path);
+		ANVIL_TEST_CHECK(reader.GetRecordCount() == RECORD_COUNT);
+		ANVIL_TEST_CHECK(reader.GetTimestamp(37u) == 280);
+		ANVIL_TEST_CHECK(reader.FindTimestamp(INT64_MIN) == 0u);
+		ANVIL_TEST_CHECK(reader.FindTimestamp(100) == 0u);
+		ANVIL_TEST_CHECK(reader.FindTimestamp(101) == 2u);
+		ANVIL_TEST_CHECK(reader.FindTimestamp(280) == 36u);
+		ANVIL_TEST_CHECK(reader.FindTimestamp(285) == 38u);
+		ANVIL_TEST_CHECK(reader.FindTimestamp(590) == 98u);
+		ANVIL_TEST_CHECK(reader.FindTimestamp(591) == RECORD_COUNT);
+		for (uint64_t i = 0u; i < RECORD_COUNT; ++i) ANVIL_TEST_CHECK(reader.FindTimestamp(reader.GetTimestamp(i)) == i - i % 2u);
+	}
+
+	void TestRecordFileAppend() {
+		{
+			RecordFileWriter writer(g_record_path, false, 8u);
+			RecordFileWriter::Record record;
+			for (uint64_t i = 0u; i < 20u; ++i) AppendRecord(writer, record, i, static_cast<int64_t>(i));
+			writer.Close();
+
+			// Appending after the writer is closed throws
+			bool threw = false;
+			try {
+				AppendRecord(writer, record, 20u, 20);
+			} catch (std::exception&) {
+				threw = true;
+			}
+			ANVIL_TEST_CHECK(threw);
+		}
+
+		// Reopening a closed file replaces its footer and keeps its index interval
+		{
+			RecordFileWriter writer(g_record_path, true, 64u);
+			ANVIL_TEST_CHECK(writer.GetRecordCount() == 20u);
+			RecordFileWriter::Record record;
+			for (uint64_t i = 20u; i < 45u; ++i) AppendRecord(writer, record, i, static_cast<int64_t>(i));
+		}
+
+		const RecordFileReader reader(g_record_path);
+		ANVIL_TEST_CHECK(reader.IsComplete());
+		ANVIL_TEST_CHECK(reader.GetRecordCount() == 45u);
+		for (uint64_t i = 0u; i < 45u; ++i) {
+			CheckRecord(reader, i, i);
+			ANVIL_TEST_CHECK(reader.GetTimestamp(i) == static_cast<int64_t>(i));
+		}
+		ANVIL_TEST_CHECK(reader.FindTimestamp(30) == 30u);
+	}
+
+	// A writer that did not close leaves a file without a footer, the frames are walked to rebuild the index
+	void TestRecordFileWithoutFooter() {
+		std::vector<uint8_t> bytes;
+		{
+			RecordFileWriter writer(g_record_path, false, 4u);
+			RecordFileWriter::Record record;
+			for (uint64_t i = 0u; i < 30u; ++i) AppendRecord(writer, record, i, static_cast<int64_t>(i));
+			writer.Flush();
+			bytes = ReadFile(g_record_path);
+		}
+
+		WriteFile(g_record_copy_path, bytes.data(), bytes.size());
+		{
+			const RecordFileReader reader(g_record_copy_path);
+			ANVIL_TEST_CHECK(!reader.IsComplete());
+			ANVIL_TEST_CHECK(reader.GetRecordCount() == 30u);
+			for (uint64_t i = 0u; i < 30u; ++i) CheckRecord(reader, i, i);
+			ANVIL_TEST_CHECK(reader.FindTimestamp(17) == 17u);
+		}
+
+		// A frame that was cut short is not read, appending continues after the last complete frame
+		WriteFile(g_record_copy_path, bytes.data(), bytes.size() - 5u);
+		{
+			const RecordFileReader reader(g_record_copy_path);
+			ANVIL_TEST_CHECK(!reader.IsComplete());
+			ANVIL_TEST_CHECK(reader.GetRecordCount() == 29u);
+			CheckRecord(reader, 28u, 28u);
+			bool threw = false;
+			try {
+				reader.GetRecord(29u);
+			} catch (std::exception&) {
+				threw = true;
+			}
+			ANVIL_TEST_CHECK(threw);
+		}
+		{
+			RecordFileWriter writer(g_record_copy_path, true);
+			RecordFileWriter::Record record;
+			AppendRecord(writer, record, 1000u, 1000);
+		}
+		{
+			const RecordFileReader reader(g_record_copy_path);
+			ANVIL_TEST_CHECK(reader.IsComplete());
+			ANVIL_TEST_CHECK(reader.GetRecordCount() == 30u);
+			for (uint64_t i = 0u; i < 29u; ++i) CheckRecord(reader, i, i);
+			CheckRecord(reader, 29u, 1000u);
+			ANVIL_TEST_CHECK(reader.FindTimestamp(1000) == 29u);
+		}
+
+		std::remove(g_record_path);
+		std::remove(g_record_copy_path);
+	}
+
+#if ANVIL_SERIALISATION_STATS
+	// Stats
+
+	class RecordingStatsSink final : public SerialiserStatsSink {
+	public:
+		std::vector<SerialiserStats> reports;
+
+		virtual ~RecordingStatsSink() {}
+
+		void Report(const SerialiserStats& stats) final {
+			reports.push_back(stats);
+		}
+	};
+
+	void WriteStatsDocument(BytePipeSerialiser& serialiser) {
+		const uint16_t u16s[10u] = { 1u, 2u, 3u, 4u, 5u, 6u, 7u, 8u, 9u, 10u };
+		const double f64s[3u] = { 1.0, 2.0, 3.0 };
+		serialiser.StartObject();
+		serialiser.SetNextMemberName("a");
+		serialiser.SetNextValueU32(1u);
+		serialiser.SetNextMemberName("b");
+		serialiser.StartArray();
+		serialiser.SetNextValueU16(u16s, 10u);
+		serialiser.EndArray();
+		serialiser.SetNextMemberName("c");
+		serialiser.SetNextValueString("string");
+		serialiser.SetNextMemberName("d");
+		serialiser.StartObject();
+		serialiser.SetNextMemberName("e");
+		serialiser.StartArray();
+		serialiser.StartArray();
+		serialiser.SetNextValueF64(f64s, 3u);
+		serialiser.EndArray();
+		serialiser.EndArray();
+		serialiser.EndObject();
+		serialiser.EndObject();
+	}
+
+	bool StatsEqual(const SerialiserStats& lhs, const SerialiserStats& rhs) {
+		return memcmp(&lhs, &rhs, sizeof(SerialiserStats)) == 0;
+	}
+
+	void TestStats() {
+		for (const uint32_t mode : g_modes) {
+			RecordingStatsSink sink;
+			MemoryOutputPipe pipe;
+			{
+				BytePipeSerialiser serialiser(pipe, mode);
+				serialiser.SetStatsSink(&sink);
+				WriteStatsDocument(serialiser);
+
+				// Member names are not values, array elements are counted individually
+				const SerialiserStats& stats = serialiser.GetStats();
+				for (size_t i = 0u; i < SerialiserStats::TYPE_COUNT; ++i) {
+					uint64_t expected = 0u;
+					switch (i) {
+					case Serialiser::TYPE_OBJECT: expected = 2u; break;
+					case Serialiser::TYPE_ARRAY: expected = 3u; break;
+					case Serialiser::TYPE_UNSIGNED_32: expected = 1u; break;
+					case Serialiser::TYPE_UNSIGNED_16: expected = 10u; break;
+					case Serialiser::TYPE_STRING: expected = 1u; break;
+					case Serialiser::TYPE_FLOAT_64: expected = 3u; break;
+					default: break;
+					}
+					ANVIL_TEST_CHECK(stats.values[i] == expected);
+				}
+				ANVIL_TEST_CHECK(stats.max_depth == 4u);
+				ANVIL_TEST_CHECK(stats.bytes_written == pipe.bytes.size());
+				ANVIL_TEST_CHECK(stats.pipe_writes > 0u);
+
+				// Only compact containers move their contents back to shrink their length, unless they are aligned
+				if ((mode & (BytePipeFormat::MODE_COMPACT | BytePipeFormat::MODE_ALIGNED)) == BytePipeFormat::MODE_COMPACT) {
+					ANVIL_TEST_CHECK(stats.bytes_moved > 0u);
+				} else {
+					ANVIL_TEST_CHECK(stats.bytes_moved == 0u);
+				}
+
+				// The sink is given the stats on each flush
+				ANVIL_TEST_CHECK(sink.reports.empty());
+				serialiser.Flush();
+				ANVIL_TEST_CHECK(sink.reports.size() == 1u);
+				ANVIL_TEST_CHECK(StatsEqual(sink.reports.back(), stats));
+
+				serialiser.ResetStats();
+				ANVIL_TEST_CHECK(stats.values[Serialiser::TYPE_OBJECT] == 0u && stats.max_depth == 0u && stats.bytes_written == 0u);
+				serialiser.SetNextValueU32(1u);
+			}
+
+			// And again when the serialiser is destroyed
+			ANVIL_TEST_CHECK(sink.reports.size() == 2u);
+			ANVIL_TEST_CHECK(sink.reports.back().values[Serialiser::TYPE_UNSIGNED_32] == 1u);
+			ANVIL_TEST_CHECK(sink.reports.back().values[Serialiser::TYPE_OBJECT] == 0u);
+			ANVIL_TEST_CHECK(sink.reports.back().bytes_written == pipe.bytes.size() - sink.reports.front().bytes_written);
+		}
+
+		// Encoded arrays are moved into place once the codec has packed them
+		MemoryOutputPipe pipe;
+		BytePipeSerialiser serialiser(pipe);
+		const std::vector<uint32_t> values = MakeValues<uint32_t>();
+		serialiser.StartArray(BytePipeFormat::CODEC_BIT_PACK);
+		serialiser.SetNextValueU32(values.data(), values.size());
+		serialiser.EndArray();
+		ANVIL_TEST_CHECK(serialiser.GetStats().bytes_moved > 0u);
+		ANVIL_TEST_CHECK(serialiser.GetStats().buffer_reallocations > 0u);
+	}
+#endif
+
+	void TestInvalidModes() {
+		MemoryOutputPipe pipe;
+		bool threw = false;
+		try {
+			BytePipeSerialiser serialiser(pipe, BytePipeFormat::MODE_INDEXED | BytePipeFormat::MODE_INTERN_NAMES);
+		} catch (std::exception&) {
+			threw = true;
+		}
+		ANVIL_TEST_CHECK(threw);
+	}
+
+	struct Test {
+		const char* name;
+		void(*run)();
+	};
+}
+
+int main(int argc, char** argv) {
+	const char* const filter = argc > 1 ? argv[1] : "";
+
+	const Test tests[] = {
+		{ "modes", &TestModes },
+		{ "skip", &TestSkip },
+		{ "documents", &TestDocuments },
+		{ "codecs", &TestCodecs },
+		{ "structs", &TestStructs },
+		{ "columns", &TestColumns },
+		{ "parallel_writes", &TestParallelWrites },
+		{ "parallel_reads", &TestParallelReads },
+		{ "parallel_reads_interned_later", &TestParallelReadsInternedLater },
+		{ "chunked_arrays", &TestChunkedArrays },
+		{ "parallel_chunked_arrays", &TestParallelChunkedArrays },
+		{ "transcoder", &TestTranscoder },
+		{ "interned_copies", &TestInternedCopies },
+		{ "json_strings", &TestJsonStrings },
+		{ "json_numbers", &TestJsonNumbers },
+		{ "json_number_arrays", &TestJsonNumberArrays },
+		{ "json_structs", &TestJsonStructs },
+		{ "arena_allocator", &TestArenaAllocator },
+		{ "steady_state_allocations", &TestSteadyStateAllocations },
+		{ "parallel_write_allocator", &TestParallelWriteAllocator },
+		{ "array_cursor", &TestArrayCursor },
+		{ "chunked_array_cursor", &TestChunkedArrayCursor },
+		{ "encoded_array_cursor", &TestEncodedArrayCursor },
+		{ "array_cursor_errors", &TestArrayCursorErrors },
+		{ "referenced_arrays", &TestReferencedArrays },
+		{ "compressed_pipe", &TestCompressedPipe },
+		{ "compression_errors", &TestCompressionErrors },
+		{ "async_pipe", &TestAsyncPipe },
+		{ "async_pipe_errors", &TestAsyncPipeErrors },
+		{ "async_pipe_counters", &TestAsyncPipeCounters },
+		{ "memory_mapped_file", &TestMemoryMappedFile },
+		{ "record_file_concurrent_appends", &TestRecordFileConcurrentAppends },
+		{ "record_file_timestamps", &TestRecordFileTimestamps },
+		{ "record_file_append", &TestRecordFileAppend },
+		{ "record_file_without_footer", &TestRecordFileWithoutFooter },
+#if ANVIL_SERIALISATION_STATS
+		{ "stats", &TestStats },
+#endif
+		{ "invalid_modes", &TestInvalidModes }
+	};
+
+	int failed = 0;
+	for (const Test& test : tests) {
+		if (strstr(test.name, filter) == nullptr) continue;
+		try {
+			test.run();
+			printf("PASS %s\n", test.name);
+		} catch (std::exception& e) {
+			printf("FAIL %s : %s\n", test.name, e.what());
+			++failed;
+		}
+	}
+
+	return failed;
+}